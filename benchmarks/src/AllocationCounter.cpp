@@ -0,0 +1,76 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new of the benchmarks executable to count the heap allocations of every thread.
+// The array and nothrow forms forward to the replaced ones. The aligned forms are replaced too, since the standard
+// library may use them for std::pmr::new_delete_resource whatever the alignment asked for.
+namespace
+{
+    thread_local uint64_t t_AllocationsCount{ 0u };
+
+    // The aligned blocks keep the pointer returned by malloc right before them
+    void* AllocateAligned(size_t size, size_t alignment)
+    {
+        void* data{ std::malloc(size + alignment + sizeof(void*)) };
+        if (data == nullptr)
+            throw std::bad_alloc{};
+
+        const uintptr_t alignedAddress{ (reinterpret_cast<uintptr_t>(data) + sizeof(void*) + alignment - 1u) & ~(alignment - 1u) };
+        reinterpret_cast<void**>(alignedAddress)[-1] = data;
+
+        return reinterpret_cast<void*>(alignedAddress);
+    }
+
+    void FreeAligned(void* data) noexcept
+    {
+        if (data != nullptr)
+            std::free(static_cast<void**>(data)[-1]);
+    }
+} // namespace
+
+void* operator new(size_t size)
+{
+    ++t_AllocationsCount;
+
+    if (void* data{ std::malloc(size > 0u ? size : 1u) })
+        return data;
+
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    ++t_AllocationsCount;
+
+    return AllocateAligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept
+{
+    FreeAligned(data);
+}
+
+void operator delete(void* data, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(data);
+}
+
+namespace Benchmark
+{
+    uint64_t GetThreadAllocationsCount() noexcept
+    {
+        return t_AllocationsCount;
+    }
+} // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "Benchmark.h"
+
+#include "HTTP.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace Benchmark
+{
+    namespace
+    {
+        struct RegisteredBenchmark
+        {
+            std::string Name{};
+            Function    Body{};
+        };
+
+        struct Result
+        {
+            std::string Name{};
+            uint64_t    IterationsCount{ 0u };
+
+            // Per iteration, over the repetitions
+            double MedianSeconds{ 0.0 };
+            double MinSeconds{ 0.0 };
+            double MaxSeconds{ 0.0 };
+
+            // Of the median repetition
+            double                        ItemsPerSecond{ 0.0 };
+            double                        BytesPerSecond{ 0.0 };
+            double                        AllocationsPerIteration{ 0.0 };
+            std::map<std::string, double> Counters{};
+        };
+
+        // A function-local registry, so that the registration order of the translation units does not matter
+        std::vector<RegisteredBenchmark>& GetRegistry()
+        {
+            static std::vector<RegisteredBenchmark> s_Registry{};
+            return s_Registry;
+        }
+
+        State RunOnce(const Function& function, uint64_t iterationsCount)
+        {
+            State state{ iterationsCount };
+            function(state);
+
+            return state;
+        }
+
+        Result Run(const RegisteredBenchmark& benchmark, const RunOptions& options)
+        {
+            // Step 1
+            // Grows the number of iterations until a single run lasts at least MinTimeSeconds
+            uint64_t iterationsCount{ 1u };
+            double   elapsedSeconds{ RunOnce(benchmark.Body, iterationsCount).GetElapsedSeconds() };
+
+            while (elapsedSeconds < options.MinTimeSeconds)
+            {
+                const double multiplier{ std::clamp(options.MinTimeSeconds * 1.4 / std::max(elapsedSeconds, 1e-9), 1.5, 10.0) };
+
+                iterationsCount = static_cast<uint64_t>(std::ceil(static_cast<double>(iterationsCount) * multiplier));
+                elapsedSeconds = RunOnce(benchmark.Body, iterationsCount).GetElapsedSeconds();
+            }
+
+            // Step 2
+            // Repeats the measurement with that number of iterations and keeps the median repetition
+            std::vector<State> repetitions{};
+            for (uint32_t i{ 0u }; i < std::max(options.RepetitionsCount, 1u); ++i)
+                repetitions.push_back(RunOnce(benchmark.Body, iterationsCount));
+
+            std::sort(repetitions.begin(), repetitions.end(), [](const State& lhs, const State& rhs) { return lhs.GetElapsedSeconds() < rhs.GetElapsedSeconds(); });
+
+            const State& median{ repetitions[repetitions.size() / 2u] };
+            const double iterations{ static_cast<double>(iterationsCount) };
+
+            Result result{};
+            result.Name = benchmark.Name;
+            result.IterationsCount = iterationsCount;
+            result.MedianSeconds = median.GetElapsedSeconds() / iterations;
+            result.MinSeconds = repetitions.front().GetElapsedSeconds() / iterations;
+            result.MaxSeconds = repetitions.back().GetElapsedSeconds() / iterations;
+            result.ItemsPerSecond = static_cast<double>(median.GetItemsCount()) / median.GetElapsedSeconds();
+            result.BytesPerSecond = static_cast<double>(median.GetBytesCount()) / median.GetElapsedSeconds();
+            result.AllocationsPerIteration = static_cast<double>(median.GetAllocationsCount()) / iterations;
+            result.Counters = median.GetCounters();
+
+            return result;
+        }
+
+        std::string FormatDuration(double seconds)
+        {
+            if (seconds < 1e-6)
+                return std::format("{0:.1f} ns", seconds * 1e9);
+            if (seconds < 1e-3)
+                return std::format("{0:.2f} us", seconds * 1e6);
+            if (seconds < 1.0)
+                return std::format("{0:.2f} ms", seconds * 1e3);
+
+            return std::format("{0:.3f} s", seconds);
+        }
+
+        void PrintResult(const Result& result)
+        {
+            std::string line{ std::format("{0:<48} {1:>12} {2:>12} {3:>12.2f}", result.Name, FormatDuration(result.MedianSeconds), result.IterationsCount, result.AllocationsPerIteration) };
+
+            if (result.ItemsPerSecond > 0.0)
+                line.append(std::format("  {0:.3g} items/s", result.ItemsPerSecond));
+            if (result.BytesPerSecond > 0.0)
+                line.append(std::format("  {0:.1f} MB/s", result.BytesPerSecond / (1024.0 * 1024.0)));
+            for (const auto& [name, value] : result.Counters)
+                line.append(std::format("  {0}={1:.4g}", name, value));
+
+            std::cout << line << std::endl;
+        }
+
+        void ExportJSON(const std::string& path, const std::vector<Result>& results, const RunOptions& options)
+        {
+            std::string json{ "{\n  \"context\": {\n" };
+
+#ifdef DEBUG
+            constexpr std::string_view buildType{ "debug" };
+#else
+            constexpr std::string_view buildType{ "release" };
+#endif
+
+            const auto timestamp{ std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+
+            json.append(std::format("    \"timestamp\": {0},\n", timestamp));
+            json.append(std::format("    \"build_type\": \"{0}\",\n", buildType));
+            json.append(std::format("    \"hardware_concurrency\": {0},\n", std::thread::hardware_concurrency()));
+            json.append(std::format("    \"min_time_seconds\": {0},\n", options.MinTimeSeconds));
+            json.append(std::format("    \"repetitions\": {0}\n", options.RepetitionsCount));
+            json.append("  },\n  \"benchmarks\": [");
+
+            for (size_t i{ 0u }; i < results.size(); ++i)
+            {
+                const Result& result{ results[i] };
+
+                json.append(i > 0u ? ",\n    {\n" : "\n    {\n");
+                json.append("      \"name\": \"");
+                HTTP::AppendJSONEscaped(json, result.Name);
+                json.append("\",\n");
+                json.append(std::format("      \"iterations\": {0},\n", result.IterationsCount));
+                json.append(std::format("      \"ns_per_iteration\": {0:.3f},\n", result.MedianSeconds * 1e9));
+                json.append(std::format("      \"ns_per_iteration_min\": {0:.3f},\n", result.MinSeconds * 1e9));
+                json.append(std::format("      \"ns_per_iteration_max\": {0:.3f},\n", result.MaxSeconds * 1e9));
+                json.append(std::format("      \"items_per_second\": {0:.3f},\n", result.ItemsPerSecond));
+                json.append(std::format("      \"bytes_per_second\": {0:.3f},\n", result.BytesPerSecond));
+                json.append(std::format("      \"allocations_per_iteration\": {0:.3f},\n", result.AllocationsPerIteration));
+                json.append("      \"counters\": {");
+
+                size_t counterIndex{ 0u };
+                for (const auto& [name, value] : result.Counters)
+                {
+                    json.append(counterIndex++ > 0u ? ", \"" : " \"");
+                    HTTP::AppendJSONEscaped(json, name);
+                    json.append(std::format("\": {0:.6g}", value));
+                }
+
+                json.append(result.Counters.empty() ? "}\n    }" : " }\n    }");
+            }
+
+            json.append("\n  ]\n}\n");
+
+            std::ofstream jsonStream{ path, std::ios::out | std::ios::trunc };
+            if (!jsonStream.is_open())
+                throw std::runtime_error(std::format("Failed to create {0}", path).c_str());
+
+            jsonStream << json;
+        }
+    } // namespace
+
+    bool State::KeepRunning()
+    {
+        if (!m_IsStarted)
+        {
+            m_IsStarted = true;
+            m_StartAllocationsCount = GetThreadAllocationsCount();
+            m_StartTimePoint = Clock::now();
+        }
+        else
+        {
+            ResumeTiming();
+        }
+
+        if (m_DoneIterationsCount < m_IterationsCount)
+        {
+            ++m_DoneIterationsCount;
+            return true;
+        }
+
+        PauseTiming();
+        return false;
+    }
+
+    void State::PauseTiming()
+    {
+        if (m_IsPaused)
+            return;
+
+        m_Elapsed += Clock::now() - m_StartTimePoint;
+        m_AllocationsCount += GetThreadAllocationsCount() - m_StartAllocationsCount;
+        m_IsPaused = true;
+    }
+
+    void State::ResumeTiming()
+    {
+        if (!m_IsPaused)
+            return;
+
+        m_StartAllocationsCount = GetThreadAllocationsCount();
+        m_StartTimePoint = Clock::now();
+        m_IsPaused = false;
+    }
+
+    bool Register(std::string name, Function function)
+    {
+        GetRegistry().push_back({ .Name = std::move(name), .Body = std::move(function) });
+        return true;
+    }
+
+    size_t RunAll(const RunOptions& options)
+    {
+        std::vector<Result> results{};
+
+        std::cout << std::format("{0:<48} {1:>12} {2:>12} {3:>12}", "Benchmark", "Time", "Iterations", "Allocs/iter") << std::endl;
+
+        for (const RegisteredBenchmark& benchmark : GetRegistry())
+        {
+            if (!options.Filter.empty() && benchmark.Name.find(options.Filter) == std::string::npos)
+                continue;
+
+            results.push_back(Run(benchmark, options));
+            PrintResult(results.back());
+        }
+
+        if (!options.JSONPath.empty())
+            ExportJSON(options.JSONPath, results, options);
+
+        return results.size();
+    }
+} // namespace Benchmark
\ No newline at end of file
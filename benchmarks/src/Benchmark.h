@@ -0,0 +1,91 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A minimal in-tree microbenchmark harness.
+// A benchmark is a function that does its setup, then runs the measured code inside `while (state.KeepRunning())`.
+// The runner calls it with a growing number of iterations until a run lasts long enough, then repeats the measurement.
+namespace Benchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    class State
+    {
+    public:
+        explicit State(uint64_t iterationsCount) noexcept
+            : m_IterationsCount{ iterationsCount }
+        {
+        }
+
+    public:
+        bool KeepRunning();
+
+        // Excludes per-iteration setup or teardown from the measured time, a paused timing is resumed by the next KeepRunning()
+        void PauseTiming();
+        void ResumeTiming();
+
+        // Totals over all the iterations, reported as rates
+        void SetItemsProcessed(uint64_t itemsCount) noexcept { m_ItemsCount = itemsCount; }
+        void SetBytesProcessed(uint64_t bytesCount) noexcept { m_BytesCount = bytesCount; }
+
+        // Reported as they are, e.g. latency percentiles measured by the benchmark itself
+        void SetCounter(const std::string& name, double value) { m_Counters[name] = value; }
+
+        uint64_t GetIterationsCount() const noexcept { return m_IterationsCount; }
+        uint64_t GetItemsCount() const noexcept { return m_ItemsCount; }
+        uint64_t GetBytesCount() const noexcept { return m_BytesCount; }
+        uint64_t GetAllocationsCount() const noexcept { return m_AllocationsCount; } // Heap allocations of the timed code
+        double   GetElapsedSeconds() const noexcept { return std::chrono::duration<double>(m_Elapsed).count(); }
+
+        const std::map<std::string, double>& GetCounters() const noexcept { return m_Counters; }
+
+    private:
+        uint64_t m_IterationsCount{ 1u };
+        uint64_t m_DoneIterationsCount{ 0u };
+
+        uint64_t m_ItemsCount{ 0u };
+        uint64_t m_BytesCount{ 0u };
+
+        std::map<std::string, double> m_Counters{};
+
+        Clock::time_point m_StartTimePoint{};
+        Clock::duration   m_Elapsed{};
+        bool              m_IsStarted{ false };
+        bool              m_IsPaused{ false };
+
+        uint64_t m_StartAllocationsCount{ 0u };
+        uint64_t m_AllocationsCount{ 0u };
+    };
+
+    // Global heap allocations made by the calling thread so far, counted by the replaced operator new
+    uint64_t GetThreadAllocationsCount() noexcept;
+
+    using Function = std::function<void(State&)>;
+
+    // Called from the static initializers of the translation units that define the benchmarks
+    bool Register(std::string name, Function function);
+
+    struct RunOptions
+    {
+        std::string Filter{}; // Only the benchmarks whose name contains it
+        double      MinTimeSeconds{ 0.5 };
+        uint32_t    RepetitionsCount{ 3u };
+        std::string JSONPath{}; // Export of the results, none if empty
+    };
+
+    // Returns the number of benchmarks that have been run
+    size_t RunAll(const RunOptions& options);
+
+    // Keeps the compiler from discarding a result that is otherwise unused
+    template <typename T>
+    void DoNotOptimize(const T& value)
+    {
+        static const void* volatile s_Sink{ nullptr };
+        s_Sink = &value;
+    }
+} // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+#include "PathStore.h"
+
+namespace
+{
+    constexpr size_t FILES_COUNT{ 64u };
+    constexpr size_t FILE_SIZE{ 64u * 1024u };
+
+    std::string MakeContent()
+    {
+        std::string content{};
+        for (size_t rank{ 0u }; content.size() < FILE_SIZE; ++rank)
+            content.append(Fixtures::MakeWord(rank % Fixtures::VOCABULARY_SIZE)).push_back(' ');
+        content.resize(FILE_SIZE);
+
+        return content;
+    }
+
+    // Written once into the temporary directory and left there for the next runs
+    const std::vector<std::string>& GetFilePaths()
+    {
+        static const std::vector<std::string> s_FilePaths{ [] {
+            const std::filesystem::path directory{ std::filesystem::temp_directory_path() / "course_work_benchmarks" };
+            std::filesystem::create_directories(directory);
+
+            const std::string content{ MakeContent() };
+
+            // The files differ in their first bytes, so that none of them is loaded as a duplicate of another one
+            std::vector<std::string> filePaths{};
+            for (size_t i{ 0u }; i < FILES_COUNT; ++i)
+            {
+                const std::filesystem::path filePath{ directory / std::format("{0}.txt", i) };
+                std::ofstream{ filePath, std::ios::out | std::ios::binary | std::ios::trunc } << std::format("{0:08} ", i) << std::string_view{ content }.substr(9u);
+
+                filePaths.push_back(filePath.string());
+            }
+
+            return filePaths;
+        }() };
+
+        return s_FilePaths;
+    }
+
+    void LoadFile(Benchmark::State& state)
+    {
+        const std::vector<std::string>& filePaths{ GetFilePaths() };
+
+        FileSystem fileSystem{};
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(fileSystem.LoadFile(filePaths[i++ % filePaths.size()]));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetBytesProcessed(state.GetIterationsCount() * FILE_SIZE);
+    }
+
+    void HashContent(Benchmark::State& state)
+    {
+        const std::string content{ MakeContent() };
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(FileSystem::HashContent(content));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetBytesProcessed(state.GetIterationsCount() * FILE_SIZE);
+    }
+
+    // A page of paths serialized into a JSON response, as the search endpoint does
+    void AppendJSONEscapedPath(Benchmark::State& state)
+    {
+        PathStore pathStore{};
+        for (size_t i{ 0u }; i < FILES_COUNT * 1024u; ++i)
+            pathStore.Add(i, std::format("C:\\corpus\\part{0}\\section{1}\\document{2}.txt", i % 16u, i % 256u, i));
+
+        std::string jsonBody{};
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+        {
+            jsonBody.clear();
+            for (size_t j{ 0u }; j < 10u; ++j)
+                pathStore.AppendJSONEscapedPath(i++ % (FILES_COUNT * 1024u), jsonBody);
+
+            Benchmark::DoNotOptimize(jsonBody.data());
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount() * 10u);
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("FileSystem/LoadFile/64KB", LoadFile);
+        Benchmark::Register("FileSystem/HashContent/64KB", HashContent);
+        Benchmark::Register("FileSystem/AppendJSONEscapedPath", AppendJSONEscapedPath);
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "Fixtures.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace Fixtures
+{
+    std::string MakeWord(size_t rank)
+    {
+        // Bijective base-26, so that every rank gets a distinct word and the frequent words are the short ones
+        std::string word{};
+        for (size_t value{ rank + 1u }; value > 0u; value = (value - 1u) / 26u)
+            word.push_back(static_cast<char>('a' + (value - 1u) % 26u));
+
+        return word;
+    }
+
+    const std::vector<Document>& GetDocuments(size_t documentsCount)
+    {
+        static std::unordered_map<size_t, std::vector<Document>> s_Documents{};
+
+        auto [it, isInserted]{ s_Documents.try_emplace(documentsCount) };
+        if (!isInserted)
+            return it->second;
+
+        const ZipfDistribution                wordDistribution{ VOCABULARY_SIZE, ZIPF_EXPONENT };
+        std::mt19937_64                       generator{ SEED };
+        std::uniform_int_distribution<size_t> lengthDistribution{ 50u, 350u };
+
+        std::vector<Document>& documents{ it->second };
+        documents.reserve(documentsCount);
+
+        for (size_t i{ 0u }; i < documentsCount; ++i)
+        {
+            Document document{ .FileID = FileSystem::GetFileID(std::format("/corpus/{0}.txt", i)) };
+
+            const size_t wordsCount{ lengthDistribution(generator) };
+            for (size_t j{ 0u }; j < wordsCount; ++j)
+            {
+                if (j > 0u)
+                    document.Content.push_back(' ');
+                document.Content.append(MakeWord(wordDistribution(generator)));
+            }
+
+            documents.push_back(std::move(document));
+        }
+
+        return documents;
+    }
+
+    std::string MakeEnglishText(size_t minSize)
+    {
+        // Roughly in the order of their frequency in English prose
+        static constexpr std::array<std::string_view, 128u> WORDS{
+            "the", "of", "and", "to", "a", "in", "is", "it", "that", "was", "for", "on", "are", "as", "with", "they",
+            "at", "be", "this", "by", "not", "or", "but", "from", "have", "an", "which", "their", "there", "were", "if", "will",
+            "these", "into", "then", "such", "no", "has", "been", "would", "people", "could", "between", "during", "running",
+            "connected", "connections", "connecting", "generalizations", "relational", "conditional", "rationalize",
+            "operating", "operational", "happiness", "hopefully", "effective", "adjustable", "communication", "agreed",
+            "formality", "sensitivity", "dependent", "adoption", "controlled", "rolling", "electrical", "hopeful",
+            "goodness", "allowance", "inference", "replacement", "adjustment", "activate", "angularity", "homologous",
+            "effectively", "bowdlerize", "caresses", "ponies", "cats", "feed", "plastered", "motoring", "sing", "conflated",
+            "troubled", "sized", "hopping", "tanned", "falling", "hissing", "fizzed", "failing", "filing", "happy", "sky",
+            "valency", "hesitancy", "digitizer", "conformably", "radically", "differently", "vilely", "analogously",
+            "vietnamization", "predication", "decisiveness", "callousness", "triplicate", "formative", "formalize",
+            "electricity", "revival", "probate", "rate", "cease", "controlling", "generate", "generous", "wandering",
+            "indexes", "searched", "documents", "queries", "computers", "relate", "national",
+        };
+
+        const ZipfDistribution                wordDistribution{ WORDS.size(), ZIPF_EXPONENT };
+        std::mt19937_64                       generator{ SEED + 2u };
+        std::uniform_int_distribution<size_t> lengthDistribution{ 6u, 24u };
+
+        std::string text{};
+        while (text.size() < minSize)
+        {
+            const size_t wordsCount{ lengthDistribution(generator) };
+            for (size_t j{ 0u }; j < wordsCount; ++j)
+            {
+                const size_t wordOffset{ text.size() };
+                text.append(WORDS[wordDistribution(generator)]);
+
+                if (j == 0u)
+                    text[wordOffset] = static_cast<char>(text[wordOffset] - 'a' + 'A');
+
+                text.append(j + 1u == wordsCount ? ".\n" : j % 7u == 6u ? ", " : " ");
+            }
+        }
+
+        return text;
+    }
+
+    const std::vector<std::string>& GetQueries()
+    {
+        static const std::vector<std::string> s_Queries{ [] {
+            const ZipfDistribution                wordDistribution{ VOCABULARY_SIZE, ZIPF_EXPONENT };
+            std::mt19937_64                       generator{ SEED + 1u };
+            std::uniform_int_distribution<size_t> lengthDistribution{ 1u, 3u };
+
+            std::vector<std::string> queries(1024u);
+            for (std::string& query : queries)
+            {
+                const size_t wordsCount{ lengthDistribution(generator) };
+                for (size_t j{ 0u }; j < wordsCount; ++j)
+                {
+                    if (j > 0u)
+                        query.push_back(' ');
+                    query.append(MakeWord(wordDistribution(generator)));
+                }
+            }
+
+            return queries;
+        }() };
+
+        return s_Queries;
+    }
+
+    const InvertedIndex& GetIndex(size_t documentsCount, bool isParallel)
+    {
+        static std::map<std::pair<size_t, bool>, std::unique_ptr<InvertedIndex>> s_Indices{};
+
+        std::unique_ptr<InvertedIndex>& index{ s_Indices[{ documentsCount, isParallel }] };
+        if (index)
+            return *index;
+
+        index = std::make_unique<InvertedIndex>(isParallel ? &GetThreadPool() : nullptr);
+        for (const Document& document : GetDocuments(documentsCount))
+            index->Add(document.FileID, document.Content);
+
+        return *index;
+    }
+
+    ThreadPool& GetThreadPool()
+    {
+        static ThreadPool s_ThreadPool{};
+        [[maybe_unused]] static const bool s_IsStarted{ [] {
+            s_ThreadPool.Create();
+            s_ThreadPool.Start();
+            return true;
+        }() };
+
+        return s_ThreadPool;
+    }
+} // namespace Fixtures
\ No newline at end of file
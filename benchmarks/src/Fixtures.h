@@ -0,0 +1,42 @@
+#pragma once
+#include "FileSystem.h"
+#include "InvertedIndex.h"
+#include "ThreadPool.h"
+#include "ZipfDistribution.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Shared inputs of the benchmarks, built once on first use and deterministic between runs
+namespace Fixtures
+{
+    struct Document
+    {
+        FileSystem::FileID FileID{ 0u };
+        std::string        Content{};
+    };
+
+    inline constexpr size_t   VOCABULARY_SIZE{ 50000u };
+    inline constexpr double   ZIPF_EXPONENT{ 1.0 };
+    inline constexpr uint64_t SEED{ 42u };
+
+    // Letter-only words, so that LowercaseFilter keeps them as they are. Rank 0 is the most frequent word
+    std::string MakeWord(size_t rank);
+
+    // Documents of 50 to 350 words drawn from a Zipfian vocabulary
+    const std::vector<Document>& GetDocuments(size_t documentsCount);
+
+    // Sentences of common English words drawn by their rank, stopwords and inflected forms included, with capitals and
+    // punctuation, so that every stage of EnglishAnalyzer has work to do
+    std::string MakeEnglishText(size_t minSize);
+
+    // Queries of 1 to 3 words drawn from the same distribution as the documents
+    const std::vector<std::string>& GetQueries();
+
+    // Index of GetDocuments(documentsCount), searched in parallel on GetThreadPool() if requested
+    const InvertedIndex& GetIndex(size_t documentsCount, bool isParallel);
+
+    ThreadPool& GetThreadPool();
+} // namespace Fixtures
\ No newline at end of file
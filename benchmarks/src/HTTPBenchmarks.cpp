@@ -0,0 +1,92 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+#include "HTTP.h"
+#include "ScratchArena.h"
+
+namespace
+{
+    constexpr std::string_view SEARCH_REQUEST{ "GET /search?q=hello%20world+foo&offset=0&limit=100 HTTP/1.1\r\n"
+                                               "Host: localhost:8080\r\n"
+                                               "User-Agent: python-requests/2.31.0\r\n"
+                                               "Accept-Encoding: gzip, deflate\r\n"
+                                               "Accept: */*\r\n"
+                                               "Connection: keep-alive\r\n\r\n" };
+
+    void ParseRequest(Benchmark::State& state)
+    {
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(HTTP::ParseRequest(SEARCH_REQUEST));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetBytesProcessed(state.GetIterationsCount() * SEARCH_REQUEST.size());
+    }
+
+    void ParseRequestScratchArena(Benchmark::State& state)
+    {
+        while (state.KeepRunning())
+        {
+            ScratchArena scratchArena{};
+            Benchmark::DoNotOptimize(HTTP::ParseRequest(SEARCH_REQUEST, scratchArena.GetResource()));
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetBytesProcessed(state.GetIterationsCount() * SEARCH_REQUEST.size());
+    }
+
+    void GetContentLength(Benchmark::State& state)
+    {
+        constexpr std::string_view headers{ "POST /search/batch HTTP/1.1\r\n"
+                                            "Host: localhost:8080\r\n"
+                                            "Content-Type: text/plain\r\n"
+                                            "Content-Length: 4096" };
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(HTTP::GetContentLength(headers));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // The JSON body of a page of 100 results, as built by the server
+    void SerializeResults(Benchmark::State& state)
+    {
+        std::vector<std::string> paths{};
+        for (size_t i{ 0u }; i < 100u; ++i)
+            paths.push_back(std::format("C:\\data\\corpus\\{0}\\{1}.txt", Fixtures::MakeWord(i), i));
+
+        std::string jsonBody{};
+        size_t      bodiesBytes{ 0u };
+
+        while (state.KeepRunning())
+        {
+            jsonBody.clear();
+            jsonBody.append(std::format("{{ \"total\": {0}, \"offset\": {1}, \"partial\": {2}, \"results\": [", 12345u, 0u, false));
+
+            for (size_t i{ 0u }; i < paths.size(); ++i)
+            {
+                if (i > 0u)
+                    jsonBody.append(", ");
+
+                jsonBody.push_back('"');
+                HTTP::AppendJSONEscaped(jsonBody, paths[i]);
+                jsonBody.push_back('"');
+            }
+
+            jsonBody.append("] }");
+            bodiesBytes += jsonBody.size();
+        }
+
+        Benchmark::DoNotOptimize(jsonBody);
+        state.SetItemsProcessed(state.GetIterationsCount() * paths.size());
+        state.SetBytesProcessed(bodiesBytes);
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("HTTP/ParseRequest", ParseRequest);
+        Benchmark::Register("HTTP/ParseRequest/ScratchArena", ParseRequestScratchArena);
+        Benchmark::Register("HTTP/GetContentLength", GetContentLength);
+        Benchmark::Register("HTTP/SerializeResults/100", SerializeResults);
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
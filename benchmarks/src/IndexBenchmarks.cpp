@@ -0,0 +1,464 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+#include "ScratchArena.h"
+#include "Snippets.h"
+#include "Unicode.h"
+
+namespace
+{
+    constexpr std::array<size_t, 3u> DOCUMENTS_COUNTS{ 1000u, 10000u, 50000u };
+
+    std::string MakeText(size_t minSize)
+    {
+        std::string text{};
+        for (const Fixtures::Document& document : Fixtures::GetDocuments(DOCUMENTS_COUNTS.front()))
+        {
+            text.append(document.Content).push_back('\n');
+            if (text.size() >= minSize)
+                break;
+        }
+
+        return text;
+    }
+
+    void Lowercase(Benchmark::State& state)
+    {
+        // Mixed case and punctuation, as found in real text
+        std::vector<std::string> tokens{};
+        for (size_t rank{ 0u }; rank < 1024u; ++rank)
+        {
+            std::string token{ Fixtures::MakeWord(rank) };
+            token[0] = static_cast<char>(std::toupper(token[0]));
+            token.append(rank % 3u == 0u ? "," : rank % 3u == 1u ? "." : "");
+            tokens.push_back(std::move(token));
+        }
+
+        std::pmr::string term{};
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(LowercaseFilter::Apply(tokens[i++ % tokens.size()], term));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    void Tokenize(Benchmark::State& state)
+    {
+        const std::string text{ MakeText(64u * 1024u) };
+
+        const InvertedIndex index{};
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(index.Tokenize(text));
+
+        state.SetBytesProcessed(state.GetIterationsCount() * text.size());
+    }
+
+    void ExtractTerms(Benchmark::State& state)
+    {
+        const std::string   text{ MakeText(64u * 1024u) };
+        const InvertedIndex index{};
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(index.ExtractTerms(text));
+
+        state.SetBytesProcessed(state.GetIterationsCount() * text.size());
+    }
+
+    // The terms of an analyzer chain are counted over English prose, so that the cost measured is that of the chain alone
+    template <typename TextAnalyzer>
+    void Analyze(Benchmark::State& state)
+    {
+        const std::string text{ Fixtures::MakeEnglishText(64u * 1024u) };
+        std::pmr::string  term{};
+
+        while (state.KeepRunning())
+        {
+            size_t termsCount{ 0u };
+            TextAnalyzer::ForEachTerm(text, term, [&termsCount](std::string_view, std::string_view) { return ++termsCount != 0u; });
+
+            Benchmark::DoNotOptimize(termsCount);
+        }
+
+        state.SetBytesProcessed(state.GetIterationsCount() * text.size());
+    }
+
+    // The stopwords of StopwordFilter, compared by hand
+    bool IsStopwordByHand(std::string_view term) noexcept
+    {
+        using namespace std::literals;
+
+        switch (term.size())
+        {
+            case 1u:
+                return term[0] == 'a';
+            case 2u:
+                return term == "an"sv || term == "as"sv || term == "at"sv || term == "be"sv || term == "by"sv || term == "if"sv || term == "in"sv
+                    || term == "is"sv || term == "it"sv || term == "no"sv || term == "of"sv || term == "on"sv || term == "or"sv || term == "to"sv;
+            case 3u:
+                return term == "and"sv || term == "are"sv || term == "but"sv || term == "for"sv || term == "not"sv || term == "the"sv || term == "was"sv;
+            case 4u:
+                return term == "into"sv || term == "such"sv || term == "that"sv || term == "then"sv || term == "they"sv || term == "this"sv
+                    || term == "will"sv || term == "with"sv;
+            case 5u:
+                return term == "their"sv || term == "there"sv || term == "these"sv;
+            default:
+                return false;
+        }
+    }
+
+    // The splitter, the lowercasing and the stopwords written out in a single loop over the bytes of an ASCII text, the
+    // stemmer is called as it is. It produces the terms of StandardAnalyzer, or of EnglishAnalyzer if isEnglish is set
+    template <bool isEnglish, typename OnTerm>
+    void ForEachTermByHand(std::string_view text, std::pmr::string& term, OnTerm&& onTerm)
+    {
+        const auto isWhitespace{ [](char c) { return c == ' ' || (c >= '\t' && c <= '\r'); } };
+
+        for (size_t position{ 0u }; position < text.size();)
+        {
+            // Step 1
+            // Skip the whitespace, then keep the letters of the token, lowercased
+            while (position < text.size() && isWhitespace(text[position]))
+                ++position;
+
+            term.clear();
+            for (; position < text.size() && !isWhitespace(text[position]); ++position)
+            {
+                const char lowercase{ static_cast<char>(text[position] | 0x20) };
+                if (lowercase >= 'a' && lowercase <= 'z')
+                    term.push_back(lowercase);
+            }
+
+            if (term.empty())
+                continue;
+
+            // Step 2
+            // Drop the stopwords and stem the rest
+            if constexpr (isEnglish)
+            {
+                if (IsStopwordByHand(term) || !PorterStemFilter::Apply(term))
+                    continue;
+            }
+
+            onTerm(std::string_view{ term });
+        }
+    }
+
+    // What LowercaseFilter computes, a code point at a time: the ASCII letters lowercased, the rest of ASCII dropped, and every
+    // code point beyond ASCII folded by Unicode::AppendFolded(). It has neither the block of Step 1 nor the runs of Step 2
+    bool LowercaseByCodePoint(std::string_view token, std::pmr::string& term)
+    {
+        term.clear();
+
+        for (size_t i{ 0u }; i < token.size();)
+        {
+            if (static_cast<unsigned char>(token[i]) < 0x80u)
+            {
+                if (const char lowercase{ static_cast<char>(token[i++] | 0x20) }; lowercase >= 'a' && lowercase <= 'z')
+                    term.push_back(lowercase);
+
+                continue;
+            }
+
+            char32_t codePoint{ 0u };
+            i += Unicode::Decode(token.substr(i), codePoint);
+
+            Unicode::AppendFolded(term, codePoint);
+        }
+
+        return !term.empty();
+    }
+
+    // Random tokens of ASCII, of letters of the Latin, Greek and Cyrillic blocks the folding covers, of other scripts, marks
+    // and symbols, and of broken UTF-8, separated by spaces
+    std::string MakeUnicodeText(size_t tokensCount)
+    {
+        static constexpr std::array<std::string_view, 24u> PIECES{
+            "word", "Word", "WORD", "x", "42", ",", ".", "'s", "-", "\xC3\xA9", "\xC3\x89", "\xC3\x9F", "\xC5\x92", "\xEF\xAC\x81",
+            "\xCE\x86", "\xCE\xBB", "\xD0\x96", "\xD1\x91", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80", "\xCC\x81", "\xC3", "\xFF", "\xE2\x82",
+        };
+
+        std::mt19937_64 generator{ Fixtures::SEED };
+        std::string     text{};
+
+        for (size_t i{ 0u }; i < tokensCount; ++i)
+        {
+            const size_t piecesCount{ 1u + generator() % 8u };
+            for (size_t j{ 0u }; j < piecesCount; ++j)
+                text.append(PIECES[generator() % PIECES.size()]);
+
+            if (i + 1u < tokensCount)
+                text.push_back(' ');
+        }
+
+        return text;
+    }
+
+    // LowercaseFilter is checked against LowercaseByCodePoint() on every token before it is timed, the run fails if a term
+    // differs. The tokens are views into the text, so that the block of Step 1 reads the bytes after them as in a content
+    void LowercaseUnicode(Benchmark::State& state)
+    {
+        const std::string text{ MakeUnicodeText(64u * 1024u) };
+
+        std::vector<std::string_view> tokens{};
+        for (size_t position{ 0u }; position < text.size();)
+        {
+            const size_t tokenEnd{ std::min(text.find(' ', position), text.size()) };
+            tokens.push_back(std::string_view{ text }.substr(position, tokenEnd - position));
+            position = tokenEnd + 1u;
+        }
+
+        std::pmr::string term{};
+        std::pmr::string expectedTerm{};
+
+        for (const std::string_view token : tokens)
+        {
+            const bool isKept{ LowercaseFilter::Apply(token, text, term) };
+            if (isKept != LowercaseByCodePoint(token, expectedTerm) || (isKept && term != expectedTerm))
+                throw std::runtime_error(std::format("LowercaseFilter folds the token at the offset {0} differently from the code point loop", token.data() - text.data()).c_str());
+        }
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+        {
+            const std::string_view token{ tokens[i++ % tokens.size()] };
+            Benchmark::DoNotOptimize(LowercaseFilter::Apply(token, text, term));
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // StopwordFilter is checked against IsStopwordByHand() on every term of one to four letters and on random ones of five
+    // and six letters before it is timed, the run fails if a decision differs
+    void Stopwords(Benchmark::State& state)
+    {
+        std::vector<std::pmr::string> terms{};
+
+        for (size_t length{ 1u }, termsCount{ 26u }; length <= 4u; ++length, termsCount *= 26u)
+        {
+            for (size_t n{ 0u }; n < termsCount; ++n)
+            {
+                std::pmr::string& term{ terms.emplace_back(length, 'a') };
+                for (size_t i{ 0u }, letters{ n }; i < length; ++i, letters /= 26u)
+                    term[i] = static_cast<char>('a' + letters % 26u);
+            }
+        }
+
+        std::mt19937_64 generator{ Fixtures::SEED };
+        for (size_t i{ 0u }; i < 256u * 1024u; ++i)
+        {
+            std::pmr::string& term{ terms.emplace_back(5u + i % 2u, 'a') };
+            for (char& c : term)
+                c = static_cast<char>('a' + generator() % 26u);
+        }
+
+        for (const char* const stopword : { "their", "there", "these" })
+            terms.emplace_back(stopword);
+
+        for (const std::pmr::string& term : terms)
+        {
+            if (StopwordFilter::Apply(term) == IsStopwordByHand(term))
+                throw std::runtime_error(std::format("StopwordFilter decides differently on \"{0}\"", term).c_str());
+        }
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(StopwordFilter::Apply(terms[i++ % terms.size()]));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // Words of the vocabulary of the reference implementation with the stems it gives them, the examples of the paper among them
+    constexpr std::pair<std::string_view, std::string_view> PORTER_STEMS[]{
+        { "caresses", "caress" }, { "ponies", "poni" }, { "ties", "ti" }, { "caress", "caress" }, { "cats", "cat" }, { "feed", "feed" },
+        { "agreed", "agre" }, { "plastered", "plaster" }, { "bled", "bled" }, { "motoring", "motor" }, { "sing", "sing" },
+        { "conflated", "conflat" }, { "troubled", "troubl" }, { "sized", "size" }, { "hopping", "hop" }, { "tanned", "tan" },
+        { "falling", "fall" }, { "hissing", "hiss" }, { "fizzed", "fizz" }, { "failing", "fail" }, { "filing", "file" },
+        { "happy", "happi" }, { "sky", "sky" }, { "relational", "relat" }, { "conditional", "condit" }, { "rational", "ration" },
+        { "valenci", "valenc" }, { "hesitanci", "hesit" }, { "digitizer", "digit" }, { "conformabli", "conform" },
+        { "radicalli", "radic" }, { "differentli", "differ" }, { "vileli", "vile" }, { "analogousli", "analog" },
+        { "vietnamization", "vietnam" }, { "predication", "predic" }, { "operator", "oper" }, { "feudalism", "feudal" },
+        { "decisiveness", "decis" }, { "hopefulness", "hope" }, { "callousness", "callous" }, { "formaliti", "formal" },
+        { "sensitiviti", "sensit" }, { "sensibiliti", "sensibl" }, { "triplicate", "triplic" }, { "formative", "form" },
+        { "formalize", "formal" }, { "electriciti", "electr" }, { "electrical", "electr" }, { "hopeful", "hope" },
+        { "goodness", "good" }, { "revival", "reviv" }, { "allowance", "allow" }, { "inference", "infer" }, { "airliner", "airlin" },
+        { "gyroscopic", "gyroscop" }, { "adjustable", "adjust" }, { "defensible", "defens" }, { "irritant", "irrit" },
+        { "replacement", "replac" }, { "adjustment", "adjust" }, { "dependent", "depend" }, { "adoption", "adopt" },
+        { "homologou", "homolog" }, { "communism", "commun" }, { "activate", "activ" }, { "angulariti", "angular" },
+        { "homologous", "homolog" }, { "effective", "effect" }, { "bowdlerize", "bowdler" }, { "probate", "probat" },
+        { "rate", "rate" }, { "cease", "ceas" }, { "controll", "control" }, { "roll", "roll" }, { "generalizations", "gener" },
+        { "oscillators", "oscil" }, { "connected", "connect" }, { "connecting", "connect" }, { "connections", "connect" },
+        { "agreement", "agreement" }, { "abbey", "abbei" }, { "ability", "abil" }, { "able", "abl" }, { "absolutely", "absolut" },
+        { "abyss", "abyss" }, { "accompanied", "accompani" }, { "knightly", "knightli" }, { "archaeology", "archaeolog" },
+        { "possibly", "possibl" }, { "generate", "gener" }, { "is", "is" }, { "as", "as" }, { "news", "new" }, { "dying", "dy" },
+        { "lying", "ly" }, { "skies", "ski" }, { "meetings", "meet" }, { "running", "run" },
+    };
+
+    // PorterStemFilter is checked against PORTER_STEMS before it is timed on the same words, the run fails if a stem differs
+    void PorterStem(Benchmark::State& state)
+    {
+        std::pmr::string term{};
+
+        for (const auto& [word, stem] : PORTER_STEMS)
+        {
+            term.assign(word);
+            if (!PorterStemFilter::Apply(term) || term != stem)
+                throw std::runtime_error(std::format("PorterStemFilter stems \"{0}\" to \"{1}\" instead of \"{2}\"", word, term, stem).c_str());
+        }
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+        {
+            term.assign(PORTER_STEMS[i++ % std::size(PORTER_STEMS)].first);
+            Benchmark::DoNotOptimize(PorterStemFilter::Apply(term));
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // The baseline of Analyze<TextAnalyzer>, the chain is expected to run as fast
+    template <typename TextAnalyzer, bool isEnglish>
+    void AnalyzeByHand(Benchmark::State& state)
+    {
+        const std::string text{ Fixtures::MakeEnglishText(64u * 1024u) };
+        std::pmr::string  term{};
+
+        // Both loops have to do the same work for the comparison to hold
+        std::vector<std::string> chainTerms{};
+        TextAnalyzer::ForEachTerm(text, term, [&chainTerms](std::string_view, std::string_view chainTerm) {
+            chainTerms.emplace_back(chainTerm);
+            return true;
+        });
+
+        size_t termIndex{ 0u };
+        ForEachTermByHand<isEnglish>(text, term, [&chainTerms, &termIndex](std::string_view handTerm) {
+            if (termIndex >= chainTerms.size() || chainTerms[termIndex++] != handTerm)
+                throw std::runtime_error(std::format("The hand-written loop differs from the chain at the term {0}", termIndex).c_str());
+        });
+
+        if (termIndex != chainTerms.size())
+            throw std::runtime_error("The hand-written loop has fewer terms than the chain");
+
+        while (state.KeepRunning())
+        {
+            size_t termsCount{ 0u };
+            ForEachTermByHand<isEnglish>(text, term, [&termsCount](std::string_view) { ++termsCount; });
+
+            Benchmark::DoNotOptimize(termsCount);
+        }
+
+        state.SetBytesProcessed(state.GetIterationsCount() * text.size());
+    }
+
+    // A frequent term completes the windows early in the text, a rare one has the whole text scanned
+    void FindSnippets(Benchmark::State& state, size_t termRank)
+    {
+        const std::string   text{ MakeText(64u * 1024u) };
+        const SnippetFinder snippetFinder{ Fixtures::MakeWord(termRank), ANALYZER_TYPE_STANDARD };
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(snippetFinder.Find(text, {}));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    void Add(Benchmark::State& state, size_t documentsCount)
+    {
+        const std::vector<Fixtures::Document>& documents{ Fixtures::GetDocuments(documentsCount) };
+
+        size_t documentsBytes{ 0u };
+        for (const Fixtures::Document& document : documents)
+            documentsBytes += document.Content.size();
+
+        while (state.KeepRunning())
+        {
+            InvertedIndex index{};
+            for (const Fixtures::Document& document : documents)
+                index.Add(document.FileID, document.Content);
+
+            // The destruction of the index is not part of adding to it
+            state.PauseTiming();
+            Benchmark::DoNotOptimize(index);
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount() * documents.size());
+        state.SetBytesProcessed(state.GetIterationsCount() * documentsBytes);
+    }
+
+    void Search(Benchmark::State& state, size_t documentsCount, bool isParallel)
+    {
+        const InvertedIndex&            index{ Fixtures::GetIndex(documentsCount, isParallel) };
+        const std::vector<std::string>& queries{ Fixtures::GetQueries() };
+
+        const InvertedIndex::SearchOptions options{ .Offset = 0u, .Limit = 100u };
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(index.Search(queries[i++ % queries.size()], options));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // As the server searches: everything, the result included, lives in the scratch arena of the request
+    void SearchScratchArena(Benchmark::State& state, size_t documentsCount)
+    {
+        const InvertedIndex&            index{ Fixtures::GetIndex(documentsCount, false) };
+        const std::vector<std::string>& queries{ Fixtures::GetQueries() };
+
+        const InvertedIndex::SearchOptions options{ .Offset = 0u, .Limit = 100u };
+
+        size_t i{ 0u };
+        while (state.KeepRunning())
+        {
+            ScratchArena scratchArena{};
+            Benchmark::DoNotOptimize(index.Search(queries[i++ % queries.size()], options, scratchArena.GetResource()));
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    // A query over the most frequent words, expensive enough to be split over the ThreadPool when allowed to
+    void SearchHeavy(Benchmark::State& state, size_t documentsCount, bool isParallel)
+    {
+        const InvertedIndex& index{ Fixtures::GetIndex(documentsCount, isParallel) };
+
+        std::string query{};
+        for (size_t rank{ 0u }; rank < 8u; ++rank)
+            query.append(Fixtures::MakeWord(rank)).push_back(' ');
+
+        const InvertedIndex::SearchOptions options{ .Offset = 0u, .Limit = 100u };
+
+        while (state.KeepRunning())
+            Benchmark::DoNotOptimize(index.Search(query, options));
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("Analyzer/LowercaseFilter", Lowercase);
+        Benchmark::Register("Analyzer/LowercaseFilter/Unicode", LowercaseUnicode);
+        Benchmark::Register("Analyzer/StopwordFilter", Stopwords);
+        Benchmark::Register("Analyzer/PorterStemFilter", PorterStem);
+        Benchmark::Register("Analyzer/Standard/64KB", Analyze<StandardAnalyzer>);
+        Benchmark::Register("Analyzer/English/64KB", Analyze<EnglishAnalyzer>);
+        Benchmark::Register("Analyzer/Standard/64KB/HandFused", AnalyzeByHand<StandardAnalyzer, false>);
+        Benchmark::Register("Analyzer/English/64KB/HandFused", AnalyzeByHand<EnglishAnalyzer, true>);
+        Benchmark::Register("InvertedIndex/Tokenize/64KB", Tokenize);
+        Benchmark::Register("InvertedIndex/ExtractTerms/64KB", ExtractTerms);
+        Benchmark::Register("SnippetFinder/Find/64KB/Frequent", [](Benchmark::State& state) { FindSnippets(state, 0u); });
+        Benchmark::Register("SnippetFinder/Find/64KB/Rare", [](Benchmark::State& state) { FindSnippets(state, Fixtures::VOCABULARY_SIZE - 1u); });
+
+        for (const size_t documentsCount : DOCUMENTS_COUNTS)
+            Benchmark::Register(std::format("InvertedIndex/Add/{0}", documentsCount), [documentsCount](Benchmark::State& state) { Add(state, documentsCount); });
+
+        for (const size_t documentsCount : DOCUMENTS_COUNTS)
+            Benchmark::Register(std::format("InvertedIndex/Search/{0}", documentsCount), [documentsCount](Benchmark::State& state) { Search(state, documentsCount, false); });
+
+        Benchmark::Register("InvertedIndex/Search/10000/ScratchArena", [](Benchmark::State& state) { SearchScratchArena(state, 10000u); });
+        Benchmark::Register("InvertedIndex/SearchHeavy/50000/Serial", [](Benchmark::State& state) { SearchHeavy(state, 50000u, false); });
+        Benchmark::Register("InvertedIndex/SearchHeavy/50000/Parallel", [](Benchmark::State& state) { SearchHeavy(state, 50000u, true); });
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+#include "IndexFile.h"
+#include "Server.h"
+
+namespace
+{
+    constexpr size_t DOCUMENTS_COUNT{ 10000u };
+
+    // The fixture documents written as the indexer writes them, once into the temporary directory
+    const std::string& GetIndexPath()
+    {
+        static const std::string s_IndexPath{ [] {
+            const std::string indexPath{ (std::filesystem::temp_directory_path() / "course_work_benchmarks.cwix").string() };
+
+            const std::vector<Fixtures::Document>& documents{ Fixtures::GetDocuments(DOCUMENTS_COUNT) };
+
+            IndexFile::Writer writer{ indexPath, ANALYZER_TYPE_STANDARD };
+            for (size_t i{ 0u }; i < documents.size(); ++i)
+                writer.WriteFile(documents[i].FileID, std::format("/corpus/{0}.txt", i));
+
+            std::map<std::string, std::vector<FileSystem::FileID>, std::less<>> termPostings{};
+            for (const Fixtures::Document& document : documents)
+            {
+                std::pmr::vector<std::pmr::string> terms{ StandardAnalyzer::Tokenize(document.Content, std::pmr::get_default_resource()) };
+                std::sort(terms.begin(), terms.end());
+                terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+                for (const auto& term : terms)
+                    termPostings[std::string{ term }].push_back(document.FileID);
+            }
+
+            for (auto& [term, postingList] : termPostings)
+            {
+                std::sort(postingList.begin(), postingList.end());
+                writer.WriteTerm(term, postingList);
+            }
+
+            writer.Finish();
+            return indexPath;
+        }() };
+
+        return s_IndexPath;
+    }
+
+    // GET /search answered by Server::ProcessRequest() the way an event loop answers it, from the parsing of the request to
+    // the buffered response. Once the thread caches are warm the path must not touch the global heap, the benchmark
+    // fails the run if it does
+    void ProcessRequest(Benchmark::State& state)
+    {
+        const std::vector<std::string>& queries{ Fixtures::GetQueries() };
+
+        std::vector<std::string> requests{};
+        for (const std::string& query : queries)
+        {
+            std::string encodedQuery{ query };
+            for (size_t i{ encodedQuery.find(' ') }; i != std::string::npos; i = encodedQuery.find(' ', i))
+                encodedQuery.replace(i, 1u, "%20");
+
+            requests.push_back(std::format("GET /search?q={0}&offset=0&limit=10 HTTP/1.1\r\n"
+                                           "Host: localhost:8080\r\n"
+                                           "Accept: */*\r\n\r\n",
+                encodedQuery));
+        }
+
+        // No workers, so that every search runs on the calling thread like the searches of an event loop
+        const auto server{ std::make_unique<Server>(ServerConfig{ .WorkersCount = 0u, .IndexPath = GetIndexPath() }) };
+        server->StartInProcess();
+
+        std::string outputBuffer{};
+        outputBuffer.reserve(64u * 1024u);
+
+        for (const std::string& request : requests)
+        {
+            server->ProcessHTTPRequest(request, outputBuffer);
+            outputBuffer.clear();
+        }
+
+        size_t i{ 0u };
+        size_t responsesBytes{ 0u };
+
+        while (state.KeepRunning())
+        {
+            server->ProcessHTTPRequest(requests[i++ % requests.size()], outputBuffer);
+
+            responsesBytes += outputBuffer.size();
+            outputBuffer.clear();
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetBytesProcessed(responsesBytes);
+
+        if (state.GetAllocationsCount() != 0u)
+            throw std::runtime_error(std::format("Server::ProcessRequest() made {0} heap allocations in {1} requests", state.GetAllocationsCount(), state.GetIterationsCount()).c_str());
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("Server/ProcessRequest/HTTPSearch", ProcessRequest);
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+namespace
+{
+    constexpr size_t TASKS_PER_ITERATION{ 1000u };
+
+    void AddTaskThroughput(Benchmark::State& state)
+    {
+        ThreadPool& threadPool{ Fixtures::GetThreadPool() };
+
+        std::vector<std::future<void>> taskFutures{};
+        taskFutures.reserve(TASKS_PER_ITERATION);
+
+        while (state.KeepRunning())
+        {
+            for (size_t i{ 0u }; i < TASKS_PER_ITERATION; ++i)
+                taskFutures.push_back(threadPool.AddTask(0u, []() {}));
+
+            for (auto& taskFuture : taskFutures)
+                taskFuture.get();
+
+            taskFutures.clear();
+        }
+
+        state.SetItemsProcessed(state.GetIterationsCount() * TASKS_PER_ITERATION);
+    }
+
+    // Time from AddTask() to the start of the task on a worker, the pool being otherwise idle
+    void AddTaskLatency(Benchmark::State& state)
+    {
+        ThreadPool& threadPool{ Fixtures::GetThreadPool() };
+
+        std::vector<double> latenciesMicroseconds{};
+        latenciesMicroseconds.reserve(state.GetIterationsCount());
+
+        while (state.KeepRunning())
+        {
+            const Benchmark::Clock::time_point addTimePoint{ Benchmark::Clock::now() };
+            const Benchmark::Clock::time_point startTimePoint{ threadPool.AddTask(0u, []() { return Benchmark::Clock::now(); }).get() };
+
+            latenciesMicroseconds.push_back(std::chrono::duration<double, std::micro>(startTimePoint - addTimePoint).count());
+        }
+
+        std::sort(latenciesMicroseconds.begin(), latenciesMicroseconds.end());
+
+        const auto percentile{ [&latenciesMicroseconds](double fraction) {
+            return latenciesMicroseconds[std::min(static_cast<size_t>(fraction * static_cast<double>(latenciesMicroseconds.size())), latenciesMicroseconds.size() - 1u)];
+        } };
+
+        state.SetItemsProcessed(state.GetIterationsCount());
+        state.SetCounter("p50_us", percentile(0.50));
+        state.SetCounter("p99_us", percentile(0.99));
+        state.SetCounter("max_us", latenciesMicroseconds.back());
+    }
+
+    void ParallelFor(Benchmark::State& state)
+    {
+        ThreadPool& threadPool{ Fixtures::GetThreadPool() };
+
+        std::vector<uint64_t> values(TASKS_PER_ITERATION, 0u);
+
+        while (state.KeepRunning())
+            threadPool.ParallelFor(0u, values.size(), [&values](size_t i) { ++values[i]; });
+
+        Benchmark::DoNotOptimize(values);
+        state.SetItemsProcessed(state.GetIterationsCount() * TASKS_PER_ITERATION);
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("ThreadPool/AddTask/Throughput", AddTaskThroughput);
+        Benchmark::Register("ThreadPool/AddTask/Latency", AddTaskLatency);
+        Benchmark::Register("ThreadPool/ParallelFor", ParallelFor);
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
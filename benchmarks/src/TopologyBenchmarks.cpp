@@ -0,0 +1,108 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+
+#include "Topology.h"
+
+namespace
+{
+    constexpr size_t POSTING_LISTS_COUNT{ 20000u };
+    constexpr size_t POSTINGS_COUNT{ 3000000u };
+
+    // Forwards to its upstream and counts the requests, to tell how many the pool sends to the node resource
+    class CountingResource final : public std::pmr::memory_resource
+    {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream) noexcept
+            : m_Upstream{ upstream }
+        {
+        }
+
+    public:
+        uint64_t GetAllocationsCount() const noexcept { return m_AllocationsCount; }
+        uint64_t GetDeallocationsCount() const noexcept { return m_DeallocationsCount; }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++m_AllocationsCount;
+            return m_Upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+        {
+            ++m_DeallocationsCount;
+            m_Upstream->deallocate(pointer, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    private:
+        std::pmr::memory_resource* m_Upstream{ nullptr };
+
+        uint64_t m_AllocationsCount{ 0u };
+        uint64_t m_DeallocationsCount{ 0u };
+    };
+
+    // Posting lists grown one posting at a time in a pool over a node, as the placed shards of an index grow theirs, with
+    // a Zipfian skew so that a few lists outgrow the largest block of the pool and are regrown upstream. The node is
+    // simulated, its regions come from the global heap, so the allocations per iteration count the regions it commits.
+    // Every list is then read back, the run fails if two blocks have overlapped
+    void FillPostingLists(Benchmark::State& state)
+    {
+        const ZipfDistribution wordDistribution{ POSTING_LISTS_COUNT, Fixtures::ZIPF_EXPONENT };
+
+        std::vector<uint32_t> listIndices(POSTINGS_COUNT);
+        std::mt19937_64       generator{ Fixtures::SEED };
+        for (uint32_t& listIndex : listIndices)
+            listIndex = static_cast<uint32_t>(wordDistribution(generator));
+
+        uint64_t upstreamAllocationsCount{ 0u };
+        uint64_t upstreamDeallocationsCount{ 0u };
+
+        while (state.KeepRunning())
+        {
+            NodeMemoryResource nodeMemory{};
+            nodeMemory.SetNode(0u, true);
+
+            CountingResource                        countingResource{ &nodeMemory };
+            std::pmr::unsynchronized_pool_resource pool{ &countingResource };
+
+            {
+                std::pmr::vector<std::pmr::vector<FileSystem::FileID>> postingLists{ &pool };
+                postingLists.resize(POSTING_LISTS_COUNT);
+
+                for (const uint32_t listIndex : listIndices)
+                {
+                    std::pmr::vector<FileSystem::FileID>& postingList{ postingLists[listIndex] };
+                    postingList.push_back(postingList.size());
+                }
+
+                for (const auto& postingList : postingLists)
+                {
+                    for (size_t i{ 0u }; i < postingList.size(); ++i)
+                    {
+                        if (postingList[i] != i)
+                            throw std::runtime_error("NodeMemoryResource has handed out overlapping blocks");
+                    }
+                }
+            }
+
+            pool.release();
+
+            upstreamAllocationsCount += countingResource.GetAllocationsCount();
+            upstreamDeallocationsCount += countingResource.GetDeallocationsCount();
+        }
+
+        const double iterations{ static_cast<double>(state.GetIterationsCount()) };
+
+        state.SetItemsProcessed(state.GetIterationsCount() * POSTINGS_COUNT);
+        state.SetCounter("upstream_allocations", static_cast<double>(upstreamAllocationsCount) / iterations);
+        state.SetCounter("upstream_releases", static_cast<double>(upstreamDeallocationsCount) / iterations);
+    }
+
+    const bool s_AreBenchmarksRegistered{ [] {
+        Benchmark::Register("NodeMemoryResource/FillPostingLists/20000", FillPostingLists);
+
+        return true;
+    }() };
+} // namespace
\ No newline at end of file
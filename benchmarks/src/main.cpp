@@ -0,0 +1,59 @@
+#include "Benchmark.h"
+
+#include "Log.h"
+
+#include <exception>
+#include <iostream>
+
+int main(int argc, const char* argv[])
+{
+    constexpr std::string_view usage{ "Usage: [benchmarks] [--filter TEXT] [--min-time-ms N] [--repetitions N] [--json FILE]" };
+
+    Benchmark::RunOptions options{};
+
+    try
+    {
+        for (int i{ 1 }; i < argc; i += 2)
+        {
+            const std::string_view option{ argv[i] };
+
+            if (i + 1 >= argc)
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+
+            if (option == "--filter")
+                options.Filter = argv[i + 1];
+            else if (option == "--min-time-ms")
+                options.MinTimeSeconds = static_cast<double>(std::stoul(argv[i + 1])) / 1000.0;
+            else if (option == "--repetitions")
+                options.RepetitionsCount = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            else if (option == "--json")
+                options.JSONPath = argv[i + 1];
+            else
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n"
+                  << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Log::Init("BENCHMARKS");
+
+    int exitCode{ EXIT_SUCCESS };
+
+    try
+    {
+        if (Benchmark::RunAll(options) == 0u)
+            std::cerr << "No benchmark matches the filter" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_CRITICAL_TAG("BENCHMARKS", "Exception: {0}", e.what());
+        exitCode = EXIT_FAILURE;
+    }
+
+    Log::Shutdown();
+    return exitCode;
+}
\ No newline at end of file
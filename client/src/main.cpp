@@ -2,6 +2,7 @@
 #include <format>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -10,11 +11,15 @@ namespace Utils
 {
     namespace
     {
-        void RecvAll(SOCKET socket, char* buffer, uint32_t length);
-        void SendAll(SOCKET socket, const char* buffer, uint32_t length);
+        void             RecvAll(SOCKET socket, char* buffer, uint32_t length);
+        void             SendAll(SOCKET socket, const char* buffer, uint32_t length);
+        std::string_view GetErrorDescription(uint32_t errorCode);
     } // namespace
 } // namespace Utils
 
+// A response that starts with this marker instead of the number of the results carries an error code (4 bytes, network byte order)
+inline constexpr uint32_t BINARY_ERROR_MARKER{ 0xFFFFFFFFu };
+
 int main(int argc, const char* argv[])
 {
     if (argc != 3)
@@ -101,6 +106,17 @@ int main(int argc, const char* argv[])
             Utils::RecvAll(connectSocket, reinterpret_cast<char*>(&resultsCountNetworkOrder), sizeof(resultsCountNetworkOrder));
             const uint32_t resultsCount{ ntohl(resultsCountNetworkOrder) };
 
+            // The server has rejected the query, the connection stays open for the next one
+            if (resultsCount == BINARY_ERROR_MARKER)
+            {
+                uint32_t errorCodeNetworkOrder{ 0u };
+                Utils::RecvAll(connectSocket, reinterpret_cast<char*>(&errorCodeNetworkOrder), sizeof(errorCodeNetworkOrder));
+                const uint32_t errorCode{ ntohl(errorCodeNetworkOrder) };
+
+                std::cout << "Server error " << errorCode << ": " << Utils::GetErrorDescription(errorCode) << std::endl;
+                continue;
+            }
+
             std::cout << "Number of results: " << resultsCount << std::endl;
 
             // Step 5
@@ -194,5 +210,19 @@ namespace Utils
             }
         }
 
+        std::string_view GetErrorDescription(uint32_t errorCode)
+        {
+            // See BinaryErrorCode of the server
+            switch (errorCode)
+            {
+                case 1u:
+                    return "the server is overloaded, try again later";
+                case 2u:
+                    return "the query has timed out";
+                default:
+                    return "unknown error";
+            }
+        }
+
     } // namespace
 } // namespace Utils
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "Analyzer.h"
+#include "FileSystem.h"
+#include "IndexFile.h"
+#include "Log.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
+
+#include <psapi.h>
+
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <queue>
+
+namespace
+{
+    struct FileEntry
+    {
+        std::string Path{};
+        size_t      Size{ 0u };
+    };
+
+    using PostingList = std::vector<FileSystem::FileID>;
+    using TermPostings = std::pair<std::string, PostingList>;
+
+    // Lets the map be looked up with the terms of the scratch arena without copying them first
+    struct TermHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view term) const noexcept { return std::hash<std::string_view>{}(term); }
+    };
+
+    // The inverted files of a single thread, sorted by term so that all runs can be merged in one pass
+    struct Run
+    {
+        std::vector<TermPostings>              Terms{};
+        std::vector<size_t>                    FileIndices{};          // Files that have been read successfully and inverted
+        std::vector<std::pair<size_t, size_t>> DuplicateFileIndices{}; // File, canonical file: files with the content of another one
+        size_t                                 ReadBytes{ 0u };
+        size_t                                 MemoryBytes{ 0u }; // Approximate memory held by the terms and their posting lists
+    };
+
+    // The files inverted so far by the hash of their content, shared by all the threads
+    struct ContentIndex
+    {
+        std::mutex                                        Lock{};
+        std::unordered_map<uint64_t, std::vector<size_t>> FileIndices{}; // Several files only on a hash collision
+    };
+
+    struct RunCursor
+    {
+        size_t RunIndex{ 0u };
+        size_t TermIndex{ 0u };
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double GetElapsedSeconds(Clock::time_point startTimePoint)
+    {
+        return std::chrono::duration<double>(Clock::now() - startTimePoint).count();
+    }
+
+    double ToMegabytes(size_t bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+
+    // Step 1
+    // Lists the regular files of the tree, largest first so that the huge ones are not picked up last
+    std::vector<FileEntry> CrawlDirectory(const std::string& directory)
+    {
+        std::vector<FileEntry> files{};
+
+        for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator{ directory })
+        {
+            if (directoryEntry.is_regular_file())
+                files.push_back({ .Path = directoryEntry.path().string(), .Size = static_cast<size_t>(directoryEntry.file_size()) });
+        }
+
+        std::sort(files.begin(), files.end(), [](const FileEntry& lhs, const FileEntry& rhs) { return lhs.Size > rhs.Size; });
+
+        return files;
+    }
+
+    // Registers the file as the canonical file of its content, unless a file inverted before has the same content: its
+    // index is returned then. A hash match is confirmed byte by byte against that file read again, which only the
+    // duplicates pay for
+    std::optional<size_t> FindCanonicalFile(const std::vector<FileEntry>& files, size_t fileIndex, std::string_view content, ContentIndex& contentIndex, std::string& canonicalContent)
+    {
+        const uint64_t contentHash{ FileSystem::HashContent(content) };
+
+        std::vector<size_t> canonicalFileIndices{};
+        {
+            std::lock_guard _{ contentIndex.Lock };
+
+            const auto [it, isInserted]{ contentIndex.FileIndices.try_emplace(contentHash) };
+            if (isInserted)
+            {
+                it->second.push_back(fileIndex);
+                return std::nullopt;
+            }
+
+            canonicalFileIndices = it->second;
+        }
+
+        for (const size_t canonicalFileIndex : canonicalFileIndices)
+        {
+            if (FileSystem::ReadFile(files[canonicalFileIndex].Path, canonicalContent) && canonicalContent == content)
+                return canonicalFileIndex;
+        }
+
+        // A hash collision, the content is a new one
+        std::lock_guard _{ contentIndex.Lock };
+        contentIndex.FileIndices[contentHash].push_back(fileIndex);
+
+        return std::nullopt;
+    }
+
+    // Step 2
+    // Inverts the files the thread picks into a private map that no other thread touches, then sorts it into a run. A file
+    // with the content of a file inverted before by any thread is not inverted, it is recorded as a duplicate of that file
+    void BuildRun(const std::vector<FileEntry>& files, AnalyzerType analyzerType, std::atomic<size_t>& nextFileIndex, ContentIndex& contentIndex, Run& run)
+    {
+        std::unordered_map<std::string, PostingList, TermHash, std::equal_to<>> termPostings{};
+        std::string                                                             content{};
+        std::string                                                             canonicalContent{};
+
+        for (size_t fileIndex{ nextFileIndex.fetch_add(1u) }; fileIndex < files.size(); fileIndex = nextFileIndex.fetch_add(1u))
+        {
+            const FileEntry& file{ files[fileIndex] };
+
+            if (!FileSystem::ReadFile(file.Path, content))
+            {
+                LOG_ERROR_TAG("INDEXER", "Failed to open file: {0}", file.Path);
+                continue;
+            }
+
+            run.ReadBytes += content.size();
+
+            if (const std::optional<size_t> canonicalFileIndex{ FindCanonicalFile(files, fileIndex, content, contentIndex, canonicalContent) })
+            {
+                run.DuplicateFileIndices.emplace_back(fileIndex, *canonicalFileIndex);
+                continue;
+            }
+
+            const FileSystem::FileID fileID{ FileSystem::GetFileID(file.Path) };
+
+            // The terms of a file are dropped as a whole, only the ones new to the run are copied into the map
+            ScratchArena scratchArena{};
+
+            std::pmr::vector<std::pmr::string> terms{ VisitAnalyzer(analyzerType, [&](auto analyzer) { return analyzer.Tokenize(content, scratchArena.GetResource()); }) };
+            std::sort(terms.begin(), terms.end());
+            terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+            for (const auto& term : terms)
+            {
+                auto termPostingsIt{ termPostings.find(std::string_view{ term }) };
+                if (termPostingsIt == termPostings.end())
+                    termPostingsIt = termPostings.try_emplace(std::string{ term }).first;
+
+                termPostingsIt->second.push_back(fileID);
+            }
+
+            run.FileIndices.push_back(fileIndex);
+        }
+
+        run.Terms.reserve(termPostings.size());
+
+        for (auto& [term, postingList] : termPostings)
+        {
+            run.MemoryBytes += sizeof(TermPostings) + term.capacity() + postingList.capacity() * sizeof(FileSystem::FileID);
+            run.Terms.emplace_back(term, std::move(postingList));
+        }
+
+        std::sort(run.Terms.begin(), run.Terms.end(), [](const TermPostings& lhs, const TermPostings& rhs) { return lhs.first < rhs.first; });
+    }
+
+    // Step 3
+    // K-way merge of the sorted runs, every term is written once with the posting lists of all runs. The files come first,
+    // the duplicates included, and the duplicate records last, as the index file format wants them
+    void MergeRuns(std::vector<Run>& runs, const std::vector<FileEntry>& files, IndexFile::Writer& writer)
+    {
+        for (const Run& run : runs)
+        {
+            for (const size_t fileIndex : run.FileIndices)
+                writer.WriteFile(FileSystem::GetFileID(files[fileIndex].Path), files[fileIndex].Path);
+
+            for (const auto& [fileIndex, _] : run.DuplicateFileIndices)
+                writer.WriteFile(FileSystem::GetFileID(files[fileIndex].Path), files[fileIndex].Path);
+        }
+
+        const auto cursorIsAfter{ [&runs](const RunCursor& lhs, const RunCursor& rhs) {
+            return runs[lhs.RunIndex].Terms[lhs.TermIndex].first > runs[rhs.RunIndex].Terms[rhs.TermIndex].first;
+        } };
+
+        std::priority_queue<RunCursor, std::vector<RunCursor>, decltype(cursorIsAfter)> cursors{ cursorIsAfter };
+
+        for (size_t runIndex{ 0u }; runIndex < runs.size(); ++runIndex)
+        {
+            if (!runs[runIndex].Terms.empty())
+                cursors.push({ .RunIndex = runIndex, .TermIndex = 0u });
+        }
+
+        std::string term{};
+        PostingList postingList{};
+
+        while (!cursors.empty())
+        {
+            term = runs[cursors.top().RunIndex].Terms[cursors.top().TermIndex].first;
+            postingList.clear();
+
+            while (!cursors.empty() && runs[cursors.top().RunIndex].Terms[cursors.top().TermIndex].first == term)
+            {
+                RunCursor     cursor{ cursors.top() };
+                TermPostings& termPostings{ runs[cursor.RunIndex].Terms[cursor.TermIndex] };
+                cursors.pop();
+
+                postingList.insert(postingList.end(), termPostings.second.begin(), termPostings.second.end());
+                PostingList{}.swap(termPostings.second);
+
+                if (++cursor.TermIndex < runs[cursor.RunIndex].Terms.size())
+                    cursors.push(cursor);
+            }
+
+            // The runs hold files in the order the threads happened to pick them, sorting makes the output reproducible
+            std::sort(postingList.begin(), postingList.end());
+
+            writer.WriteTerm(term, postingList);
+        }
+
+        for (const Run& run : runs)
+        {
+            for (const auto& [fileIndex, canonicalFileIndex] : run.DuplicateFileIndices)
+                writer.WriteDuplicate(FileSystem::GetFileID(files[fileIndex].Path), FileSystem::GetFileID(files[canonicalFileIndex].Path));
+        }
+
+        writer.Finish();
+    }
+
+    size_t GetPeakWorkingSetSize()
+    {
+        PROCESS_MEMORY_COUNTERS memoryCounters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+            return 0u;
+
+        return memoryCounters.PeakWorkingSetSize;
+    }
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    constexpr std::string_view usage{ "Usage: [indexer] <files_directory> <index_file> [--threads N] [--analyzer standard|english]" };
+
+    if (argc < 3 || argc % 2 == 0)
+    {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string filesDirectory{ argv[1] };
+    const std::string indexPath{ argv[2] };
+    uint32_t          threadsCount{ std::max(std::thread::hardware_concurrency(), 1u) };
+    AnalyzerType      analyzerType{ ANALYZER_TYPE_STANDARD };
+
+    try
+    {
+        // The "--option value" pairs that follow the positional arguments
+        for (int i{ 3 }; i < argc; i += 2)
+        {
+            const std::string_view option{ argv[i] };
+
+            if (option == "--threads")
+                threadsCount = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            else if (option != "--analyzer" || !ParseAnalyzerType(argv[i + 1], analyzerType))
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+        }
+
+        if (threadsCount == 0u)
+            throw std::invalid_argument("At least one thread is required");
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n"
+                  << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Log::Init("INDEXER");
+
+    int exitCode{ EXIT_SUCCESS };
+
+    try
+    {
+        const Clock::time_point startTimePoint{ Clock::now() };
+
+        const std::vector<FileEntry> files{ CrawlDirectory(filesDirectory) };
+        LOG_INFO_TAG("INDEXER", "Found {0} files in {1:.3f} s", files.size(), GetElapsedSeconds(startTimePoint));
+
+        const Clock::time_point invertTimePoint{ Clock::now() };
+
+        // The calling thread builds a run too, so the pool only needs the remaining threads
+        ThreadPool threadPool{};
+        threadPool.Create(threadsCount - 1u);
+        threadPool.Start();
+
+        std::vector<Run>    runs(threadsCount);
+        std::atomic<size_t> nextFileIndex{ 0u };
+        ContentIndex        contentIndex{};
+
+        threadPool.ParallelFor(0u, runs.size(), [&files, analyzerType, &nextFileIndex, &contentIndex, &runs](size_t runIndex) { BuildRun(files, analyzerType, nextFileIndex, contentIndex, runs[runIndex]); });
+        threadPool.Shutdown();
+
+        size_t readBytes{ 0u };
+        size_t runsMemoryBytes{ 0u };
+        for (const Run& run : runs)
+        {
+            readBytes += run.ReadBytes;
+            runsMemoryBytes += run.MemoryBytes;
+        }
+
+        const double invertSeconds{ GetElapsedSeconds(invertTimePoint) };
+        LOG_INFO_TAG("INDEXER", "Inverted {0:.1f} MB with {1} threads in {2:.3f} s, {3:.1f} MB/s", ToMegabytes(readBytes), threadsCount, invertSeconds, invertSeconds > 0.0 ? ToMegabytes(readBytes) / invertSeconds : 0.0);
+
+        const Clock::time_point mergeTimePoint{ Clock::now() };
+
+        IndexFile::Writer writer{ indexPath, analyzerType };
+        MergeRuns(runs, files, writer);
+
+        LOG_INFO_TAG("INDEXER", "Merged {0} runs into {1} terms and {2} postings in {3:.3f} s, {4} duplicate files have not been inverted", runs.size(), writer.GetTermsCount(), writer.GetPostingsCount(), GetElapsedSeconds(mergeTimePoint), writer.GetDuplicatesCount());
+
+        const double totalSeconds{ GetElapsedSeconds(startTimePoint) };
+        LOG_INFO_TAG("INDEXER", "Wrote {0} files to {1} ({2:.1f} MB) in {3:.3f} s in total, {4:.1f} MB/s", writer.GetFilesCount(), indexPath, ToMegabytes(writer.GetWrittenBytes()), totalSeconds, totalSeconds > 0.0 ? ToMegabytes(readBytes) / totalSeconds : 0.0);
+        LOG_INFO_TAG("INDEXER", "Memory: runs {0:.1f} MB, peak working set {1:.1f} MB", ToMegabytes(runsMemoryBytes), ToMegabytes(GetPeakWorkingSetSize()));
+    }
+    catch (const std::exception& e)
+    {
+        LOG_CRITICAL_TAG("INDEXER", "Exception: {0}", e.what());
+        exitCode = EXIT_FAILURE;
+    }
+
+    Log::Shutdown();
+    return exitCode;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+
+LatencyHistogram::LatencyHistogram()
+    : m_Counts(s_CountsSize, 0u)
+{
+}
+
+void LatencyHistogram::Record(uint64_t valueNS)
+{
+    valueNS = std::min(valueNS, s_HighestTrackableValue);
+
+    ++m_Counts[GetCountsIndex(valueNS)];
+    ++m_TotalCount;
+
+    m_Min = std::min(m_Min, valueNS);
+    m_Max = std::max(m_Max, valueNS);
+    m_Sum += static_cast<double>(valueNS);
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other)
+{
+    for (size_t i{ 0u }; i < s_CountsSize; ++i)
+        m_Counts[i] += other.m_Counts[i];
+
+    m_TotalCount += other.m_TotalCount;
+    m_Min = std::min(m_Min, other.m_Min);
+    m_Max = std::max(m_Max, other.m_Max);
+    m_Sum += other.m_Sum;
+}
+
+uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+    if (m_TotalCount == 0u)
+        return 0u;
+
+    const double   fraction{ std::clamp(percentile, 0.0, 100.0) / 100.0 };
+    const uint64_t targetCount{ std::max<uint64_t>(static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(m_TotalCount))), 1u) };
+
+    uint64_t count{ 0u };
+    for (size_t i{ 0u }; i < s_CountsSize; ++i)
+    {
+        count += m_Counts[i];
+
+        if (count >= targetCount)
+            return std::min(GetHighestEquivalentValue(GetValueFromIndex(i)), m_Max);
+    }
+
+    return m_Max;
+}
+
+double LatencyHistogram::GetMean() const noexcept
+{
+    return m_TotalCount > 0u ? m_Sum / static_cast<double>(m_TotalCount) : 0.0;
+}
+
+std::string LatencyHistogram::FormatPercentileDistribution(double valueUnitScale) const
+{
+    std::string distribution{ std::format("{0:>12} {1:>14} {2:>10} {3:>14}\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)") };
+
+    if (m_TotalCount == 0u)
+        return distribution;
+
+    // Halves the distance to 100% every 5 steps, like HdrHistogram does with 5 ticks per half distance
+    constexpr uint32_t ticksPerHalfDistance{ 5u };
+
+    double percentile{ 0.0 };
+    while (true)
+    {
+        const uint64_t value{ GetValueAtPercentile(percentile) };
+
+        uint64_t count{ 0u };
+        for (size_t i{ 0u }; i < s_CountsSize && GetValueFromIndex(i) <= value; ++i)
+            count += m_Counts[i];
+
+        const double fraction{ static_cast<double>(count) / static_cast<double>(m_TotalCount) };
+
+        if (count == m_TotalCount)
+        {
+            distribution.append(std::format("{0:>12.3f} {1:>14.12f} {2:>10}\n", static_cast<double>(m_Max) / valueUnitScale, 1.0, m_TotalCount));
+            break;
+        }
+
+        distribution.append(std::format("{0:>12.3f} {1:>14.12f} {2:>10} {3:>14.2f}\n", static_cast<double>(value) / valueUnitScale, fraction, count, 1.0 / (1.0 - fraction)));
+
+        const double halfDistance{ std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - percentile))) + 1.0) };
+        percentile += 100.0 / (halfDistance * ticksPerHalfDistance);
+    }
+
+    distribution.append(std::format("#[Mean    = {0:>12.3f}, Max        = {1:>12.3f}]\n", GetMean() / valueUnitScale, static_cast<double>(m_Max) / valueUnitScale));
+    distribution.append(std::format("#[Min     = {0:>12.3f}, Total count = {1:>11}]\n", static_cast<double>(GetMin()) / valueUnitScale, m_TotalCount));
+
+    return distribution;
+}
+
+size_t LatencyHistogram::GetCountsIndex(uint64_t value)
+{
+    // Values below s_SubBucketCount are in bucket 0, every next bucket covers twice the range at half the resolution
+    const uint32_t bucketIndex{ static_cast<uint32_t>(63 - std::countl_zero(value | s_SubBucketMask)) - s_SubBucketHalfCountMagnitude };
+    const uint64_t subBucketIndex{ value >> bucketIndex };
+
+    return (static_cast<size_t>(bucketIndex + 1u) << s_SubBucketHalfCountMagnitude) + static_cast<size_t>(subBucketIndex - s_SubBucketHalfCount);
+}
+
+uint64_t LatencyHistogram::GetValueFromIndex(size_t index)
+{
+    int64_t  bucketIndex{ static_cast<int64_t>(index >> s_SubBucketHalfCountMagnitude) - 1 };
+    uint64_t subBucketIndex{ (index & (s_SubBucketHalfCount - 1u)) + s_SubBucketHalfCount };
+
+    if (bucketIndex < 0)
+    {
+        subBucketIndex -= s_SubBucketHalfCount;
+        bucketIndex = 0;
+    }
+
+    return subBucketIndex << bucketIndex;
+}
+
+uint64_t LatencyHistogram::GetHighestEquivalentValue(uint64_t value)
+{
+    const uint32_t bucketIndex{ static_cast<uint32_t>(63 - std::countl_zero(value | s_SubBucketMask)) - s_SubBucketHalfCountMagnitude };
+
+    return value + (1ull << bucketIndex) - 1u;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A histogram of latencies in nanoseconds in the layout of HdrHistogram: values are grouped into buckets of powers of 2,
+// each split into SUB_BUCKETS_COUNT linear sub-buckets, which keeps every recorded value within 0.1% of its true value.
+// Recording is a few shifts and an increment, so that every request can be recorded without sampling.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+public:
+    void Record(uint64_t valueNS);
+
+    // Adds the counts of another histogram, e.g. to merge the histograms of the threads
+    void Add(const LatencyHistogram& other);
+
+    // The value below which the given percentage [0, 100] of the recorded values are
+    uint64_t GetValueAtPercentile(double percentile) const;
+
+    uint64_t GetTotalCount() const noexcept { return m_TotalCount; }
+    uint64_t GetMin() const noexcept { return m_TotalCount > 0u ? m_Min : 0u; }
+    uint64_t GetMax() const noexcept { return m_Max; }
+    double   GetMean() const noexcept;
+
+    // Percentile distribution in the text format of HdrHistogram, which its plotter takes as it is
+    std::string FormatPercentileDistribution(double valueUnitScale) const;
+
+private:
+    static size_t   GetCountsIndex(uint64_t value);
+    static uint64_t GetValueFromIndex(size_t index);
+    static uint64_t GetHighestEquivalentValue(uint64_t value);
+
+private:
+    static constexpr uint32_t s_SubBucketHalfCountMagnitude{ 10u };
+    static constexpr uint64_t s_SubBucketHalfCount{ 1ull << s_SubBucketHalfCountMagnitude };
+    static constexpr uint64_t s_SubBucketCount{ 2u * s_SubBucketHalfCount };
+    static constexpr uint64_t s_SubBucketMask{ s_SubBucketCount - 1u };
+
+    // Buckets up to 2^42 ns, more than an hour, larger values are clamped
+    static constexpr uint32_t s_BucketsCount{ 32u };
+    static constexpr size_t   s_CountsSize{ (s_BucketsCount + 1u) * s_SubBucketHalfCount };
+    static constexpr uint64_t s_HighestTrackableValue{ (s_SubBucketCount << (s_BucketsCount - 1u)) - 1u };
+
+    std::vector<uint64_t> m_Counts{};
+
+    uint64_t m_TotalCount{ 0u };
+    uint64_t m_Min{ UINT64_MAX };
+    uint64_t m_Max{ 0u };
+    double   m_Sum{ 0.0 };
+};
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "LoadGenerator.h"
+
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Schedule
+    {
+        Clock::time_point StartTimePoint{};  // When the first request of the run is due
+        Clock::time_point WarmupEndTimePoint{};
+        Clock::time_point EndTimePoint{};
+        Clock::time_point CutoffTimePoint{}; // Open loop: past it the requests still due are given up
+    };
+
+    uint64_t ToNanoseconds(Clock::duration duration)
+    {
+        return static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0));
+    }
+
+    // Sends a request and counts its outcome, returns false if the connection failed
+    bool SendRequest(SearchClient& client, std::string_view query, Clock::time_point dueTimePoint, bool isMeasured, LoadResult& result)
+    {
+        const Clock::time_point sendTimePoint{ Clock::now() };
+
+        SearchResponse response{};
+        try
+        {
+            response = client.Search(query);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_TAG_THROTTLED("LOADGEN", 1000u, "Request failed: {0}", e.what());
+            client.Disconnect();
+
+            if (isMeasured)
+                ++result.ErrorsCount;
+
+            return false;
+        }
+
+        if (!isMeasured)
+            return true;
+
+        const Clock::time_point receiveTimePoint{ Clock::now() };
+
+        result.ResponseTimes.Record(ToNanoseconds(receiveTimePoint - dueTimePoint));
+        result.ServiceTimes.Record(ToNanoseconds(receiveTimePoint - sendTimePoint));
+        result.ReceivedBytes += response.ReceivedBytes;
+
+        switch (response.Status)
+        {
+            case SearchStatus::Ok:
+                ++result.OkCount;
+                result.HitsCount += response.TotalHitsCount > 0u ? 1u : 0u;
+                break;
+            case SearchStatus::Overloaded:
+                ++result.OverloadedCount;
+                break;
+            case SearchStatus::TimedOut:
+                ++result.TimedOutCount;
+                break;
+            default:
+                ++result.FailedCount;
+                break;
+        }
+
+        return true;
+    }
+
+    void RunClosedLoop(SearchClient& client, const QuerySet& querySet, size_t queryIndex, const Schedule& schedule, LoadResult& result)
+    {
+        std::this_thread::sleep_until(schedule.StartTimePoint);
+
+        for (Clock::time_point now{ Clock::now() }; now < schedule.EndTimePoint; now = Clock::now())
+        {
+            // Backs off after a connection error instead of spinning on a server that is down
+            if (!SendRequest(client, querySet.GetQuery(queryIndex++), now, now >= schedule.WarmupEndTimePoint, result))
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    void RunOpenLoop(SearchClient& client, const QuerySet& querySet, size_t queryIndex, const Schedule& schedule, Clock::duration interval, LoadResult& result)
+    {
+        Clock::time_point dueTimePoint{ schedule.StartTimePoint };
+
+        for (; dueTimePoint < schedule.EndTimePoint; dueTimePoint += interval)
+        {
+            // A connection that fell behind sends right away, the delay shows up in the response times
+            std::this_thread::sleep_until(dueTimePoint);
+
+            if (Clock::now() >= schedule.CutoffTimePoint)
+                break;
+
+            SendRequest(client, querySet.GetQuery(queryIndex++), dueTimePoint, dueTimePoint >= schedule.WarmupEndTimePoint, result);
+        }
+
+        // The requests that were due but never sent waited at least until the cutoff, dropping them would hide the stall
+        const Clock::time_point cutoffTimePoint{ Clock::now() };
+
+        for (; dueTimePoint < schedule.EndTimePoint; dueTimePoint += interval)
+        {
+            if (dueTimePoint < schedule.WarmupEndTimePoint)
+                continue;
+
+            result.ResponseTimes.Record(ToNanoseconds(cutoffTimePoint - dueTimePoint));
+            ++result.UnsentCount;
+        }
+    }
+} // namespace
+
+void LoadResult::Add(const LoadResult& other)
+{
+    ResponseTimes.Add(other.ResponseTimes);
+    ServiceTimes.Add(other.ServiceTimes);
+
+    OkCount += other.OkCount;
+    HitsCount += other.HitsCount;
+    OverloadedCount += other.OverloadedCount;
+    TimedOutCount += other.TimedOutCount;
+    FailedCount += other.FailedCount;
+    ErrorsCount += other.ErrorsCount;
+    UnsentCount += other.UnsentCount;
+    ReceivedBytes += other.ReceivedBytes;
+}
+
+LoadResult RunLoad(const sockaddr_in& serverAddress, const QuerySet& querySet, const LoadConfig& config)
+{
+    if (config.ConnectionsCount == 0u)
+        throw std::invalid_argument("At least one connection is required");
+
+    if (config.Mode == LoadMode::OpenLoop && config.RequestsPerSecond == 0u)
+        throw std::invalid_argument("The open loop needs a request rate");
+
+    // Step 1
+    // Lay out the run, the threads need a moment to start before the first request is due
+    Schedule schedule{};
+    schedule.StartTimePoint = Clock::now() + std::chrono::milliseconds(100);
+    schedule.WarmupEndTimePoint = schedule.StartTimePoint + std::chrono::seconds(config.WarmupS);
+    schedule.EndTimePoint = schedule.WarmupEndTimePoint + std::chrono::seconds(config.DurationS);
+    schedule.CutoffTimePoint = schedule.EndTimePoint + std::chrono::seconds(std::max(config.DurationS, 10u));
+
+    // Every connection sends at an equal share of the rate, the connections are staggered to spread the requests evenly
+    const std::chrono::nanoseconds requestInterval{ 1'000'000'000ll / std::max(config.RequestsPerSecond, 1u) };
+    const std::chrono::nanoseconds connectionInterval{ requestInterval * config.ConnectionsCount };
+
+    // Step 2
+    // Run every connection on a thread of its own for the whole run, a pool could run two of them one after the other
+    std::vector<LoadResult>  results(config.ConnectionsCount);
+    std::vector<std::thread> threads{};
+    threads.reserve(config.ConnectionsCount);
+
+    for (uint32_t connectionIndex{ 0u }; connectionIndex < config.ConnectionsCount; ++connectionIndex)
+    {
+        threads.emplace_back([&, connectionIndex]() {
+            SearchClient client{ serverAddress, config.Protocol, config.Limit, static_cast<int>(config.TimeoutMS) };
+
+            // Connections start at different places of the query set, so that they do not send the same queries in lockstep
+            const size_t queryIndex{ connectionIndex * (querySet.GetQueriesCount() / results.size()) };
+
+            if (config.Mode == LoadMode::ClosedLoop)
+            {
+                RunClosedLoop(client, querySet, queryIndex, schedule, results[connectionIndex]);
+            }
+            else
+            {
+                Schedule connectionSchedule{ schedule };
+                connectionSchedule.StartTimePoint += requestInterval * connectionIndex;
+
+                RunOpenLoop(client, querySet, queryIndex, connectionSchedule, connectionInterval, results[connectionIndex]);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Step 3
+    // Merge the results of the connections
+    LoadResult result{};
+    for (const LoadResult& connectionResult : results)
+        result.Add(connectionResult);
+
+    result.MeasuredDuration = schedule.EndTimePoint - schedule.WarmupEndTimePoint;
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include "LatencyHistogram.h"
+#include "QuerySet.h"
+#include "SearchClient.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+enum class LoadMode : uint8_t
+{
+    // Every connection sends its next request as soon as it has received the previous response.
+    // Measures the maximum throughput, but a stalled server also stalls the load, which hides its latency spikes.
+    ClosedLoop,
+
+    // Requests are sent at a constant rate whatever the server does. Latency is counted from the time a request
+    // was due, not from the time it was sent, so that a stall also counts against the requests it delayed.
+    OpenLoop,
+};
+
+struct LoadConfig
+{
+    LoadMode       Mode{ LoadMode::ClosedLoop };
+    SearchProtocol Protocol{ SearchProtocol::Binary };
+
+    uint32_t ConnectionsCount{ 16u };
+    uint32_t RequestsPerSecond{ 1000u }; // Of all the connections together, open loop only
+    uint32_t DurationS{ 30u };
+    uint32_t WarmupS{ 5u }; // Requests due during the warm-up are sent but not counted
+    uint32_t Limit{ 10u };  // Page size of a search
+    uint32_t TimeoutMS{ 10000u };
+};
+
+struct LoadResult
+{
+    // Open loop: from the time a request was due. Closed loop: from the time it was sent
+    LatencyHistogram ResponseTimes{};
+
+    // From the time a request was sent, only differs from ResponseTimes in the open loop
+    LatencyHistogram ServiceTimes{};
+
+    uint64_t OkCount{ 0u };
+    uint64_t HitsCount{ 0u }; // Successful searches that found at least one file
+    uint64_t OverloadedCount{ 0u };
+    uint64_t TimedOutCount{ 0u };
+    uint64_t FailedCount{ 0u };
+    uint64_t ErrorsCount{ 0u }; // Connection errors and client-side timeouts
+    uint64_t UnsentCount{ 0u }; // Open loop: requests still due when the run was cut off, the server fell too far behind
+    uint64_t ReceivedBytes{ 0u };
+
+    std::chrono::steady_clock::duration MeasuredDuration{};
+
+    void Add(const LoadResult& other);
+
+    uint64_t GetRequestsCount() const noexcept { return OkCount + OverloadedCount + TimedOutCount + FailedCount; }
+};
+
+// Runs ConnectionsCount connections, each on its own thread, against the server for WarmupS + DurationS seconds
+LoadResult RunLoad(const sockaddr_in& serverAddress, const QuerySet& querySet, const LoadConfig& config);
\ No newline at end of file
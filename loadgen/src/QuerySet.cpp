@@ -0,0 +1,144 @@
+#include "QuerySet.h"
+
+#include "Analyzer.h"
+#include "FileSystem.h"
+#include "IndexFile.h"
+#include "ZipfDistribution.h"
+
+#include <random>
+
+namespace Utils
+{
+    namespace
+    {
+        using TermFrequency = std::pair<std::string, size_t>;
+
+        std::vector<std::string> SortByFrequency(std::vector<TermFrequency> termFrequencies);
+        std::string              MakeMissingWord(std::mt19937_64& generator, const std::unordered_set<std::string_view>& vocabulary);
+    } // namespace
+} // namespace Utils
+
+QuerySet::QuerySet(std::vector<std::string> vocabulary, const QuerySetConfig& config)
+    : m_Vocabulary{ std::move(vocabulary) }
+{
+    if (m_Vocabulary.empty())
+        throw std::runtime_error("The vocabulary is empty");
+
+    if (config.QueriesCount == 0u || config.MaxWordsCount == 0u)
+        throw std::runtime_error("A query set needs at least one query of one word");
+
+    const std::unordered_set<std::string_view> vocabularyWords{ m_Vocabulary.begin(), m_Vocabulary.end() };
+
+    const ZipfDistribution                  wordDistribution{ m_Vocabulary.size(), config.ZipfExponent };
+    std::mt19937_64                         generator{ config.Seed };
+    std::uniform_int_distribution<uint32_t> wordsCountDistribution{ 1u, config.MaxWordsCount };
+    std::bernoulli_distribution             missDistribution{ std::clamp(config.MissRatio, 0.0, 1.0) };
+
+    m_Queries.reserve(config.QueriesCount);
+
+    for (size_t i{ 0u }; i < config.QueriesCount; ++i)
+    {
+        const uint32_t wordsCount{ wordsCountDistribution(generator) };
+
+        // A miss query replaces one of its words, so that its other words still cost posting list lookups
+        const bool     isMiss{ missDistribution(generator) };
+        const uint32_t missingWordIndex{ std::uniform_int_distribution<uint32_t>{ 0u, wordsCount - 1u }(generator) };
+
+        std::string query{};
+        for (uint32_t j{ 0u }; j < wordsCount; ++j)
+        {
+            if (j > 0u)
+                query.push_back(' ');
+
+            if (isMiss && j == missingWordIndex)
+                query.append(Utils::MakeMissingWord(generator, vocabularyWords));
+            else
+                query.append(m_Vocabulary[wordDistribution(generator)]);
+        }
+
+        m_Queries.push_back(std::move(query));
+    }
+}
+
+std::vector<std::string> QuerySet::LoadVocabularyFromIndex(const std::string& indexPath)
+{
+    IndexFile::Reader reader{ indexPath };
+
+    // Step 1
+    // Skip the files section, the terms follow it
+    FileSystem::FileID fileID{ 0u };
+    std::string        path{};
+    while (reader.ReadFile(fileID, path))
+        ;
+
+    // Step 2
+    // The document frequency of a term is the length of its posting list
+    std::vector<Utils::TermFrequency> termFrequencies{};
+    termFrequencies.reserve(reader.GetTermsCount());
+
+    std::string                     term{};
+    std::vector<FileSystem::FileID> fileIDs{};
+    while (reader.ReadTerm(term, fileIDs))
+        termFrequencies.emplace_back(term, fileIDs.size());
+
+    return Utils::SortByFrequency(std::move(termFrequencies));
+}
+
+std::vector<std::string> QuerySet::LoadVocabularyFromDirectory(const std::string& directory)
+{
+    std::unordered_map<std::string, size_t> documentFrequencies{};
+    std::string                             content{};
+
+    for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator{ directory })
+    {
+        if (!directoryEntry.is_regular_file() || !FileSystem::ReadFile(directoryEntry.path().string(), content))
+            continue;
+
+        // The server analyzes the queries itself, the standard analyzer keeps the words whole rather than stemmed
+        std::pmr::vector<std::pmr::string> terms{ StandardAnalyzer::Tokenize(content, std::pmr::get_default_resource()) };
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+        for (const auto& term : terms)
+            ++documentFrequencies[std::string{ term }];
+    }
+
+    return Utils::SortByFrequency({ std::make_move_iterator(documentFrequencies.begin()), std::make_move_iterator(documentFrequencies.end()) });
+}
+
+namespace Utils
+{
+    namespace
+    {
+        std::vector<std::string> SortByFrequency(std::vector<TermFrequency> termFrequencies)
+        {
+            // Ties are broken by the term, so that the ranks do not depend on the order the terms were read in
+            std::sort(termFrequencies.begin(), termFrequencies.end(), [](const TermFrequency& lhs, const TermFrequency& rhs) {
+                return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+            });
+
+            std::vector<std::string> vocabulary{};
+            vocabulary.reserve(termFrequencies.size());
+
+            for (auto& [term, frequency] : termFrequencies)
+                vocabulary.push_back(std::move(term));
+
+            return vocabulary;
+        }
+
+        std::string MakeMissingWord(std::mt19937_64& generator, const std::unordered_set<std::string_view>& vocabulary)
+        {
+            // Letters only, so that the server normalizes the word into itself instead of dropping it
+            std::uniform_int_distribution<int> letterDistribution{ 'a', 'z' };
+
+            std::string word(12u, '\0');
+            do
+            {
+                for (char& c : word)
+                    c = static_cast<char>(letterDistribution(generator));
+            } while (vocabulary.contains(word));
+
+            return word;
+        }
+    } // namespace
+} // namespace Utils
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct QuerySetConfig
+{
+    size_t   QueriesCount{ 100000u };
+    uint32_t MaxWordsCount{ 3u };     // Every query has 1 to MaxWordsCount words
+    double   ZipfExponent{ 1.0 };     // Of the word frequencies, the most frequent word has rank 0
+    double   MissRatio{ 0.1 };        // Fraction of the queries with a word that is not in the vocabulary
+    uint64_t Seed{ 42u };
+};
+
+// Queries sampled from the vocabulary of the indexed files, so that the load hits the index the way users do:
+// a few frequent words with long posting lists in most queries and a long tail of rare ones
+class QuerySet
+{
+public:
+    // The words of the vocabulary ordered from the most to the least frequent
+    QuerySet(std::vector<std::string> vocabulary, const QuerySetConfig& config);
+
+public:
+    const std::string& GetQuery(size_t index) const noexcept { return m_Queries[index % m_Queries.size()]; }
+    size_t             GetQueriesCount() const noexcept { return m_Queries.size(); }
+    size_t             GetVocabularySize() const noexcept { return m_Vocabulary.size(); }
+
+    // Terms of a prebuilt index (see the indexer) by document frequency
+    static std::vector<std::string> LoadVocabularyFromIndex(const std::string& indexPath);
+
+    // Terms of the files of a directory by document frequency, tokenized the way the server does it
+    static std::vector<std::string> LoadVocabularyFromDirectory(const std::string& directory);
+
+private:
+    std::vector<std::string> m_Vocabulary{};
+    std::vector<std::string> m_Queries{};
+};
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include "SearchClient.h"
+
+#include "HTTP.h"
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr uint32_t BINARY_ERROR_MARKER{ 0xFFFFFFFFu };
+        constexpr uint32_t BINARY_ERROR_CODE_OVERLOADED{ 1u };
+        constexpr uint32_t BINARY_ERROR_CODE_TIMED_OUT{ 2u };
+        constexpr uint32_t BINARY_FRAME_TYPE_SEARCH_PAGE{ 1u };
+
+        void     AppendUInt32NetworkOrder(std::string& destination, uint32_t value);
+        uint32_t ReadUInt32NetworkOrder(const char* source);
+        void     AppendUrlEncoded(std::string& destination, std::string_view value);
+    } // namespace
+} // namespace Utils
+
+SearchClient::SearchClient(const sockaddr_in& serverAddress, SearchProtocol protocol, uint32_t limit, int timeoutMS)
+    : m_ServerAddress{ serverAddress }
+    , m_Protocol{ protocol }
+    , m_Limit{ limit }
+    , m_TimeoutMS{ timeoutMS }
+{
+    char addressString[INET_ADDRSTRLEN]{};
+    inet_ntop(AF_INET, &m_ServerAddress.sin_addr, addressString, sizeof(addressString));
+
+    m_Host = std::format("{0}:{1}", addressString, ntohs(m_ServerAddress.sin_port));
+}
+
+SearchClient::~SearchClient()
+{
+    Disconnect();
+}
+
+SearchResponse SearchClient::Search(std::string_view query)
+{
+    if (m_Socket == INVALID_SOCKET)
+        Connect();
+
+    return m_Protocol == SearchProtocol::HTTP ? SearchHTTP(query) : SearchBinary(query);
+}
+
+void SearchClient::Disconnect()
+{
+    if (m_Socket == INVALID_SOCKET)
+        return;
+
+    closesocket(m_Socket);
+    m_Socket = INVALID_SOCKET;
+    m_ReceiveBuffer.clear();
+}
+
+void SearchClient::Connect()
+{
+    m_Socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (m_Socket == INVALID_SOCKET)
+        throw std::runtime_error(std::format("Socket creation failed: {0}", WSAGetLastError()).c_str());
+
+    if (connect(m_Socket, reinterpret_cast<const sockaddr*>(&m_ServerAddress), sizeof(m_ServerAddress)) == SOCKET_ERROR)
+    {
+        const int error{ WSAGetLastError() };
+        Disconnect();
+
+        throw std::runtime_error(std::format("Connect failed: {0}", error).c_str());
+    }
+
+    // Requests are small and latency-bound, they must not wait for the acknowledgement of the previous one
+    const int noDelay{ 1 };
+    setsockopt(m_Socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+}
+
+SearchResponse SearchClient::SearchHTTP(std::string_view query)
+{
+    // Step 1
+    // Send the request, the server answers it and closes the connection
+    m_SendBuffer.assign("GET /search?q=");
+    Utils::AppendUrlEncoded(m_SendBuffer, query);
+    m_SendBuffer.append(std::format("&limit={0} HTTP/1.1\r\nHost: {1}\r\n\r\n", m_Limit, m_Host));
+
+    SendAll(m_SendBuffer);
+
+    // Step 2
+    // Receive the headers
+    size_t headersEndPos{ std::string::npos };
+    while ((headersEndPos = m_ReceiveBuffer.find("\r\n\r\n")) == std::string::npos)
+    {
+        if (!ReceiveSome())
+            throw std::runtime_error("The server closed the connection before sending the response headers");
+    }
+
+    const std::string_view headers{ std::string_view{ m_ReceiveBuffer }.substr(0u, headersEndPos) };
+
+    // Step 3
+    // Receive the body, the server always sends its length with the page of results
+    const size_t bodyLength{ HTTP::GetContentLength(headers) };
+    while (m_ReceiveBuffer.size() < headersEndPos + 4u + bodyLength)
+    {
+        if (!ReceiveSome())
+            throw std::runtime_error("The server closed the connection before sending the response body");
+    }
+
+    SearchResponse response{ .ReceivedBytes = headersEndPos + 4u + bodyLength };
+
+    // Step 4
+    // "HTTP/1.1 200 OK", the status code follows the version
+    const std::string_view statusCode{ headers.substr(std::min(headers.find(' ') + 1u, headers.size()), 3u) };
+
+    if (statusCode == "200")
+    {
+        response.Status = SearchStatus::Ok;
+
+        // { "total": N, ...
+        const std::string_view body{ std::string_view{ m_ReceiveBuffer }.substr(headersEndPos + 4u, bodyLength) };
+        const size_t           totalPos{ body.find(':') };
+
+        size_t totalHitsCount{ 0u };
+        if (totalPos != std::string_view::npos)
+            std::from_chars(body.data() + body.find_first_not_of(' ', totalPos + 1u), body.data() + body.size(), totalHitsCount);
+
+        response.TotalHitsCount = static_cast<uint32_t>(totalHitsCount);
+    }
+    else if (statusCode == "503")
+    {
+        response.Status = SearchStatus::Overloaded;
+    }
+
+    Disconnect();
+    return response;
+}
+
+SearchResponse SearchClient::SearchBinary(std::string_view query)
+{
+    // Step 1
+    // Send the frame header (frame type and payload length), the offset, the limit and the query
+    m_SendBuffer.clear();
+    Utils::AppendUInt32NetworkOrder(m_SendBuffer, (Utils::BINARY_FRAME_TYPE_SEARCH_PAGE << 24u) | static_cast<uint32_t>(2u * sizeof(uint32_t) + query.size()));
+    Utils::AppendUInt32NetworkOrder(m_SendBuffer, 0u);
+    Utils::AppendUInt32NetworkOrder(m_SendBuffer, m_Limit);
+    m_SendBuffer.append(query);
+
+    SendAll(m_SendBuffer);
+
+    // Step 2
+    // Receive the total number of the hits or the error marker
+    char header[2u * sizeof(uint32_t)]{};
+    ReceiveExactly(header, sizeof(header));
+
+    SearchResponse response{ .ReceivedBytes = sizeof(header) };
+
+    if (Utils::ReadUInt32NetworkOrder(header) == Utils::BINARY_ERROR_MARKER)
+    {
+        switch (Utils::ReadUInt32NetworkOrder(header + sizeof(uint32_t)))
+        {
+            case Utils::BINARY_ERROR_CODE_OVERLOADED:
+                response.Status = SearchStatus::Overloaded;
+                break;
+            case Utils::BINARY_ERROR_CODE_TIMED_OUT:
+                response.Status = SearchStatus::TimedOut;
+                break;
+            default:
+                break;
+        }
+
+        return response;
+    }
+
+    response.Status = SearchStatus::Ok;
+    response.TotalHitsCount = Utils::ReadUInt32NetworkOrder(header);
+
+    // Step 3
+    // Receive the page of the paths, each prefixed with its length
+    const uint32_t pathsCount{ Utils::ReadUInt32NetworkOrder(header + sizeof(uint32_t)) };
+    std::string    path{};
+
+    for (uint32_t i{ 0u }; i < pathsCount; ++i)
+    {
+        char pathLength[sizeof(uint32_t)]{};
+        ReceiveExactly(pathLength, sizeof(pathLength));
+
+        path.resize(Utils::ReadUInt32NetworkOrder(pathLength));
+        ReceiveExactly(path.data(), path.size());
+
+        response.ReceivedBytes += sizeof(pathLength) + path.size();
+    }
+
+    return response;
+}
+
+void SearchClient::SendAll(std::string_view data)
+{
+    while (!data.empty())
+    {
+        const int bytesSent{ send(m_Socket, data.data(), static_cast<int>(data.size()), 0) };
+        if (bytesSent == SOCKET_ERROR)
+            throw std::runtime_error(std::format("Send failed: {0}", WSAGetLastError()).c_str());
+
+        data.remove_prefix(static_cast<size_t>(bytesSent));
+    }
+}
+
+void SearchClient::ReceiveExactly(char* buffer, size_t length)
+{
+    while (m_ReceiveBuffer.size() < length)
+    {
+        if (!ReceiveSome())
+            throw std::runtime_error("The server closed the connection in the middle of a response");
+    }
+
+    std::memcpy(buffer, m_ReceiveBuffer.data(), length);
+    m_ReceiveBuffer.erase(0u, length);
+}
+
+bool SearchClient::ReceiveSome()
+{
+    WSAPOLLFD pollDescriptor{ .fd = m_Socket, .events = POLLRDNORM, .revents = 0 };
+
+    const int readyDescriptorsCount{ WSAPoll(&pollDescriptor, 1u, m_TimeoutMS) };
+    if (readyDescriptorsCount == SOCKET_ERROR)
+        throw std::runtime_error(std::format("Poll failed: {0}", WSAGetLastError()).c_str());
+
+    if (readyDescriptorsCount == 0)
+        throw std::runtime_error("The response timed out");
+
+    char buffer[16u * 1024u];
+
+    const int bytesReceived{ recv(m_Socket, buffer, static_cast<int>(sizeof(buffer)), 0) };
+    if (bytesReceived == SOCKET_ERROR)
+        throw std::runtime_error(std::format("Recv failed: {0}", WSAGetLastError()).c_str());
+
+    m_ReceiveBuffer.append(buffer, static_cast<size_t>(bytesReceived));
+
+    return bytesReceived > 0;
+}
+
+namespace Utils
+{
+    namespace
+    {
+        void AppendUInt32NetworkOrder(std::string& destination, uint32_t value)
+        {
+            const uint32_t valueNetworkOrder{ htonl(value) };
+            destination.append(reinterpret_cast<const char*>(&valueNetworkOrder), sizeof(valueNetworkOrder));
+        }
+
+        uint32_t ReadUInt32NetworkOrder(const char* source)
+        {
+            uint32_t valueNetworkOrder{ 0u };
+            std::memcpy(&valueNetworkOrder, source, sizeof(valueNetworkOrder));
+
+            return ntohl(valueNetworkOrder);
+        }
+
+        void AppendUrlEncoded(std::string& destination, std::string_view value)
+        {
+            constexpr std::string_view hexDigits{ "0123456789ABCDEF" };
+
+            for (const char c : value)
+            {
+                if (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.' || c == '~')
+                {
+                    destination.push_back(c);
+                    continue;
+                }
+
+                destination.push_back('%');
+                destination.push_back(hexDigits[static_cast<unsigned char>(c) >> 4u]);
+                destination.push_back(hexDigits[static_cast<unsigned char>(c) & 0x0Fu]);
+            }
+        }
+    } // namespace
+} // namespace Utils
\ No newline at end of file
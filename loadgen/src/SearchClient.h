@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+enum class SearchProtocol : uint8_t
+{
+    HTTP,   // GET /search, the server closes the connection after every response
+    Binary, // BINARY_FRAME_TYPE_SEARCH_PAGE frames over a persistent connection
+};
+
+enum class SearchStatus : uint8_t
+{
+    Ok,
+    Overloaded, // 503 or BINARY_ERROR_CODE_OVERLOADED, the request has been shed
+    TimedOut,   // BINARY_ERROR_CODE_TIMED_OUT, the time budget has been spent in the server queue
+    Failed,     // Any other HTTP status or binary error
+};
+
+struct SearchResponse
+{
+    SearchStatus Status{ SearchStatus::Failed };
+    uint32_t     TotalHitsCount{ 0u };
+    size_t       ReceivedBytes{ 0u };
+};
+
+// A blocking client of one connection, it reconnects whenever the previous connection has been closed.
+// Throws on connection errors and on timeouts.
+class SearchClient
+{
+public:
+    SearchClient(const sockaddr_in& serverAddress, SearchProtocol protocol, uint32_t limit, int timeoutMS);
+    ~SearchClient();
+
+    SearchClient(const SearchClient&) = delete;
+    SearchClient& operator=(const SearchClient&) = delete;
+
+public:
+    SearchResponse Search(std::string_view query);
+
+    // Drops the connection, e.g. after an error left it in an unknown state
+    void Disconnect();
+
+private:
+    void Connect();
+
+    SearchResponse SearchHTTP(std::string_view query);
+    SearchResponse SearchBinary(std::string_view query);
+
+    void SendAll(std::string_view data);
+    void ReceiveExactly(char* buffer, size_t length);
+    bool ReceiveSome(); // Appends to m_ReceiveBuffer, false once the server has closed the connection
+
+private:
+    sockaddr_in    m_ServerAddress{};
+    SearchProtocol m_Protocol{ SearchProtocol::Binary };
+    uint32_t       m_Limit{ 0u };
+    int            m_TimeoutMS{ -1 };
+
+    SOCKET      m_Socket{ INVALID_SOCKET };
+    std::string m_Host{};
+    std::string m_SendBuffer{};
+    std::string m_ReceiveBuffer{};
+};
\ No newline at end of file
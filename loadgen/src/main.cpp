@@ -0,0 +1,218 @@
+#include "LoadGenerator.h"
+#include "Log.h"
+#include "QuerySet.h"
+
+#include <exception>
+#include <iostream>
+
+namespace
+{
+    struct Options
+    {
+        LoadConfig     Load{};
+        QuerySetConfig Queries{};
+
+        // Source of the vocabulary, one of them is required
+        std::string IndexPath{};
+        std::string FilesDirectory{};
+
+        std::string HistogramPath{}; // Percentile distribution of the response times, none if empty
+    };
+
+    // Parses the optional "--option value" pairs that follow the positional arguments
+    Options ParseOptions(int argc, const char* argv[], int firstOptionIndex)
+    {
+        Options options{};
+
+        const std::unordered_map<std::string_view, uint32_t*> uint32Options{
+            { "--connections", &options.Load.ConnectionsCount },
+            { "--rate", &options.Load.RequestsPerSecond },
+            { "--duration", &options.Load.DurationS },
+            { "--warmup", &options.Load.WarmupS },
+            { "--limit", &options.Load.Limit },
+            { "--timeout-ms", &options.Load.TimeoutMS },
+            { "--max-words", &options.Queries.MaxWordsCount },
+        };
+
+        const std::unordered_map<std::string_view, double*> doubleOptions{
+            { "--miss-ratio", &options.Queries.MissRatio },
+            { "--zipf-exponent", &options.Queries.ZipfExponent },
+        };
+
+        const std::unordered_map<std::string_view, std::string*> stringOptions{
+            { "--index", &options.IndexPath },
+            { "--files", &options.FilesDirectory },
+            { "--histogram", &options.HistogramPath },
+        };
+
+        for (int i{ firstOptionIndex }; i < argc; i += 2)
+        {
+            const std::string_view option{ argv[i] };
+
+            if (i + 1 >= argc)
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+
+            const std::string_view value{ argv[i + 1] };
+
+            if (const auto it{ uint32Options.find(option) }; it != uint32Options.end())
+                *it->second = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            else if (const auto it{ doubleOptions.find(option) }; it != doubleOptions.end())
+                *it->second = std::stod(argv[i + 1]);
+            else if (const auto it{ stringOptions.find(option) }; it != stringOptions.end())
+                *it->second = value;
+            else if (option == "--mode" && (value == "closed" || value == "open"))
+                options.Load.Mode = value == "open" ? LoadMode::OpenLoop : LoadMode::ClosedLoop;
+            else if (option == "--protocol" && (value == "binary" || value == "http"))
+                options.Load.Protocol = value == "http" ? SearchProtocol::HTTP : SearchProtocol::Binary;
+            else
+                throw std::invalid_argument(std::format("Invalid option: {0} {1}", option, value));
+        }
+
+        if (options.IndexPath.empty() == options.FilesDirectory.empty())
+            throw std::invalid_argument("Either --index or --files is required");
+
+        if (options.Load.ConnectionsCount == 0u)
+            throw std::invalid_argument("At least one connection is required");
+
+        if (options.Load.Limit == 0u || options.Load.Limit > 1000u)
+            throw std::invalid_argument("The limit must be within [1, 1000]");
+
+        return options;
+    }
+
+    void PrintLatencies(std::string_view name, const LatencyHistogram& histogram)
+    {
+        const auto toMilliseconds{ [](uint64_t valueNS) { return static_cast<double>(valueNS) / 1e6; } };
+
+        std::cout << std::format("{0:<16} {1:>10.3f} {2:>10.3f} {3:>10.3f} {4:>10.3f} {5:>10.3f} {6:>10.3f} {7:>10.3f}",
+                         name,
+                         toMilliseconds(histogram.GetValueAtPercentile(50.0)),
+                         toMilliseconds(histogram.GetValueAtPercentile(90.0)),
+                         toMilliseconds(histogram.GetValueAtPercentile(99.0)),
+                         toMilliseconds(histogram.GetValueAtPercentile(99.9)),
+                         toMilliseconds(histogram.GetValueAtPercentile(99.99)),
+                         toMilliseconds(histogram.GetMax()),
+                         histogram.GetMean() / 1e6)
+                  << std::endl;
+    }
+
+    void PrintResult(const LoadResult& result, const Options& options)
+    {
+        const double seconds{ std::chrono::duration<double>(result.MeasuredDuration).count() };
+        const double requestsCount{ static_cast<double>(result.GetRequestsCount()) };
+
+        if (options.Load.Mode == LoadMode::OpenLoop)
+            std::cout << std::format("Open loop at {0} req/s", options.Load.RequestsPerSecond);
+        else
+            std::cout << "Closed loop";
+
+        std::cout << std::format(", {0} connections, {1} protocol, {2} s after a {3} s warm-up\n",
+                         options.Load.ConnectionsCount,
+                         options.Load.Protocol == SearchProtocol::HTTP ? "HTTP" : "binary",
+                         options.Load.DurationS,
+                         options.Load.WarmupS);
+
+        std::cout << std::format("Requests: {0} ({1:.1f} req/s), ok {2}, overloaded {3}, timed out {4}, failed {5}, connection errors {6}, unsent {7}\n",
+            result.GetRequestsCount(),
+            seconds > 0.0 ? requestsCount / seconds : 0.0,
+            result.OkCount,
+            result.OverloadedCount,
+            result.TimedOutCount,
+            result.FailedCount,
+            result.ErrorsCount,
+            result.UnsentCount);
+
+        std::cout << std::format("Hits: {0:.1f}% of the successful searches, received {1:.1f} MB\n\n",
+            result.OkCount > 0u ? 100.0 * static_cast<double>(result.HitsCount) / static_cast<double>(result.OkCount) : 0.0,
+            static_cast<double>(result.ReceivedBytes) / (1024.0 * 1024.0));
+
+        std::cout << std::format("{0:<16} {1:>10} {2:>10} {3:>10} {4:>10} {5:>10} {6:>10} {7:>10}", "Latency (ms)", "p50", "p90", "p99", "p99.9", "p99.99", "max", "mean") << std::endl;
+
+        PrintLatencies("response time", result.ResponseTimes);
+
+        // In the closed loop both are the same, a request is due when it is sent
+        if (options.Load.Mode == LoadMode::OpenLoop)
+            PrintLatencies("service time", result.ServiceTimes);
+    }
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    constexpr std::string_view usage{ "Usage: [loadgen] <Server IP> <Port> (--index FILE | --files DIR) [--protocol binary|http] [--mode closed|open]\n"
+                                      "                 [--connections N] [--rate N] [--duration S] [--warmup S] [--limit N] [--timeout-ms N]\n"
+                                      "                 [--max-words N] [--miss-ratio F] [--zipf-exponent F] [--histogram FILE]" };
+
+    if (argc < 3)
+    {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    sockaddr_in serverAddress{};
+    Options     options{};
+
+    try
+    {
+        serverAddress.sin_family = AF_INET;
+        serverAddress.sin_port = htons(static_cast<uint16_t>(std::stoi(argv[2])));
+
+        if (inet_pton(AF_INET, argv[1], &serverAddress.sin_addr) <= 0)
+            throw std::invalid_argument("Invalid server IP address format");
+
+        options = ParseOptions(argc, argv, 3);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n"
+                  << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Log::Init("LOADGEN");
+
+    WSADATA wsaData{};
+    if (const int result{ WSAStartup(MAKEWORD(2, 2), &wsaData) }; result != 0)
+    {
+        LOG_CRITICAL_TAG("LOADGEN", "WSAStartup failed with error: {0}", result);
+        Log::Shutdown();
+        return EXIT_FAILURE;
+    }
+
+    int exitCode{ EXIT_SUCCESS };
+
+    try
+    {
+        // Step 1
+        // Build the query set from the vocabulary of the indexed files
+        std::vector<std::string> vocabulary{ options.IndexPath.empty() ? QuerySet::LoadVocabularyFromDirectory(options.FilesDirectory) : QuerySet::LoadVocabularyFromIndex(options.IndexPath) };
+
+        const QuerySet querySet{ std::move(vocabulary), options.Queries };
+        LOG_INFO_TAG("LOADGEN", "Generated {0} queries from a vocabulary of {1} terms", querySet.GetQueriesCount(), querySet.GetVocabularySize());
+
+        // Step 2
+        // Run the load
+        const LoadResult result{ RunLoad(serverAddress, querySet, options.Load) };
+
+        PrintResult(result, options);
+
+        // Step 3
+        // Export the percentile distribution, in milliseconds
+        if (!options.HistogramPath.empty())
+        {
+            std::ofstream histogramStream{ options.HistogramPath, std::ios::out | std::ios::trunc };
+            if (!histogramStream.is_open())
+                throw std::runtime_error(std::format("Failed to create {0}", options.HistogramPath).c_str());
+
+            histogramStream << result.ResponseTimes.FormatPercentileDistribution(1e6);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG_CRITICAL_TAG("LOADGEN", "Exception: {0}", e.what());
+        exitCode = EXIT_FAILURE;
+    }
+
+    WSACleanup();
+    Log::Shutdown();
+    return exitCode;
+}
\ No newline at end of file
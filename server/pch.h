@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <charconv>
 #include <chrono>
 #include <cstdint>
 #include <execution>
@@ -9,6 +11,8 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <ranges>
 #include <sstream>
 #include <thread>
@@ -0,0 +1,543 @@
+#include "Analyzer.h"
+
+#include "Unicode.h"
+
+#include <emmintrin.h>
+
+namespace Utils
+{
+    namespace
+    {
+        // The text is scanned a SSE2 register at a time, SSE2 is part of every x64 CPU
+        constexpr size_t BLOCK_SIZE{ sizeof(__m128i) };
+
+        // The lowercase letter of every ASCII byte, 0 for the bytes that are dropped
+        constexpr std::array<char, 128u> ASCII_LETTERS{ [] {
+            std::array<char, 128u> letters{};
+            for (char c{ 'a' }; c <= 'z'; ++c)
+            {
+                letters[c] = c;
+                letters[c - 'a' + 'A'] = c;
+            }
+
+            return letters;
+        }() };
+
+        struct BlockMasks
+        {
+            uint32_t NonASCII{ 0u };   // Bit i is set if byte i of the block is beyond ASCII
+            uint32_t Whitespace{ 0u }; // Bit i is set if byte i of the block is ASCII whitespace, valid if NonASCII is 0
+        };
+
+        BlockMasks GetBlockMasks(const char* block) noexcept
+        {
+            const __m128i bytes{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(block)) };
+
+            // ' ' and '\t' to '\r', the whitespace of std::isspace() in the "C" locale
+            const __m128i isSpace{ _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')) };
+            const __m128i isControlSpace{ _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('\r' + 1))) };
+
+            return { .NonASCII = static_cast<uint32_t>(_mm_movemask_epi8(bytes)), .Whitespace = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(isSpace, isControlSpace))) };
+        }
+
+        bool IsASCIIWhitespace(unsigned char c) noexcept { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+        // The length of the whitespace at the position, 0 if a token goes on there. skipLength is set to the length of the
+        // character at the position
+        size_t GetWhitespaceLength(std::string_view content, size_t position, size_t& skipLength) noexcept
+        {
+            const unsigned char c{ static_cast<unsigned char>(content[position]) };
+            if (c < 0x80u)
+            {
+                skipLength = 1u;
+                return IsASCIIWhitespace(c) ? 1u : 0u;
+            }
+
+            char32_t codePoint{ 0u };
+            skipLength = Unicode::Decode(content.substr(position), codePoint);
+
+            return Unicode::IsWhitespace(codePoint) ? skipLength : 0u;
+        }
+
+        // The stemmer of the reference implementation by M. F. Porter, including its two departures from the paper
+        // ("bli" -> "ble" and "logi" -> "log" in step 2). The word is rewritten in place, none of the steps makes it longer
+        // than it was
+        class PorterStemmer
+        {
+        public:
+            PorterStemmer(char* word, size_t length) noexcept
+                : m_Word{ word }
+                , m_End{ static_cast<ptrdiff_t>(length) - 1 }
+            {
+            }
+
+        public:
+            // Returns the length of the stem
+            size_t Stem() noexcept
+            {
+                // Words of one or two letters are left alone
+                if (m_End <= 1)
+                    return static_cast<size_t>(m_End + 1);
+
+                Step1ab();
+                if (m_End > 0)
+                {
+                    Step1c();
+                    Step2();
+                    Step3();
+                    Step4();
+                    Step5();
+                }
+
+                return static_cast<size_t>(m_End + 1);
+            }
+
+        private:
+            bool IsConsonant(ptrdiff_t i) const noexcept
+            {
+                switch (m_Word[i])
+                {
+                    case 'a':
+                    case 'e':
+                    case 'i':
+                    case 'o':
+                    case 'u':
+                        return false;
+                    case 'y':
+                        return i == 0 || !IsConsonant(i - 1);
+                    default:
+                        return true;
+                }
+            }
+
+            // The number of the vowel-consonant sequences of the stem [0, m_StemEnd]
+            size_t GetMeasure() const noexcept
+            {
+                size_t    measure{ 0u };
+                ptrdiff_t i{ 0 };
+
+                while (i <= m_StemEnd && IsConsonant(i))
+                    ++i;
+
+                while (true)
+                {
+                    while (i <= m_StemEnd && !IsConsonant(i))
+                        ++i;
+
+                    if (i > m_StemEnd)
+                        return measure;
+
+                    while (i <= m_StemEnd && IsConsonant(i))
+                        ++i;
+
+                    ++measure;
+                }
+            }
+
+            bool HasVowelInStem() const noexcept
+            {
+                for (ptrdiff_t i{ 0 }; i <= m_StemEnd; ++i)
+                {
+                    if (!IsConsonant(i))
+                        return true;
+                }
+
+                return false;
+            }
+
+            bool EndsWithDoubleConsonant(ptrdiff_t i) const noexcept { return i >= 1 && m_Word[i] == m_Word[i - 1] && IsConsonant(i); }
+
+            // Consonant, vowel, consonant ending at i, the last one not w, x or y, e.g. "hop" but not "snow"
+            bool EndsWithCVC(ptrdiff_t i) const noexcept
+            {
+                if (i < 2 || !IsConsonant(i) || IsConsonant(i - 1) || !IsConsonant(i - 2))
+                    return false;
+
+                return m_Word[i] != 'w' && m_Word[i] != 'x' && m_Word[i] != 'y';
+            }
+
+            // Sets the stem to what precedes the suffix if the word ends with it
+            bool EndsWith(std::string_view suffix) noexcept
+            {
+                const ptrdiff_t length{ static_cast<ptrdiff_t>(suffix.size()) };
+                if (length > m_End + 1 || std::string_view{ m_Word + m_End + 1 - length, suffix.size() } != suffix)
+                    return false;
+
+                m_StemEnd = m_End - length;
+                return true;
+            }
+
+            void ReplaceSuffix(std::string_view replacement) noexcept
+            {
+                std::copy(replacement.begin(), replacement.end(), m_Word + m_StemEnd + 1);
+                m_End = m_StemEnd + static_cast<ptrdiff_t>(replacement.size());
+            }
+
+            void ReplaceSuffixIfMeasured(std::string_view replacement) noexcept
+            {
+                if (GetMeasure() > 0u)
+                    ReplaceSuffix(replacement);
+            }
+
+            // Plurals and the -ed and -ing forms
+            void Step1ab() noexcept
+            {
+                if (m_Word[m_End] == 's')
+                {
+                    if (EndsWith("sses"))
+                        m_End -= 2;
+                    else if (EndsWith("ies"))
+                        ReplaceSuffix("i");
+                    else if (m_Word[m_End - 1] != 's')
+                        --m_End;
+                }
+
+                if (EndsWith("eed"))
+                {
+                    if (GetMeasure() > 0u)
+                        --m_End;
+                }
+                else if ((EndsWith("ed") || EndsWith("ing")) && HasVowelInStem())
+                {
+                    m_End = m_StemEnd;
+
+                    if (EndsWith("at"))
+                        ReplaceSuffix("ate");
+                    else if (EndsWith("bl"))
+                        ReplaceSuffix("ble");
+                    else if (EndsWith("iz"))
+                        ReplaceSuffix("ize");
+                    else if (EndsWithDoubleConsonant(m_End))
+                    {
+                        if (m_Word[m_End] != 'l' && m_Word[m_End] != 's' && m_Word[m_End] != 'z')
+                            --m_End;
+                    }
+                    else if (GetMeasure() == 1u && EndsWithCVC(m_End))
+                        ReplaceSuffix("e");
+                }
+            }
+
+            // A final y becomes i when there is another vowel in the stem
+            void Step1c() noexcept
+            {
+                if (EndsWith("y") && HasVowelInStem())
+                    m_Word[m_End] = 'i';
+            }
+
+            // Double suffixes are mapped to single ones, e.g. -ization to -ize. As in the reference implementation, the letter
+            // before the last one selects the few suffixes worth comparing
+            void Step2() noexcept
+            {
+                switch (m_Word[m_End - 1])
+                {
+                    case 'a':
+                        ReplaceFirstSuffix({ { "ational", "ate" }, { "tional", "tion" } });
+                        break;
+                    case 'c':
+                        ReplaceFirstSuffix({ { "enci", "ence" }, { "anci", "ance" } });
+                        break;
+                    case 'e':
+                        ReplaceFirstSuffix({ { "izer", "ize" } });
+                        break;
+                    case 'l':
+                        ReplaceFirstSuffix({ { "bli", "ble" }, { "alli", "al" }, { "entli", "ent" }, { "eli", "e" }, { "ousli", "ous" } });
+                        break;
+                    case 'o':
+                        ReplaceFirstSuffix({ { "ization", "ize" }, { "ation", "ate" }, { "ator", "ate" } });
+                        break;
+                    case 's':
+                        ReplaceFirstSuffix({ { "alism", "al" }, { "iveness", "ive" }, { "fulness", "ful" }, { "ousness", "ous" } });
+                        break;
+                    case 't':
+                        ReplaceFirstSuffix({ { "aliti", "al" }, { "iviti", "ive" }, { "biliti", "ble" } });
+                        break;
+                    case 'g':
+                        ReplaceFirstSuffix({ { "logi", "log" } });
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            // -ic-, -full, -ness etc., selected by the last letter
+            void Step3() noexcept
+            {
+                switch (m_Word[m_End])
+                {
+                    case 'e':
+                        ReplaceFirstSuffix({ { "icate", "ic" }, { "ative", "" }, { "alize", "al" } });
+                        break;
+                    case 'i':
+                        ReplaceFirstSuffix({ { "iciti", "ic" } });
+                        break;
+                    case 'l':
+                        ReplaceFirstSuffix({ { "ical", "ic" }, { "ful", "" } });
+                        break;
+                    case 's':
+                        ReplaceFirstSuffix({ { "ness", "" } });
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            // -ant, -ence etc. are removed from a stem with more than one vowel-consonant sequence
+            void Step4() noexcept
+            {
+                const auto endsWithAny{ [this](std::initializer_list<std::string_view> suffixes) {
+                    return std::any_of(suffixes.begin(), suffixes.end(), [this](std::string_view suffix) { return EndsWith(suffix); });
+                } };
+
+                bool hasSuffix{ false };
+
+                switch (m_Word[m_End - 1])
+                {
+                    case 'a':
+                        hasSuffix = endsWithAny({ "al" });
+                        break;
+                    case 'c':
+                        hasSuffix = endsWithAny({ "ance", "ence" });
+                        break;
+                    case 'e':
+                        hasSuffix = endsWithAny({ "er" });
+                        break;
+                    case 'i':
+                        hasSuffix = endsWithAny({ "ic" });
+                        break;
+                    case 'l':
+                        hasSuffix = endsWithAny({ "able", "ible" });
+                        break;
+                    case 'n':
+                        hasSuffix = endsWithAny({ "ant", "ement", "ment", "ent" });
+                        break;
+                    case 'o':
+                        // -ion only follows s or t
+                        hasSuffix = (EndsWith("ion") && m_StemEnd >= 0 && (m_Word[m_StemEnd] == 's' || m_Word[m_StemEnd] == 't')) || EndsWith("ou");
+                        break;
+                    case 's':
+                        hasSuffix = endsWithAny({ "ism" });
+                        break;
+                    case 't':
+                        hasSuffix = endsWithAny({ "ate", "iti" });
+                        break;
+                    case 'u':
+                        hasSuffix = endsWithAny({ "ous" });
+                        break;
+                    case 'v':
+                        hasSuffix = endsWithAny({ "ive" });
+                        break;
+                    case 'z':
+                        hasSuffix = endsWithAny({ "ize" });
+                        break;
+                    default:
+                        break;
+                }
+
+                if (hasSuffix && GetMeasure() > 1u)
+                    m_End = m_StemEnd;
+            }
+
+            // A final -e and a final double l
+            void Step5() noexcept
+            {
+                m_StemEnd = m_End;
+
+                if (m_Word[m_End] == 'e')
+                {
+                    const size_t measure{ GetMeasure() };
+                    if (measure > 1u || (measure == 1u && !EndsWithCVC(m_End - 1)))
+                        --m_End;
+                }
+
+                if (m_Word[m_End] == 'l' && EndsWithDoubleConsonant(m_End) && GetMeasure() > 1u)
+                    --m_End;
+            }
+
+            // Only the first suffix the word ends with counts, even if its stem is too short to be replaced
+            void ReplaceFirstSuffix(std::initializer_list<std::pair<std::string_view, std::string_view>> suffixes) noexcept
+            {
+                for (const auto& [suffix, replacement] : suffixes)
+                {
+                    if (EndsWith(suffix))
+                    {
+                        ReplaceSuffixIfMeasured(replacement);
+                        return;
+                    }
+                }
+            }
+
+        private:
+            char* const m_Word{ nullptr };
+
+            ptrdiff_t m_End{ 0 };     // Index of the last letter of the word
+            ptrdiff_t m_StemEnd{ 0 }; // Index of the last letter of the stem the suffix found by EndsWith() leaves
+        };
+    } // namespace
+} // namespace Utils
+
+std::string_view WhitespaceSplitter::Next(std::string_view content, size_t& position) noexcept
+{
+    size_t skipLength{ 0u };
+
+    // Step 1: Skip the whitespace, a block of ASCII at a time while there is one
+    while (position < content.size())
+    {
+        if (content.size() - position >= Utils::BLOCK_SIZE)
+        {
+            if (const Utils::BlockMasks masks{ Utils::GetBlockMasks(content.data() + position) }; masks.NonASCII == 0u)
+            {
+                const uint32_t tokenMask{ ~masks.Whitespace & 0xFFFFu };
+                if (tokenMask == 0u)
+                {
+                    position += Utils::BLOCK_SIZE;
+                    continue;
+                }
+
+                const uint32_t tokenOffset{ static_cast<uint32_t>(std::countr_zero(tokenMask)) };
+                position += tokenOffset;
+
+                // Most tokens end within the same block, the whitespace after them is then already in its mask
+                if (const uint32_t whitespaceMask{ masks.Whitespace >> tokenOffset }; whitespaceMask != 0u)
+                {
+                    const size_t tokenBegin{ position };
+                    position += std::countr_zero(whitespaceMask);
+
+                    return content.substr(tokenBegin, position - tokenBegin);
+                }
+
+                break;
+            }
+        }
+
+        const size_t whitespaceLength{ Utils::GetWhitespaceLength(content, position, skipLength) };
+        if (whitespaceLength == 0u)
+            break;
+
+        position += whitespaceLength;
+    }
+
+    // Step 2: Find the end of the token the same way, a multibyte character is stepped over as a whole
+    const size_t tokenBegin{ position };
+
+    while (position < content.size())
+    {
+        if (content.size() - position >= Utils::BLOCK_SIZE)
+        {
+            if (const Utils::BlockMasks masks{ Utils::GetBlockMasks(content.data() + position) }; masks.NonASCII == 0u)
+            {
+                if (masks.Whitespace == 0u)
+                {
+                    position += Utils::BLOCK_SIZE;
+                    continue;
+                }
+
+                position += std::countr_zero(masks.Whitespace);
+                break;
+            }
+        }
+
+        if (Utils::GetWhitespaceLength(content, position, skipLength) != 0u)
+            break;
+
+        position += skipLength;
+    }
+
+    return content.substr(tokenBegin, position - tokenBegin);
+}
+
+size_t WhitespaceSplitter::GetMaxTokensCount(std::string_view content) noexcept
+{
+    // The whitespace bytes are counted a block at a time
+    size_t whitespaceCount{ 0u };
+    size_t i{ 0u };
+
+    for (; i + Utils::BLOCK_SIZE <= content.size(); i += Utils::BLOCK_SIZE)
+        whitespaceCount += std::popcount(Utils::GetBlockMasks(content.data() + i).Whitespace);
+
+    for (; i < content.size(); ++i)
+        whitespaceCount += Utils::IsASCIIWhitespace(static_cast<unsigned char>(content[i])) ? 1u : 0u;
+
+    return whitespaceCount + 1u;
+}
+
+bool LowercaseFilter::Apply(std::string_view token, std::string_view content, std::pmr::string& term)
+{
+    // Step 1: Most words are a single block of ASCII, their letters first and their punctuation, if any, after them. The
+    // block is lowercased at once and stored into the term as it is, the bytes past the letters are cut off again
+    const size_t readableSize{ static_cast<size_t>(content.data() + content.size() - token.data()) };
+    if (token.size() <= Utils::BLOCK_SIZE && readableSize >= Utils::BLOCK_SIZE)
+    {
+        const __m128i bytes{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(token.data())) };
+        const __m128i lowercase{ _mm_or_si128(bytes, _mm_set1_epi8(0x20)) };
+
+        // The bytes beyond ASCII are negative, so that they are not letters either
+        const __m128i isLetter{ _mm_and_si128(_mm_cmpgt_epi8(lowercase, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lowercase, _mm_set1_epi8('z' + 1))) };
+
+        const uint32_t tokenMask{ (1u << token.size()) - 1u };
+        const uint32_t letterMask{ static_cast<uint32_t>(_mm_movemask_epi8(isLetter)) & tokenMask };
+        const uint32_t nonASCIIMask{ static_cast<uint32_t>(_mm_movemask_epi8(bytes)) & tokenMask };
+
+        if (nonASCIIMask == 0u && (letterMask & (letterMask + 1u)) == 0u)
+        {
+            term.resize(Utils::BLOCK_SIZE);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(term.data()), lowercase);
+            term.resize(static_cast<size_t>(std::popcount(letterMask)));
+
+            return !term.empty();
+        }
+    }
+
+    // Step 2: The other tokens are built in a single pass, the letters are appended as they are found
+    term.clear();
+
+    const auto appendLetter{ [&term](char c) {
+        if (const char letter{ Utils::ASCII_LETTERS[static_cast<unsigned char>(c)] }; letter != '\0')
+            term.push_back(letter);
+    } };
+
+    for (size_t i{ 0u }; i < token.size();)
+    {
+        // The ASCII up to the next byte beyond it goes through the letters table, a block at a time while the rest of the
+        // token holds one. A shorter rest is checked byte by byte as it goes, so that it is read once
+        if (token.size() - i >= Utils::BLOCK_SIZE)
+        {
+            const uint32_t nonASCIIMask{ Utils::GetBlockMasks(token.data() + i).NonASCII };
+            const size_t   runEnd{ i + (nonASCIIMask == 0u ? Utils::BLOCK_SIZE : std::countr_zero(nonASCIIMask)) };
+
+            for (; i < runEnd; ++i)
+                appendLetter(token[i]);
+        }
+        else
+        {
+            for (; i < token.size() && static_cast<unsigned char>(token[i]) < 0x80u; ++i)
+                appendLetter(token[i]);
+        }
+
+        // A multibyte character is decoded and folded
+        if (i < token.size() && static_cast<unsigned char>(token[i]) >= 0x80u)
+        {
+            char32_t codePoint{ 0u };
+            i += Unicode::Decode(token.substr(i), codePoint);
+
+            Unicode::AppendFolded(term, codePoint);
+        }
+    }
+
+    return !term.empty();
+}
+
+bool LowercaseFilter::Apply(std::pmr::string& term)
+{
+    std::pmr::string token{ std::move(term) };
+    term = std::pmr::string{ token.get_allocator() };
+
+    return Apply(token, term);
+}
+
+bool PorterStemFilter::Apply(std::pmr::string& term)
+{
+    if (std::all_of(term.begin(), term.end(), [](char c) { return c >= 'a' && c <= 'z'; }))
+        term.resize(Utils::PorterStemmer{ term.data(), term.size() }.Stem());
+
+    return !term.empty();
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The analysis that turns a content or a query into the terms of the index: a splitter cuts the text into tokens, and
+// every token goes through the filters in order, each of which rewrites the term in place or drops it. The stages are
+// policies bound at compile time, so that a whole chain is inlined into a single loop over the tokens, and an index picks
+// one of the chains below once per call by its AnalyzerType rather than once per token.
+//
+// A splitter provides:
+//   static std::string_view Next(std::string_view content, size_t& position);  - the next token, empty at the end
+//   static size_t           GetMaxTokensCount(std::string_view content);        - a bound to reserve the terms with
+// A filter provides:
+//   static bool Apply(std::pmr::string& term);                                  - false drops the term
+//   static bool Apply(std::string_view token, std::string_view content,
+//                     std::pmr::string& term);                                  - optional, used as the first filter. The
+//                                                                                 token is a view into the content, whose
+//                                                                                 bytes past the token may be read
+
+// Splits at the ASCII and the Unicode whitespace, a block of ASCII at a time
+struct WhitespaceSplitter
+{
+    // Returns the token at or after the position and moves the position past it, an empty token once the content is exhausted
+    static std::string_view Next(std::string_view content, size_t& position) noexcept;
+
+    // The number of the ASCII whitespace bytes plus one
+    static size_t GetMaxTokensCount(std::string_view content) noexcept;
+};
+
+// Keeps the letters only, lowercased. The letters beyond ASCII are folded by Unicode::AppendFolded(), the blocks of pure
+// ASCII skip it. A term without any letter is dropped
+struct LowercaseFilter
+{
+    // A short token of ASCII whose letters come first is folded a block at a time, the block is read from the content
+    static bool Apply(std::string_view token, std::string_view content, std::pmr::string& term);
+
+    static bool Apply(std::string_view token, std::pmr::string& term) { return Apply(token, token, term); }
+
+    // Folds a copy, it is cheaper as the first filter of a chain
+    static bool Apply(std::pmr::string& term);
+};
+
+// Drops the English function words, which are in most documents and so select almost none
+struct StopwordFilter
+{
+    static bool Apply(const std::pmr::string& term) noexcept;
+
+private:
+    // The letters of a word of up to s_MaxStopwordLength bytes, padded with zeros. The zero byte that ends the word is read
+    // in place of the missing letters, so that there is no branch on its length. A term holds no zero byte, so that no
+    // two words pack alike
+    static constexpr uint64_t Pack(const char* word, size_t length) noexcept
+    {
+        uint64_t packedWord{ 0u };
+        for (size_t i{ 0u }; i < s_MaxStopwordLength; ++i)
+            packedWord = (packedWord << 8u) | static_cast<unsigned char>(word[std::min(i, length)]);
+
+        return packedWord;
+    }
+
+private:
+    static constexpr std::array<std::string_view, 33u> s_Stopwords{
+        "a", "an", "and", "are", "as", "at", "be", "but", "by", "for", "if", "in", "into", "is", "it", "no", "not",
+        "of", "on", "or", "such", "that", "the", "their", "then", "there", "these", "they", "this", "to", "was", "will", "with",
+    };
+
+    static constexpr size_t s_MaxStopwordLength{ 5u };
+    static constexpr size_t s_MaxStopwordsPerLength{ 16u }; // More words of one length fail to compile
+
+    static_assert(s_MaxStopwordLength <= sizeof(uint64_t));
+};
+
+inline bool StopwordFilter::Apply(const std::pmr::string& term) noexcept
+{
+    // The words are packed into integers and grouped by length, so that a term is compared with all the words of its
+    // length at once, without a branch per word. The unused slots hold zero, which no term packs to
+    static constexpr std::array<std::array<uint64_t, s_MaxStopwordsPerLength>, s_MaxStopwordLength + 1u> PACKED_STOPWORDS{ [] {
+        std::array<std::array<uint64_t, s_MaxStopwordsPerLength>, s_MaxStopwordLength + 1u> packedStopwords{};
+        std::array<size_t, s_MaxStopwordLength + 1u> stopwordsCount{};
+        for (const std::string_view stopword : s_Stopwords)
+            packedStopwords[stopword.size()][stopwordsCount[stopword.size()]++] = Pack(stopword.data(), stopword.size());
+
+        return packedStopwords;
+    }() };
+
+    // An empty term wraps around and is kept too
+    if (term.size() - 1u >= s_MaxStopwordLength)
+        return true;
+
+    const uint64_t packedTerm{ Pack(term.data(), term.size()) };
+
+    bool isStopword{ false };
+    for (const uint64_t packedStopword : PACKED_STOPWORDS[term.size()])
+        isStopword |= packedStopword == packedTerm;
+
+    return !isStopword;
+}
+
+// Strips the English suffixes with the algorithm of M. F. Porter (1980), so that "connected", "connecting" and
+// "connections" are all found by "connect". Expects lowercased terms, the terms with letters beyond ASCII are kept as they are
+struct PorterStemFilter
+{
+    static bool Apply(std::pmr::string& term);
+};
+
+template <typename Splitter, typename... Filters>
+class Analyzer
+{
+public:
+    // Builds the term of a single token of the content, returns false if a filter has dropped it
+    static bool Analyze(std::string_view token, std::string_view content, std::pmr::string& term)
+    {
+        if constexpr (sizeof...(Filters) == 0u)
+        {
+            term.assign(token);
+            return true;
+        }
+        else
+        {
+            return ApplyFilters<Filters...>(token, content, term);
+        }
+    }
+
+    // Calls onTerm(token, term) for every token the filters keep, in content order, until it returns false. The terms are
+    // built in the given buffer, which is reused for all of them
+    template <typename OnTerm>
+    static void ForEachTerm(std::string_view content, std::pmr::string& term, OnTerm&& onTerm)
+    {
+        size_t position{ 0u };
+
+        for (std::string_view token{ Splitter::Next(content, position) }; !token.empty(); token = Splitter::Next(content, position))
+        {
+            if (Analyze(token, content, term) && !onTerm(token, std::string_view{ term }))
+                return;
+        }
+    }
+
+    // The terms of the content in order, duplicates included
+    static std::pmr::vector<std::pmr::string> Tokenize(std::string_view content, std::pmr::memory_resource* resource)
+    {
+        std::pmr::vector<std::pmr::string> terms{ resource };
+        terms.reserve(Splitter::GetMaxTokensCount(content));
+
+        size_t position{ 0u };
+
+        for (std::string_view token{ Splitter::Next(content, position) }; !token.empty(); token = Splitter::Next(content, position))
+        {
+            std::pmr::string& term{ terms.emplace_back() };
+            term.reserve(token.size());
+
+            if (!Analyze(token, content, term))
+                terms.pop_back();
+        }
+
+        return terms;
+    }
+
+private:
+    template <typename FirstFilter, typename... OtherFilters>
+    static bool ApplyFilters(std::string_view token, std::string_view content, std::pmr::string& term)
+    {
+        // A first filter that reads the token itself saves copying it into the term
+        if constexpr (requires { { FirstFilter::Apply(token, content, term) } -> std::same_as<bool>; })
+        {
+            return FirstFilter::Apply(token, content, term) && (OtherFilters::Apply(term) && ...);
+        }
+        else
+        {
+            term.assign(token);
+            return FirstFilter::Apply(term) && (OtherFilters::Apply(term) && ...);
+        }
+    }
+};
+
+using StandardAnalyzer = Analyzer<WhitespaceSplitter, LowercaseFilter>;
+using EnglishAnalyzer = Analyzer<WhitespaceSplitter, LowercaseFilter, StopwordFilter, PorterStemFilter>;
+
+// The analyzers an index can be created with. The terms of an index are only found by the analyzer that has produced
+// them, so the index files record it
+enum AnalyzerType : uint8_t
+{
+    ANALYZER_TYPE_STANDARD = 0u, // StandardAnalyzer
+    ANALYZER_TYPE_ENGLISH,       // EnglishAnalyzer
+    ANALYZER_TYPES_COUNT,
+};
+
+// Names of the --analyzer option
+inline constexpr std::array<std::string_view, ANALYZER_TYPES_COUNT> ANALYZER_NAMES{ "standard", "english" };
+
+// Returns false if the name is not that of an analyzer
+inline bool ParseAnalyzerType(std::string_view name, AnalyzerType& analyzerType) noexcept
+{
+    const auto it{ std::find(ANALYZER_NAMES.begin(), ANALYZER_NAMES.end(), name) };
+    if (it == ANALYZER_NAMES.end())
+        return false;
+
+    analyzerType = static_cast<AnalyzerType>(it - ANALYZER_NAMES.begin());
+    return true;
+}
+
+// Calls function with an instance of the analyzer of the type, the analyzers are stateless. The function is instantiated
+// for every analyzer, so the switch is the only dispatch of a whole content
+template <typename Function>
+decltype(auto) VisitAnalyzer(AnalyzerType analyzerType, Function&& function)
+{
+    switch (analyzerType)
+    {
+        case ANALYZER_TYPE_ENGLISH:
+            return function(EnglishAnalyzer{});
+        default:
+            return function(StandardAnalyzer{});
+    }
+}
\ No newline at end of file
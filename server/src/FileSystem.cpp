@@ -1,37 +1,81 @@
 #include "FileSystem.h"
+#include "IndexFile.h"
 
-FileSystem::FileID FileSystem::LoadFile(const std::string& path)
+FileSystem::LoadedFile FileSystem::LoadFile(const std::string& path)
 {
-    std::ifstream fileStream{ path, std::ios::in | std::ios::ate };
-
-    if (!fileStream.is_open())
+    std::string fileContent{};
+    if (!ReadFile(path, fileContent))
     {
         LOG_ERROR_TAG("FileSystem", "Failed to open file: {0}", path);
-        return 0u;
+        return {};
     }
 
-    const size_t fileSize{ static_cast<size_t>(fileStream.tellg()) };
-    fileStream.seekg(0u, std::ios::beg);
+    const FileSystem::FileID fileID{ GetFileID(path) };
+    const uint64_t           contentHash{ HashContent(fileContent) };
+
+    // Step 1
+    // A hash match is confirmed under the read lock, so that the path lookups of the responses do not wait for the
+    // comparison of large files. The stored contents are never modified, the comparison holds once the lock is released
+    FileID comparedFileID{ 0u };
+    bool   isDuplicate{ false };
+    {
+        ReadLock _{ m_ObjectLock };
 
-    std::string fileContent(fileSize, '\0');
-    fileStream.read(fileContent.data(), fileSize);
+        if (const auto it{ m_ContentFileIDs.find(contentHash) }; it != m_ContentFileIDs.end() && it->second != fileID)
+        {
+            comparedFileID = it->second;
+            isDuplicate = HasContentUnsafe(comparedFileID, fileContent);
+        }
+    }
 
-    fileStream.close();
+    // Step 2
+    // Two identical files loaded at the same time are told apart under the write lock, the first one to get it is the
+    // canonical one. Only a canonical file that has shown up since the first step is compared under it
+    WriteLock _{ m_ObjectLock };
 
-    const FileSystem::FileID fileID{ std::hash<std::string>{}(path) };
+    // The path store only fails once its names would exceed 4 GB, the file is then reported as unreadable
+    try
+    {
+        m_FilePaths.Add(fileID, path);
+    }
+    catch (const std::runtime_error& e)
     {
-        WriteLock _{ m_ObjectLock };
-        m_WatchedFileContents[fileID] = fileContent;
-        m_WatchedFilePaths[fileID] = path;
+        LOG_ERROR_TAG("FileSystem", "Failed to add the path of the file {0}: {1}", path, e.what());
+        return {};
     }
 
-    return fileID;
+    const auto [it, isNewContent]{ m_ContentFileIDs.try_emplace(contentHash, fileID) };
+    if (!isNewContent && it->second != fileID)
+    {
+        if (it->second != comparedFileID)
+            isDuplicate = HasContentUnsafe(it->second, fileContent);
+
+        if (isDuplicate)
+        {
+            m_CanonicalFileIDs[fileID] = it->second;
+            return { .FileID = fileID, .CanonicalFileID = it->second };
+        }
+    }
+
+    // A hash collision leaves the file canonical, only the first content with a given hash is deduplicated
+    m_WatchedFileContents[fileID] = std::move(fileContent);
+
+    return { .FileID = fileID, .CanonicalFileID = fileID };
+}
+
+bool FileSystem::HasContentUnsafe(FileID fileID, std::string_view content) const
+{
+    const auto it{ m_WatchedFileContents.find(fileID) };
+    return it != m_WatchedFileContents.end() && it->second == content;
 }
 
 std::string_view FileSystem::GetContent(FileID fileID) const
 {
     ReadLock _{ m_ObjectLock };
 
+    if (const auto canonicalIt{ m_CanonicalFileIDs.find(fileID) }; canonicalIt != m_CanonicalFileIDs.end())
+        fileID = canonicalIt->second;
+
     auto it{ m_WatchedFileContents.find(fileID) };
     if (it != m_WatchedFileContents.end())
         return it->second;
@@ -39,28 +83,166 @@ std::string_view FileSystem::GetContent(FileID fileID) const
     return {};
 }
 
-std::string_view FileSystem::GetPath(FileID fileID) const
+std::string FileSystem::GetPath(FileID fileID) const
 {
-    ReadLock _{ m_ObjectLock };
-
-    auto it{ m_WatchedFilePaths.find(fileID) };
-    if (it != m_WatchedFilePaths.end())
-        return it->second;
+    std::string path{};
+    AppendPath(fileID, path);
 
-    return {};
+    return path;
 }
 
 bool FileSystem::FileIsLoaded(FileID fileID) const
 {
     ReadLock _{ m_ObjectLock };
 
-    return m_WatchedFileContents.contains(fileID);
+    return m_FilePaths.Contains(fileID);
 }
 
 bool FileSystem::FileIsLoaded(const std::string& path) const
 {
     ReadLock _{ m_ObjectLock };
 
-    const FileSystem::FileID fileID{ std::hash<std::string>{}(path) };
-    return m_WatchedFileContents.contains(fileID);
+    const FileSystem::FileID fileID{ GetFileID(path) };
+    return m_FilePaths.Contains(fileID);
+}
+
+std::vector<bool> FileSystem::FilesAreLoaded(std::span<const std::string> paths) const
+{
+    std::vector<FileSystem::FileID> fileIDs(paths.size());
+    std::transform(paths.begin(), paths.end(), fileIDs.begin(), [](const std::string& path) { return GetFileID(path); });
+
+    std::vector<bool> filesAreLoaded(paths.size(), false);
+    {
+        ReadLock _{ m_ObjectLock };
+
+        for (size_t i{ 0u }; i < fileIDs.size(); ++i)
+            filesAreLoaded[i] = m_FilePaths.Contains(fileIDs[i]);
+    }
+
+    return filesAreLoaded;
+}
+
+size_t FileSystem::LoadIndexedFiles(IndexFile::Reader& reader)
+{
+    FileID      fileID{ 0u };
+    std::string path{};
+    size_t      filesCount{ 0u };
+
+    WriteLock _{ m_ObjectLock };
+
+    while (reader.ReadFile(fileID, path))
+    {
+        m_FilePaths.Add(fileID, path);
+        ++filesCount;
+    }
+
+    return filesCount;
+}
+
+void FileSystem::Clear()
+{
+    WriteLock _{ m_ObjectLock };
+
+    m_WatchedFileContents.clear();
+    m_ContentFileIDs.clear();
+    m_CanonicalFileIDs.clear();
+
+    // The path store cannot be moved, its directory set points back at it
+    std::destroy_at(&m_FilePaths);
+    std::construct_at(&m_FilePaths);
+}
+
+FileSystem::MemoryStats FileSystem::GetMemoryStats() const
+{
+    MemoryStats memoryStats{};
+
+    ReadLock _{ m_ObjectLock };
+
+    memoryStats.HashTables.AddHashTable(m_WatchedFileContents);
+    memoryStats.HashTables.AddHashTable(m_ContentFileIDs);
+    memoryStats.HashTables.AddHashTable(m_CanonicalFileIDs);
+
+    for (const auto& [fileID, content] : m_WatchedFileContents)
+        memoryStats.FileContents.AddString(content);
+
+    memoryStats.FilePaths = m_FilePaths.GetMemoryUsage();
+
+    return memoryStats;
+}
+
+bool FileSystem::ReadFile(const std::string& path, std::string& content, size_t maxSize)
+{
+    std::ifstream fileStream{ path, std::ios::in | std::ios::binary | std::ios::ate };
+
+    if (!fileStream.is_open())
+        return false;
+
+    const size_t fileSize{ std::min(static_cast<size_t>(fileStream.tellg()), maxSize) };
+    fileStream.seekg(0u, std::ios::beg);
+
+    content.resize(fileSize);
+    fileStream.read(content.data(), fileSize);
+
+    return true;
 }
+
+uint64_t FileSystem::HashContent(std::string_view content) noexcept
+{
+    // XXH64: four lanes consume 32-byte stripes independently, the tail is folded in 8, 4 and then 1 byte at a time
+    constexpr uint64_t PRIME1{ 0x9E3779B185EBCA87u };
+    constexpr uint64_t PRIME2{ 0xC2B2AE3D27D4EB4Fu };
+    constexpr uint64_t PRIME3{ 0x165667B19E3779F9u };
+    constexpr uint64_t PRIME4{ 0x85EBCA77C2B2AE63u };
+    constexpr uint64_t PRIME5{ 0x27D4EB2F165667C5u };
+
+    const auto readUInt64{ [](const char* data) { uint64_t value{ 0u }; memcpy(&value, data, sizeof(value)); return value; } };
+    const auto readUInt32{ [](const char* data) { uint32_t value{ 0u }; memcpy(&value, data, sizeof(value)); return value; } };
+    const auto round{ [](uint64_t accumulator, uint64_t input) { return std::rotl(accumulator + input * PRIME2, 31) * PRIME1; } };
+    const auto mergeRound{ [&round](uint64_t accumulator, uint64_t lane) { return (accumulator ^ round(0u, lane)) * PRIME1 + PRIME4; } };
+
+    const char*       data{ content.data() };
+    const char* const end{ data + content.size() };
+    uint64_t          hash{ 0u };
+
+    if (content.size() >= 32u)
+    {
+        std::array<uint64_t, 4u> lanes{ PRIME1 + PRIME2, PRIME2, 0u, 0u - PRIME1 };
+
+        for (; end - data >= 32; data += 32)
+        {
+            for (size_t i{ 0u }; i < lanes.size(); ++i)
+                lanes[i] = round(lanes[i], readUInt64(data + i * 8u));
+        }
+
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+
+        for (const uint64_t lane : lanes)
+            hash = mergeRound(hash, lane);
+    }
+    else
+    {
+        hash = PRIME5;
+    }
+
+    hash += content.size();
+
+    for (; end - data >= 8; data += 8)
+        hash = std::rotl(hash ^ round(0u, readUInt64(data)), 27) * PRIME1 + PRIME4;
+
+    if (end - data >= 4)
+    {
+        hash = std::rotl(hash ^ (readUInt32(data) * PRIME1), 23) * PRIME2 + PRIME3;
+        data += 4;
+    }
+
+    for (; data < end; ++data)
+        hash = std::rotl(hash ^ (static_cast<uint8_t>(*data) * PRIME5), 11) * PRIME1;
+
+    hash ^= hash >> 33u;
+    hash *= PRIME2;
+    hash ^= hash >> 29u;
+    hash *= PRIME3;
+    hash ^= hash >> 32u;
+
+    return hash;
+}
\ No newline at end of file
@@ -1,9 +1,21 @@
 #pragma once
+#include "MemoryUsage.h"
+#include "PathStore.h"
+
+#include <cstdint>
+#include <limits>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
+
+namespace IndexFile
+{
+    class Reader;
+} // namespace IndexFile
 
 class FileSystem
 {
@@ -14,18 +26,92 @@ public:
     using ReadLock = std::shared_lock<ReadWriteLock>;
     using WriteLock = std::unique_lock<ReadWriteLock>;
 
+    // The documents of a cluster are spread over its servers by their FileID, every server loads and indexes only the files
+    // of its own partition
+    struct Partition
+    {
+        uint32_t Index{ 0u };
+        uint32_t Count{ 1u };
+
+        bool Contains(FileID fileID) const noexcept { return fileID % Count == Index; }
+    };
+
+    // A file whose content is byte-identical to that of a file loaded before is a duplicate of it, the canonical file.
+    // Its content is not kept a second time and only the canonical file is indexed
+    struct LoadedFile
+    {
+        FileSystem::FileID FileID{ 0u };          // 0 if the file cannot be read
+        FileSystem::FileID CanonicalFileID{ 0u }; // The FileID of the file itself unless it is a duplicate
+
+        bool IsDuplicate() const noexcept { return CanonicalFileID != FileID; }
+    };
+
+    struct MemoryStats
+    {
+        MemoryUsage FileContents{};
+        MemoryUsage FilePaths{};  // The whole path store, its hash tables included
+        MemoryUsage HashTables{};
+
+        size_t GetTotalBytes() const noexcept { return FileContents.GetTotalBytes() + FilePaths.GetTotalBytes() + HashTables.GetTotalBytes(); }
+    };
+
 public:
-    FileID LoadFile(const std::string& path);
+    // The content is hashed right after it has been read, a hash match is confirmed by comparing the contents
+    LoadedFile LoadFile(const std::string& path);
 
+    // The content of a duplicate is that of its canonical file
     std::string_view GetContent(FileID fileID) const;
-    std::string_view GetPath(FileID fileID) const;
+
+    // The paths are not kept as whole strings, see PathStore. The results are built by appending the paths straight into
+    // the response, GetPath() copies a path out for the other callers
+    std::string GetPath(FileID fileID) const;
+
+    template <typename String>
+    bool AppendPath(FileID fileID, String& destination) const
+    {
+        ReadLock _{ m_ObjectLock };
+        return m_FilePaths.AppendPath(fileID, destination);
+    }
+
+    template <typename String>
+    bool AppendJSONEscapedPath(FileID fileID, String& destination) const
+    {
+        ReadLock _{ m_ObjectLock };
+        return m_FilePaths.AppendJSONEscapedPath(fileID, destination);
+    }
 
     bool FileIsLoaded(FileID fileID) const;
     bool FileIsLoaded(const std::string& path) const;
 
+    // Checks a whole batch of paths under a single lock
+    std::vector<bool> FilesAreLoaded(std::span<const std::string> paths) const;
+
+    // Registers the files of a prebuilt index, they count as loaded while their content is not kept in memory
+    size_t LoadIndexedFiles(IndexFile::Reader& reader);
+
+    // Forgets every file, e.g. for a replica that reloads the index of its primary
+    void Clear();
+
+    MemoryStats GetMemoryStats() const;
+
+    static FileID GetFileID(std::string_view path) noexcept { return std::hash<std::string_view>{}(path); }
+
+    // 64-bit XXH64 hash of a file content, it runs at memory speed next to the read of the file
+    static uint64_t HashContent(std::string_view content) noexcept;
+
+    // Reads a whole file, or only its first maxSize bytes, returns false if it cannot be opened
+    static bool ReadFile(const std::string& path, std::string& content, size_t maxSize = std::numeric_limits<size_t>::max());
+
+private:
+    // Whether the file is kept with this content, the caller holds the lock
+    bool HasContentUnsafe(FileID fileID, std::string_view content) const;
+
 private:
     mutable ReadWriteLock m_ObjectLock{};
 
     std::unordered_map<FileID, std::string> m_WatchedFileContents{};
-    std::unordered_map<FileID, std::string> m_WatchedFilePaths{};
+    PathStore                               m_FilePaths{};
+
+    std::unordered_map<uint64_t, FileID> m_ContentFileIDs{};   // Content hash -> the canonical file holding that content
+    std::unordered_map<FileID, FileID>   m_CanonicalFileIDs{}; // Duplicate -> its canonical file
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "HTTP.h"
+
+#include "Tracer.h"
+
+namespace HTTP
+{
+    Request ParseRequest(std::string_view request, std::pmr::memory_resource* resource)
+    {
+        TRACE_SCOPE("HTTP::ParseRequest");
+
+        Request httpRequest{ .Headers = HeaderMap{ resource }, .QueryParams = FieldMap{ resource } };
+
+        const size_t headersEndPos{ request.find("\r\n\r\n") };
+        if (headersEndPos == std::string_view::npos)
+            throw std::runtime_error("Incomplete HTTP request headers");
+
+        httpRequest.Body = request.substr(headersEndPos + 4u);
+
+        // Step 1
+        // The request line: method, target and version separated by spaces
+        std::string_view headers{ request.substr(0u, headersEndPos) };
+
+        const size_t           requestLineEndPos{ std::min(headers.find("\r\n"), headers.size()) };
+        const std::string_view requestLine{ headers.substr(0u, requestLineEndPos) };
+        if (requestLine.empty())
+            throw std::runtime_error("Empty request line from HTTP request");
+
+        size_t requestLinePos{ 0u };
+        for (std::string_view* part : { &httpRequest.Method, &httpRequest.Path, &httpRequest.Version })
+        {
+            requestLinePos = std::min(requestLine.find_first_not_of(' ', requestLinePos), requestLine.size());
+
+            const size_t partEndPos{ std::min(requestLine.find(' ', requestLinePos), requestLine.size()) };
+            *part = requestLine.substr(requestLinePos, partEndPos - requestLinePos);
+
+            requestLinePos = partEndPos;
+        }
+
+        // Step 2
+        // The header lines, "Name: value"
+        headers.remove_prefix(std::min(requestLineEndPos + 2u, headers.size()));
+
+        for (const auto line : headers | std::views::split(std::string_view{ "\r\n" }))
+        {
+            const std::string_view headerLine{ line.begin(), line.end() };
+
+            const size_t colonPos{ headerLine.find(':') };
+            if (colonPos == std::string_view::npos)
+                continue;
+
+            std::string_view headerValue{ headerLine.substr(colonPos + 1u) };
+            headerValue.remove_prefix(std::min(headerValue.find_first_not_of(' '), headerValue.size()));
+
+            httpRequest.Headers[headerLine.substr(0u, colonPos)] = headerValue;
+        }
+
+        // Step 3
+        // The query string, "key=value" pairs separated by '&'
+        const size_t queryPos{ httpRequest.Path.find('?') };
+        if (queryPos == std::string_view::npos)
+            return httpRequest;
+
+        const std::string_view queryString{ httpRequest.Path.substr(queryPos + 1u) };
+        httpRequest.Path = httpRequest.Path.substr(0u, queryPos);
+
+        for (const auto pair : queryString | std::views::split('&'))
+        {
+            const std::string_view keyValuePair{ pair.begin(), pair.end() };
+
+            const size_t equalPos{ keyValuePair.find('=') };
+            if (equalPos == std::string_view::npos)
+                continue;
+
+            httpRequest.QueryParams.insert_or_assign(UrlDecode(keyValuePair.substr(0u, equalPos), resource), UrlDecode(keyValuePair.substr(equalPos + 1u), resource));
+        }
+
+        return httpRequest;
+    }
+
+    std::pmr::string UrlDecode(std::string_view value, std::pmr::memory_resource* resource)
+    {
+        std::pmr::string decodedValue{ resource };
+        decodedValue.reserve(value.size());
+
+        for (size_t i{ 0u }; i < value.size(); ++i)
+        {
+            uint8_t decodedChar{ 0u };
+
+            if (value[i] == '%' && i + 2u < value.size() && std::from_chars(value.data() + i + 1u, value.data() + i + 3u, decodedChar, 16).ptr == value.data() + i + 3u)
+            {
+                decodedValue.push_back(static_cast<char>(decodedChar));
+                i += 2u;
+            }
+            else if (value[i] == '+')
+            {
+                decodedValue.push_back(' ');
+            }
+            else
+            {
+                decodedValue.push_back(value[i]);
+            }
+        }
+
+        return decodedValue;
+    }
+
+    bool ParseSize(std::string_view value, size_t& result)
+    {
+        const auto [end, error]{ std::from_chars(value.data(), value.data() + value.size(), result) };
+        return error == std::errc{} && end == value.data() + value.size();
+    }
+
+    size_t GetContentLength(std::string_view headers)
+    {
+        constexpr std::string_view contentLengthHeader{ "content-length:" };
+
+        for (const auto line : headers | std::views::split(std::string_view{ "\r\n" }))
+        {
+            const std::string_view headerLine{ line.begin(), line.end() };
+            if (headerLine.size() < contentLengthHeader.size())
+                continue;
+
+            const bool isContentLength{ std::ranges::equal(headerLine.substr(0u, contentLengthHeader.size()), contentLengthHeader, [](char lhs, char rhs) {
+                return std::tolower(static_cast<unsigned char>(lhs)) == rhs;
+            }) };
+
+            if (!isContentLength)
+                continue;
+
+            std::string_view value{ headerLine.substr(contentLengthHeader.size()) };
+            value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+            value.remove_suffix(value.size() - std::min(value.find_last_not_of(' ') + 1u, value.size()));
+
+            size_t contentLength{ 0u };
+            if (!ParseSize(value, contentLength))
+                throw std::runtime_error("Invalid Content-Length header");
+
+            return contentLength;
+        }
+
+        return 0u;
+    }
+} // namespace HTTP
\ No newline at end of file
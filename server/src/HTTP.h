@@ -0,0 +1,60 @@
+#pragma once
+#include <format>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace HTTP
+{
+    // Lets the fields be looked up by std::string_view, without building a string for every lookup
+    struct FieldHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view field) const noexcept { return std::hash<std::string_view>{}(field); }
+    };
+
+    using FieldMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string, FieldHash, std::equal_to<>>;
+    using HeaderMap = std::pmr::unordered_map<std::string_view, std::string_view>;
+
+    struct Request
+    {
+        // Point into the parsed request
+        std::string_view Method{};
+        std::string_view Path{}; // Without the query string
+        std::string_view Version{};
+        HeaderMap        Headers{};
+        std::string_view Body{};
+
+        FieldMap QueryParams{}; // URL-decoded
+    };
+
+    // Parses a complete request, as framed by the server. The maps are allocated from the given resource
+    Request ParseRequest(std::string_view request, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    std::pmr::string UrlDecode(std::string_view value, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    bool             ParseSize(std::string_view value, size_t& result);
+
+    // Value of the Content-Length header among the given header lines, 0 if there is none. Throws if it is not a number
+    size_t GetContentLength(std::string_view headers);
+
+    // Works with any string type, so that responses can be built in a scratch arena
+    template <typename String>
+    void AppendJSONEscaped(String& destination, std::string_view value)
+    {
+        for (const char c : value)
+        {
+            if (static_cast<unsigned char>(c) < 0x20u)
+            {
+                std::format_to(std::back_inserter(destination), "\\u{0:04x}", static_cast<uint32_t>(c));
+                continue;
+            }
+
+            if (c == '\\' || c == '"')
+                destination.push_back('\\');
+            destination.push_back(c);
+        }
+    }
+} // namespace HTTP
@@ -0,0 +1,216 @@
+#include "IndexFile.h"
+
+// The format is little-endian and so are all the targets this server is built for, integers are written as they are in memory
+static_assert(std::endian::native == std::endian::little);
+
+namespace IndexFile
+{
+    namespace
+    {
+        constexpr uint64_t COUNTS_OFFSET{ MAGIC.size() + sizeof(VERSION) + sizeof(uint32_t) };
+    } // namespace
+
+    Writer::Writer(const std::string& path, AnalyzerType analyzerType)
+        : m_Stream{ path, std::ios::out | std::ios::binary | std::ios::trunc }
+        , m_Path{ path }
+    {
+        if (!m_Stream.is_open())
+            throw std::runtime_error(std::format("Failed to create the index file {0}", path).c_str());
+
+        Write(MAGIC.data(), MAGIC.size());
+        WriteUInt32(VERSION);
+        WriteUInt32(analyzerType);
+        WriteUInt64(0u);
+        WriteUInt64(0u);
+        WriteUInt64(0u);
+    }
+
+    void Writer::WriteFile(FileSystem::FileID fileID, std::string_view path)
+    {
+        if (m_TermsCount > 0u)
+            throw std::runtime_error("Index files have to be written before the terms");
+
+        WriteUInt64(fileID);
+        WriteUInt32(static_cast<uint32_t>(path.size()));
+        Write(path.data(), path.size());
+
+        ++m_FilesCount;
+    }
+
+    void Writer::WriteTerm(std::string_view term, std::span<const FileSystem::FileID> fileIDs)
+    {
+        if (m_DuplicatesCount > 0u)
+            throw std::runtime_error("Index terms have to be written before the duplicates");
+
+        WriteUInt32(static_cast<uint32_t>(term.size()));
+        Write(term.data(), term.size());
+        WriteUInt64(fileIDs.size());
+
+        static_assert(sizeof(FileSystem::FileID) == sizeof(uint64_t));
+        Write(fileIDs.data(), fileIDs.size_bytes());
+
+        ++m_TermsCount;
+        m_PostingsCount += fileIDs.size();
+    }
+
+    void Writer::WriteDuplicate(FileSystem::FileID fileID, FileSystem::FileID canonicalFileID)
+    {
+        WriteUInt64(fileID);
+        WriteUInt64(canonicalFileID);
+
+        ++m_DuplicatesCount;
+    }
+
+    void Writer::Finish()
+    {
+        m_Stream.seekp(COUNTS_OFFSET);
+        WriteUInt64(m_FilesCount);
+        WriteUInt64(m_TermsCount);
+        WriteUInt64(m_DuplicatesCount);
+        m_WrittenBytes -= 3u * sizeof(uint64_t);
+
+        m_Stream.close();
+        if (m_Stream.fail())
+            throw std::runtime_error(std::format("Failed to write the index file {0}", m_Path).c_str());
+    }
+
+    void Writer::Write(const void* data, size_t size)
+    {
+        m_Stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (m_Stream.fail())
+            throw std::runtime_error(std::format("Failed to write the index file {0}", m_Path).c_str());
+
+        m_WrittenBytes += size;
+    }
+
+    void Writer::WriteUInt32(uint32_t value)
+    {
+        Write(&value, sizeof(value));
+    }
+
+    void Writer::WriteUInt64(uint64_t value)
+    {
+        Write(&value, sizeof(value));
+    }
+
+    Reader::Reader(const std::string& path, const FileSystem::Partition& partition)
+        : m_Stream{ path, std::ios::in | std::ios::binary }
+        , m_Path{ path }
+        , m_Partition{ partition }
+    {
+        if (!m_Stream.is_open())
+            throw std::runtime_error(std::format("Failed to open the index file {0}", path).c_str());
+
+        std::array<char, MAGIC.size()> magic{};
+        Read(magic.data(), magic.size());
+
+        if (std::string_view{ magic.data(), magic.size() } != MAGIC)
+            throw std::runtime_error(std::format("{0} is not an index file", path).c_str());
+
+        const uint32_t version{ ReadUInt32() };
+        if (version == 0u || version > VERSION)
+            throw std::runtime_error(std::format("Unsupported version {0} of the index file {1}", version, path).c_str());
+
+        if (version >= 3u)
+        {
+            const uint32_t analyzerType{ ReadUInt32() };
+            if (analyzerType >= ANALYZER_TYPES_COUNT)
+                throw std::runtime_error(std::format("Unknown analyzer {0} of the index file {1}", analyzerType, path).c_str());
+
+            m_AnalyzerType = static_cast<AnalyzerType>(analyzerType);
+        }
+
+        m_FilesCount = ReadUInt64();
+        m_TermsCount = ReadUInt64();
+
+        if (version >= 2u)
+            m_DuplicatesCount = ReadUInt64();
+    }
+
+    bool Reader::ReadFile(FileSystem::FileID& fileID, std::string& path)
+    {
+        while (m_ReadFilesCount != m_FilesCount)
+        {
+            fileID = ReadUInt64();
+            path.resize(ReadUInt32());
+            Read(path.data(), path.size());
+
+            ++m_ReadFilesCount;
+
+            if (m_Partition.Contains(fileID))
+            {
+                ++m_PartitionFilesCount;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool Reader::ReadTerm(std::string& term, std::vector<FileSystem::FileID>& fileIDs)
+    {
+        if (m_ReadFilesCount != m_FilesCount)
+            throw std::runtime_error("Index files have to be read before the terms");
+
+        while (m_ReadTermsCount != m_TermsCount)
+        {
+            term.resize(ReadUInt32());
+            Read(term.data(), term.size());
+
+            fileIDs.resize(ReadUInt64());
+            Read(fileIDs.data(), fileIDs.size() * sizeof(FileSystem::FileID));
+
+            ++m_ReadTermsCount;
+
+            if (m_Partition.Count > 1u)
+                std::erase_if(fileIDs, [this](FileSystem::FileID fileID) { return !m_Partition.Contains(fileID); });
+
+            if (!fileIDs.empty())
+                return true;
+        }
+
+        return false;
+    }
+
+    bool Reader::ReadDuplicate(FileSystem::FileID& fileID, FileSystem::FileID& canonicalFileID)
+    {
+        if (m_ReadTermsCount != m_TermsCount)
+            throw std::runtime_error("Index terms have to be read before the duplicates");
+
+        while (m_ReadDuplicatesCount != m_DuplicatesCount)
+        {
+            fileID = ReadUInt64();
+            canonicalFileID = ReadUInt64();
+
+            ++m_ReadDuplicatesCount;
+
+            if (m_Partition.Contains(fileID) && m_Partition.Contains(canonicalFileID))
+                return true;
+        }
+
+        return false;
+    }
+
+    void Reader::Read(void* data, size_t size)
+    {
+        m_Stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (m_Stream.fail())
+            throw std::runtime_error(std::format("The index file {0} is truncated", m_Path).c_str());
+    }
+
+    uint32_t Reader::ReadUInt32()
+    {
+        uint32_t value{ 0u };
+        Read(&value, sizeof(value));
+
+        return value;
+    }
+
+    uint64_t Reader::ReadUInt64()
+    {
+        uint64_t value{ 0u };
+        Read(&value, sizeof(value));
+
+        return value;
+    }
+} // namespace IndexFile
\ No newline at end of file
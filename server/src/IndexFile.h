@@ -0,0 +1,104 @@
+#pragma once
+#include "Analyzer.h"
+#include "FileSystem.h"
+
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// On-disk format of a prebuilt index, every integer is little-endian:
+//   header:     magic "CWIX", version (4 bytes), AnalyzerType (4 bytes),
+//               files count (8 bytes), terms count (8 bytes), duplicates count (8 bytes)
+//   files:      FileID (8 bytes), path length (4 bytes), path                           - for every file, duplicates included
+//   terms:      term length (4 bytes), term, postings count (8 bytes), FileIDs (8 bytes each) - for every term, in ascending order
+//   duplicates: FileID (8 bytes), canonical FileID (8 bytes)                            - for every file that has no postings of its own
+// Version 1 files have neither the duplicates count nor the duplicates section, version 1 and 2 files have no AnalyzerType
+// and have been built with ANALYZER_TYPE_STANDARD
+namespace IndexFile
+{
+    inline constexpr std::string_view MAGIC{ "CWIX" };
+    inline constexpr uint32_t         VERSION{ 3u };
+
+    class Writer
+    {
+    public:
+        // The terms have to be those of the analyzer of the given type
+        Writer(const std::string& path, AnalyzerType analyzerType);
+
+    public:
+        // All the files have to be written before the first term, all the terms before the first duplicate
+        void WriteFile(FileSystem::FileID fileID, std::string_view path);
+        void WriteTerm(std::string_view term, std::span<const FileSystem::FileID> fileIDs);
+        void WriteDuplicate(FileSystem::FileID fileID, FileSystem::FileID canonicalFileID);
+
+        // Patches the counts into the header, the index is not valid before
+        void Finish();
+
+        uint64_t GetFilesCount() const noexcept { return m_FilesCount; }
+        uint64_t GetTermsCount() const noexcept { return m_TermsCount; }
+        uint64_t GetDuplicatesCount() const noexcept { return m_DuplicatesCount; }
+        uint64_t GetPostingsCount() const noexcept { return m_PostingsCount; }
+        uint64_t GetWrittenBytes() const noexcept { return m_WrittenBytes; }
+
+    private:
+        void Write(const void* data, size_t size);
+        void WriteUInt32(uint32_t value);
+        void WriteUInt64(uint64_t value);
+
+    private:
+        std::ofstream m_Stream{};
+        std::string   m_Path{};
+
+        uint64_t m_FilesCount{ 0u };
+        uint64_t m_TermsCount{ 0u };
+        uint64_t m_DuplicatesCount{ 0u };
+        uint64_t m_PostingsCount{ 0u };
+        uint64_t m_WrittenBytes{ 0u };
+    };
+
+    class Reader
+    {
+    public:
+        // Only the files of the partition and their postings are read, the terms left without postings are skipped
+        explicit Reader(const std::string& path, const FileSystem::Partition& partition = {});
+
+    public:
+        // All return false once their section has been read entirely, the sections have to be read in order.
+        // A duplicate is only read if both files are in the partition
+        bool ReadFile(FileSystem::FileID& fileID, std::string& path);
+        bool ReadTerm(std::string& term, std::vector<FileSystem::FileID>& fileIDs);
+        bool ReadDuplicate(FileSystem::FileID& fileID, FileSystem::FileID& canonicalFileID);
+
+        AnalyzerType GetAnalyzerType() const noexcept { return m_AnalyzerType; }
+
+        // Of the whole index, regardless of the partition
+        uint64_t GetFilesCount() const noexcept { return m_FilesCount; }
+        uint64_t GetTermsCount() const noexcept { return m_TermsCount; }
+        uint64_t GetDuplicatesCount() const noexcept { return m_DuplicatesCount; }
+
+        // The files of the partition returned by ReadFile() so far
+        uint64_t GetReadFilesCount() const noexcept { return m_PartitionFilesCount; }
+
+    private:
+        void     Read(void* data, size_t size);
+        uint32_t ReadUInt32();
+        uint64_t ReadUInt64();
+
+    private:
+        std::ifstream         m_Stream{};
+        std::string           m_Path{};
+        FileSystem::Partition m_Partition{};
+        AnalyzerType          m_AnalyzerType{ ANALYZER_TYPE_STANDARD };
+
+        uint64_t m_FilesCount{ 0u };
+        uint64_t m_TermsCount{ 0u };
+        uint64_t m_DuplicatesCount{ 0u };
+        uint64_t m_ReadFilesCount{ 0u };
+        uint64_t m_ReadTermsCount{ 0u };
+        uint64_t m_ReadDuplicatesCount{ 0u };
+        uint64_t m_PartitionFilesCount{ 0u };
+    };
+} // namespace IndexFile
\ No newline at end of file
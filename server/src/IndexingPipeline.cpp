@@ -0,0 +1,346 @@
+#include "IndexingPipeline.h"
+
+#include "Tracer.h"
+
+IndexingPipeline::IndexingPipeline(ThreadPool& threadPool, uint8_t taskPriority, uint32_t maxWorkersCount, FileSystem& fileSystem, InvertedIndex& invertedIndex, const FileSystem::Partition& partition,
+    ReplicationLog* replicationLog)
+    : m_ThreadPool{ threadPool }
+    , m_TaskPriority{ taskPriority }
+    , m_MaxWorkersCount{ std::max(maxWorkersCount, 1u) }
+    , m_FileSystem{ fileSystem }
+    , m_InvertedIndex{ invertedIndex }
+    , m_Partition{ partition }
+    , m_ReplicationLog{ replicationLog }
+{
+}
+
+void IndexingPipeline::Start(const std::string& directory)
+{
+    m_StartTimePoint = std::chrono::steady_clock::now();
+
+    SpawnCrawler(directory);
+}
+
+void IndexingPipeline::SpawnCrawler(std::filesystem::path directory)
+{
+    ++m_PendingDirectoriesCount;
+
+    try
+    {
+        m_ThreadPool.AddTask(m_TaskPriority, [pipeline = shared_from_this(), directory = std::move(directory)]() { pipeline->CrawlDirectory(directory); });
+    }
+    catch (const std::runtime_error&)
+    {
+        // The ThreadPool is shutting down, the crawl is abandoned
+        --m_PendingDirectoriesCount;
+    }
+}
+
+void IndexingPipeline::CrawlDirectory(const std::filesystem::path& directory)
+{
+    TRACE_SCOPE("IndexingPipeline::CrawlDirectory");
+
+    std::vector<std::string> filePaths{};
+    std::vector<size_t>      fileSizes{};
+
+    // The entries are taken as the directory listing returns them, without walking into subdirectories,
+    // which are crawled by tasks of their own. Symlinked directories are skipped to avoid cycles.
+    std::error_code                     error{};
+    std::filesystem::directory_iterator directoryIterator{ directory, error };
+
+    for (; !error && directoryIterator != std::filesystem::directory_iterator{}; directoryIterator.increment(error))
+    {
+        const std::filesystem::directory_entry& directoryEntry{ *directoryIterator };
+
+        std::error_code entryError{};
+        if (directoryEntry.is_directory(entryError) && !directoryEntry.is_symlink(entryError))
+        {
+            SpawnCrawler(directoryEntry.path());
+        }
+        else if (directoryEntry.is_regular_file(entryError))
+        {
+            std::string filePath{ directoryEntry.path().string() };
+            if (!m_Partition.Contains(FileSystem::GetFileID(filePath)))
+                continue;
+
+            const uintmax_t fileSize{ directoryEntry.file_size(entryError) };
+
+            filePaths.push_back(std::move(filePath));
+            fileSizes.push_back(entryError ? 0u : static_cast<size_t>(fileSize));
+        }
+    }
+
+    if (error)
+        LOG_ERROR_TAG("IndexingPipeline", "Failed to crawl directory {0}: {1}", directory.string(), error.message());
+
+    // The loaded state of the whole directory is checked under a single lock
+    const std::vector<bool> filesAreLoaded{ m_FileSystem.FilesAreLoaded(filePaths) };
+
+    std::vector<FileEntry> files{};
+    for (size_t i{ 0u }; i < filePaths.size(); ++i)
+    {
+        if (!filesAreLoaded[i])
+            files.push_back({ .Path = std::move(filePaths[i]), .Size = fileSizes[i] });
+    }
+
+    AddFiles(std::move(files));
+
+    --m_PendingDirectoriesCount;
+    TryFinish();
+}
+
+void IndexingPipeline::AddFiles(std::vector<FileEntry> files)
+{
+    if (files.empty())
+        return;
+
+    const size_t filesCount{ files.size() };
+    m_PendingFilesCount += filesCount;
+
+    {
+        std::lock_guard _{ m_UnreadFilesLock };
+
+        for (auto& file : files)
+            m_UnreadFiles.push(std::move(file));
+    }
+
+    SpawnWorkers(filesCount);
+}
+
+void IndexingPipeline::SpawnWorkers(size_t filesCount)
+{
+    uint32_t activeWorkersCount{ m_ActiveWorkersCount.load() };
+
+    for (size_t spawnedWorkersCount{ 0u }; spawnedWorkersCount < filesCount && activeWorkersCount < m_MaxWorkersCount;)
+    {
+        if (!m_ActiveWorkersCount.compare_exchange_weak(activeWorkersCount, activeWorkersCount + 1u))
+            continue;
+
+        ++activeWorkersCount;
+        ++spawnedWorkersCount;
+
+        try
+        {
+            m_ThreadPool.AddTask(m_TaskPriority, [pipeline = shared_from_this()]() { pipeline->Work(); });
+        }
+        catch (const std::runtime_error&)
+        {
+            // The ThreadPool is shutting down, the remaining files are abandoned
+            --m_ActiveWorkersCount;
+            return;
+        }
+    }
+}
+
+void IndexingPipeline::Work()
+{
+    while (true)
+    {
+        // Downstream stages first: they free the memory and the queue slots the read stage waits for
+        while (TryMerge() || TryTokenize() || TryRead())
+        {
+        }
+
+        // The files still in flight are carried to the end by the workers that hold them. The last worker to leave
+        // checks again for the files a crawler may have added while it still counted as active, and so spawned no one.
+        if (m_ActiveWorkersCount.fetch_sub(1u) != 1u || GetUnreadFilesCount() == 0u)
+            return;
+
+        ++m_ActiveWorkersCount;
+    }
+}
+
+bool IndexingPipeline::TryRead()
+{
+    const size_t inFlightBytes{ m_InFlightBytes.load() };
+    if (inFlightBytes > 0u && inFlightBytes >= s_MaxInFlightBytes)
+        return false;
+
+    {
+        std::lock_guard _{ m_ReadFilesLock };
+        if (m_ReadFiles.size() >= s_MaxQueuedFilesCount)
+            return false;
+    }
+
+    FileEntry file{};
+    {
+        std::lock_guard _{ m_UnreadFilesLock };
+        if (m_UnreadFiles.empty())
+            return false;
+
+        file = m_UnreadFiles.top();
+        m_UnreadFiles.pop();
+    }
+
+    m_InFlightBytes += file.Size;
+
+    TRACE_SCOPE("IndexingPipeline::Read");
+
+    const FileSystem::LoadedFile loadedFile{ m_FileSystem.LoadFile(file.Path) };
+    if (loadedFile.FileID == 0u)
+    {
+        FinishFile(file.Size);
+        return true;
+    }
+
+    // A duplicate skips the tokenize and merge stages, it shares the postings of its canonical file
+    if (loadedFile.IsDuplicate())
+    {
+        m_InvertedIndex.AddDuplicate(loadedFile.CanonicalFileID, loadedFile.FileID);
+        if (m_ReplicationLog)
+            m_ReplicationLog->AddDuplicate(loadedFile.FileID, loadedFile.CanonicalFileID);
+
+        ++m_DuplicateFilesCount;
+        FinishFile(file.Size);
+        return true;
+    }
+
+    {
+        std::lock_guard _{ m_ReadFilesLock };
+        m_ReadFiles.push_back({ .FileID = loadedFile.FileID, .Content = m_FileSystem.GetContent(loadedFile.FileID), .Size = file.Size });
+    }
+
+    return true;
+}
+
+bool IndexingPipeline::TryTokenize()
+{
+    {
+        std::lock_guard _{ m_TokenizedFilesLock };
+        if (m_TokenizedFiles.size() >= s_MaxQueuedFilesCount)
+            return false;
+    }
+
+    ReadFile readFile{};
+    {
+        std::lock_guard _{ m_ReadFilesLock };
+        if (m_ReadFiles.empty())
+            return false;
+
+        readFile = m_ReadFiles.front();
+        m_ReadFiles.pop_front();
+    }
+
+    auto fileTerms{ std::make_unique<FileTerms>(readFile.Content.size()) };
+    {
+        TRACE_SCOPE("IndexingPipeline::Tokenize");
+        fileTerms->Terms = m_InvertedIndex.ExtractTerms(readFile.Content, &fileTerms->Arena);
+    }
+
+    TokenizedFile tokenizedFile{ .FileID = readFile.FileID, .Terms = std::move(fileTerms), .Size = readFile.Size };
+    {
+        std::lock_guard _{ m_TokenizedFilesLock };
+        m_TokenizedFiles.push_back(std::move(tokenizedFile));
+    }
+
+    return true;
+}
+
+bool IndexingPipeline::TryMerge()
+{
+    TokenizedFile tokenizedFile{};
+    {
+        std::lock_guard _{ m_TokenizedFilesLock };
+        if (m_TokenizedFiles.empty())
+            return false;
+
+        tokenizedFile = std::move(m_TokenizedFiles.front());
+        m_TokenizedFiles.pop_front();
+    }
+
+    {
+        TRACE_SCOPE("IndexingPipeline::Merge");
+        m_InvertedIndex.AddTerms(tokenizedFile.FileID, tokenizedFile.Terms->Terms);
+    }
+
+    if (m_ReplicationLog)
+        m_ReplicationLog->AddFile(tokenizedFile.FileID, tokenizedFile.Terms->Terms);
+
+    ++m_IndexedFilesCount;
+    m_IndexedBytes += tokenizedFile.Size;
+    FinishFile(tokenizedFile.Size);
+
+    return true;
+}
+
+double IndexingPipeline::GetIndexingRate() const
+{
+    const std::chrono::steady_clock::time_point finishTimePoint{ m_FinishTimePoint.load() };
+    const std::chrono::steady_clock::time_point endTimePoint{ finishTimePoint != std::chrono::steady_clock::time_point::max() ? finishTimePoint : std::chrono::steady_clock::now() };
+
+    const double elapsedSeconds{ std::chrono::duration<double>(endTimePoint - m_StartTimePoint).count() };
+
+    return elapsedSeconds > 0.0 ? static_cast<double>(m_IndexedBytes.load()) / elapsedSeconds : 0.0;
+}
+
+size_t IndexingPipeline::GetUnreadFilesCount()
+{
+    std::lock_guard _{ m_UnreadFilesLock };
+    return m_UnreadFiles.size();
+}
+
+void IndexingPipeline::FinishFile(size_t size)
+{
+    m_InFlightBytes -= size;
+    --m_PendingFilesCount;
+
+    // The workers the read stage has refused have left, the released bytes let new ones read the files they left behind
+    if (m_ActiveWorkersCount.load() < m_MaxWorkersCount)
+    {
+        if (const size_t unreadFilesCount{ GetUnreadFilesCount() }; unreadFilesCount != 0u)
+            SpawnWorkers(unreadFilesCount);
+    }
+
+    TryFinish();
+}
+
+void IndexingPipeline::TryFinish()
+{
+    // The crawlers add their files before leaving, so no file can show up once both counts are zero
+    if (m_PendingDirectoriesCount.load() != 0u || m_PendingFilesCount.load() != 0u || m_IsFinished.exchange(true))
+        return;
+
+    const std::chrono::steady_clock::time_point finishTimePoint{ std::chrono::steady_clock::now() };
+    m_FinishTimePoint.store(finishTimePoint);
+
+    // Also after an update that has indexed nothing, which still commits the files of a previous commit that has failed
+    if (m_ReplicationLog)
+    {
+        try
+        {
+            m_ReplicationLog->CommitSegment(m_FileSystem);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_TAG("IndexingPipeline", "Failed to commit the replication segment, its files are left for the next update: {0}", e.what());
+        }
+    }
+
+    const size_t indexedFilesCount{ m_IndexedFilesCount.load() };
+    const size_t duplicateFilesCount{ m_DuplicateFilesCount.load() };
+    if (indexedFilesCount == 0u && duplicateFilesCount == 0u)
+        return;
+
+    const double elapsedSeconds{ std::chrono::duration<double>(finishTimePoint - m_StartTimePoint).count() };
+    const double indexedMegabytes{ static_cast<double>(m_IndexedBytes.load()) / (1024.0 * 1024.0) };
+
+    LOG_INFO_TAG("IndexingPipeline", "Indexed {0} files ({1:.1f} MB) in {2:.3f} s, {3:.1f} MB/s, {4} duplicates", indexedFilesCount, indexedMegabytes, elapsedSeconds,
+        elapsedSeconds > 0.0 ? indexedMegabytes / elapsedSeconds : 0.0, duplicateFilesCount);
+
+    LogMemoryStats(m_FileSystem, m_InvertedIndex);
+}
+
+void IndexingPipeline::LogMemoryStats(const FileSystem& fileSystem, const InvertedIndex& invertedIndex)
+{
+    const InvertedIndex::MemoryStats indexMemoryStats{ invertedIndex.GetMemoryStats() };
+    const FileSystem::MemoryStats    filesMemoryStats{ fileSystem.GetMemoryStats() };
+
+    const auto toMegabytes{ [](size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); } };
+
+    LOG_INFO_TAG("IndexingPipeline", "Memory: index {0:.1f} MB (term keys {1:.1f} MB, posting lists {2:.1f} MB of which {3:.1f} MB slack, hash tables {4:.1f} MB)",
+        toMegabytes(indexMemoryStats.GetTotalBytes()), toMegabytes(indexMemoryStats.TermKeys.GetTotalBytes()), toMegabytes(indexMemoryStats.PostingLists.GetTotalBytes()),
+        toMegabytes(indexMemoryStats.PostingLists.SlackBytes), toMegabytes(indexMemoryStats.HashTables.GetTotalBytes()));
+    LOG_INFO_TAG("IndexingPipeline", "Memory: files {0:.1f} MB (contents {1:.1f} MB, paths {2:.1f} MB, hash tables {3:.1f} MB)",
+        toMegabytes(filesMemoryStats.GetTotalBytes()), toMegabytes(filesMemoryStats.FileContents.GetTotalBytes()), toMegabytes(filesMemoryStats.FilePaths.GetTotalBytes()),
+        toMegabytes(filesMemoryStats.HashTables.GetTotalBytes()));
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include "FileSystem.h"
+#include "InvertedIndex.h"
+#include "Replication.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+// Indexes the new files of a directory tree in stages: crawl -> read -> tokenize -> merge into the index shards.
+// Every directory is crawled by a ThreadPool task of its own that streams the files it holds into the pipeline right away.
+// Every worker picks the most downstream stage that has pending files, so files never pile up between the stages,
+// while the read stage only admits new files as long as the queues and the bytes held by the pipeline stay under their bounds.
+class IndexingPipeline : public std::enable_shared_from_this<IndexingPipeline>
+{
+public:
+    // Only the files of the partition are indexed, the others are skipped by the crawlers. The merged files are also added
+    // to the replication log if there is one, which commits them as a segment once the pipeline has finished
+    IndexingPipeline(ThreadPool& threadPool, uint8_t taskPriority, uint32_t maxWorkersCount, FileSystem& fileSystem, InvertedIndex& invertedIndex, const FileSystem::Partition& partition = {},
+        ReplicationLog* replicationLog = nullptr);
+
+    IndexingPipeline(const IndexingPipeline&) noexcept = delete;
+    IndexingPipeline(IndexingPipeline&&) noexcept = delete;
+
+    IndexingPipeline& operator=(const IndexingPipeline&) noexcept = delete;
+    IndexingPipeline& operator=(IndexingPipeline&&) noexcept = delete;
+
+public:
+    // Returns right away, the crawling and the indexing run on the ThreadPool
+    void Start(const std::string& directory);
+
+    bool IsFinished() const noexcept { return m_IsFinished.load(); }
+
+    size_t GetIndexedFilesCount() const noexcept { return m_IndexedFilesCount.load(); }
+    size_t GetDuplicateFilesCount() const noexcept { return m_DuplicateFilesCount.load(); }
+    size_t GetIndexedBytes() const noexcept { return m_IndexedBytes.load(); }
+
+    // Bytes merged into the index per second, over the run so far while the pipeline is not finished
+    double GetIndexingRate() const;
+
+    // time_point::max() until the pipeline has finished
+    std::chrono::steady_clock::time_point GetFinishTimePoint() const noexcept { return m_FinishTimePoint.load(); }
+
+    // Logs the memory held by the index and the files, every update that has indexed files ends with it
+    static void LogMemoryStats(const FileSystem& fileSystem, const InvertedIndex& invertedIndex);
+
+private:
+    struct FileEntry
+    {
+        std::string Path{};
+        size_t      Size{ 0u };
+    };
+
+    struct FileEntryComparator
+    {
+        // Largest first, so that the huge files do not end up being read last
+        bool operator()(const FileEntry& lhs, const FileEntry& rhs) const noexcept
+        {
+            return lhs.Size < rhs.Size;
+        }
+    };
+
+    struct ReadFile
+    {
+        FileSystem::FileID FileID{ 0u };
+        std::string_view   Content{};
+        size_t             Size{ 0u };
+    };
+
+    // The terms of a file live in an arena of their own, released at once when the file has been merged
+    struct FileTerms
+    {
+        explicit FileTerms(size_t contentSize)
+            : Arena{ std::max<size_t>(contentSize, 1024u) }
+        {
+        }
+
+        std::pmr::monotonic_buffer_resource Arena;
+        std::pmr::vector<std::pmr::string>  Terms{ &Arena };
+    };
+
+    struct TokenizedFile
+    {
+        FileSystem::FileID         FileID{ 0u };
+        std::unique_ptr<FileTerms> Terms{};
+        size_t                     Size{ 0u };
+    };
+
+private:
+    void SpawnCrawler(std::filesystem::path directory);
+    void CrawlDirectory(const std::filesystem::path& directory);
+    void AddFiles(std::vector<FileEntry> files);
+
+    void SpawnWorkers(size_t filesCount);
+    void Work();
+
+    bool TryRead();
+    bool TryTokenize();
+    bool TryMerge();
+    size_t GetUnreadFilesCount();
+    void FinishFile(size_t size);
+    void TryFinish();
+
+private:
+    static constexpr size_t s_MaxQueuedFilesCount{ 256u };              // Per queue between two stages
+    static constexpr size_t s_MaxInFlightBytes{ 256u * 1024u * 1024u }; // Read but not yet merged, a larger file is still admitted alone
+
+private:
+    ThreadPool&    m_ThreadPool;
+    const uint8_t  m_TaskPriority{ 0u };
+    const uint32_t m_MaxWorkersCount{ 1u };
+
+    FileSystem&                 m_FileSystem;
+    InvertedIndex&              m_InvertedIndex;
+    const FileSystem::Partition m_Partition{};
+    ReplicationLog* const       m_ReplicationLog{ nullptr };
+
+    std::atomic<size_t>   m_PendingDirectoriesCount{ 0u };
+    std::atomic<size_t>   m_PendingFilesCount{ 0u };
+    std::atomic<uint32_t> m_ActiveWorkersCount{ 0u };
+    std::atomic<size_t>   m_InFlightBytes{ 0u };
+    std::atomic<size_t>   m_IndexedFilesCount{ 0u };
+    std::atomic<size_t>   m_DuplicateFilesCount{ 0u }; // Loaded but neither tokenized nor merged
+    std::atomic<size_t>   m_IndexedBytes{ 0u };
+    std::atomic<bool>     m_IsFinished{ false };
+
+    std::mutex                                                                  m_UnreadFilesLock{};
+    std::priority_queue<FileEntry, std::vector<FileEntry>, FileEntryComparator> m_UnreadFiles{};
+
+    std::mutex           m_ReadFilesLock{};
+    std::deque<ReadFile> m_ReadFiles{};
+
+    std::mutex                m_TokenizedFilesLock{};
+    std::deque<TokenizedFile> m_TokenizedFiles{};
+
+    std::chrono::steady_clock::time_point              m_StartTimePoint{};
+    std::atomic<std::chrono::steady_clock::time_point> m_FinishTimePoint{ std::chrono::steady_clock::time_point::max() };
+};
\ No newline at end of file
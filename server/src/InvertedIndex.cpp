@@ -1,90 +1,572 @@
 #include "InvertedIndex.h"
 
+#include "ScratchArena.h"
+#include "Tracer.h"
+
 void InvertedIndex::Add(FileSystem::FileID fileID, std::string_view content)
 {
-    std::vector<std::string> tokens{ Tokenize(content) };
+    AddTerms(fileID, ExtractTerms(content));
+}
 
-    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
-    std::sort(tokens.begin(), tokens.end());
+void InvertedIndex::AddTerms(FileSystem::FileID fileID, std::span<const std::pmr::string> terms)
+{
+    for (size_t i{ 0u }; i < terms.size();)
+    {
+        const size_t shardIndex{ GetShardIndex(terms[i]) };
+        IndexShard&  shard{ m_Shards[shardIndex] };
+
+        WriteLock _{ shard.ObjectLock };
+
+        for (; i < terms.size() && GetShardIndex(terms[i]) == shardIndex; ++i)
+        {
+            // Only a new term is copied into the index, most terms of a file are already there
+            auto it{ shard.Index.find(std::string_view{ terms[i] }) };
+            if (it == shard.Index.end())
+                it = shard.Index.try_emplace(terms[i]).first;
+
+            it->second.push_back(fileID);
+        }
+    }
+
+    m_PostingsCount += terms.size();
+    ++m_DocumentsCount;
+}
 
+void InvertedIndex::AddDuplicate(FileSystem::FileID canonicalFileID, FileSystem::FileID fileID)
+{
+    WriteLock _{ m_DuplicatesLock };
+
+    std::vector<FileSystem::FileID>& duplicates{ m_Duplicates[canonicalFileID] };
+    duplicates.insert(std::upper_bound(duplicates.begin(), duplicates.end(), fileID), fileID);
+
+    ++m_DuplicatesCount;
+}
+
+void InvertedIndex::PlaceShards(const Topology& topology)
+{
+    for (size_t i{ 0u }; i < m_Shards.size(); ++i)
     {
-        WriteLock _{ m_ObjectLock };
+        IndexShard& shard{ m_Shards[i] };
+
+        WriteLock _{ shard.ObjectLock };
+        ASSERT(shard.Index.empty(), "The shards have to be placed before the index is filled");
 
-        for (const auto& token : tokens)
-            m_Index[token].push_back(fileID);
+        shard.NodeMemory = std::make_unique<NodeMemoryResource>();
+        shard.NodeMemory->SetNode(static_cast<uint32_t>(i % topology.GetNodesCount()), topology.IsSimulated());
+        shard.Pool = std::make_unique<std::pmr::unsynchronized_pool_resource>(shard.NodeMemory.get());
+
+        // The resource of a container is fixed once it has been constructed, the empty index is constructed anew over the pool
+        std::destroy_at(&shard.Index);
+        std::construct_at(&shard.Index, shard.Pool.get());
     }
 }
 
-std::vector<FileSystem::FileID> InvertedIndex::Search(std::string_view query) const
+void InvertedIndex::CheckAnalyzerType(const IndexFile::Reader& reader) const
 {
-    std::vector<std::string> tokens{ Tokenize(query) };
+    // The terms of another analyzer would never be found
+    if (reader.GetAnalyzerType() != m_AnalyzerType)
+        throw std::runtime_error(std::format("The index has been built with the {0} analyzer, not with the {1} one", ANALYZER_NAMES[reader.GetAnalyzerType()], ANALYZER_NAMES[m_AnalyzerType]).c_str());
+}
 
-    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+size_t InvertedIndex::Load(IndexFile::Reader& reader)
+{
+    CheckAnalyzerType(reader);
+
+    std::string                     term{};
+    std::vector<FileSystem::FileID> fileIDs{};
+    size_t                          termsCount{ 0u };
+
+    while (reader.ReadTerm(term, fileIDs))
+    {
+        // The files written before the tokenizer dropped the tokens without letters post them under an empty term
+        if (term.empty())
+            continue;
+
+        IndexShard& shard{ m_Shards[GetShardIndex(term)] };
+
+        WriteLock _{ shard.ObjectLock };
+
+        auto it{ shard.Index.find(std::string_view{ term }) };
+        if (it == shard.Index.end())
+            it = shard.Index.try_emplace(std::pmr::string{ term, shard.Index.get_allocator() }).first;
+
+        PostingList& postingList{ it->second };
+        postingList.insert(postingList.end(), fileIDs.begin(), fileIDs.end());
+
+        m_PostingsCount += fileIDs.size();
+        ++termsCount;
+    }
 
-    std::unordered_map<FileSystem::FileID, uint32_t> filesOccurenceCount{};
+    FileSystem::FileID fileID{ 0u };
+    FileSystem::FileID canonicalFileID{ 0u };
+    size_t             duplicatesCount{ 0u };
 
+    while (reader.ReadDuplicate(fileID, canonicalFileID))
     {
-        ReadLock _{ m_ObjectLock };
+        AddDuplicate(canonicalFileID, fileID);
+        ++duplicatesCount;
+    }
+
+    m_DocumentsCount += reader.GetReadFilesCount() - duplicatesCount;
+
+    return termsCount;
+}
+
+void InvertedIndex::Clear()
+{
+    std::array<WriteLock, s_ShardsCount + 1u> shardsLock{};
+
+    for (size_t i{ 0u }; i < s_ShardsCount; ++i)
+        shardsLock[i] = WriteLock{ m_Shards[i].ObjectLock };
 
-        for (const auto& token : tokens)
+    shardsLock[s_ShardsCount] = WriteLock{ m_DuplicatesLock };
+
+    for (IndexShard& shard : m_Shards)
+    {
+        if (!shard.Pool)
         {
-            const auto it{ m_Index.find(token) };
+            shard.Index.clear();
+            continue;
+        }
+
+        // The pool of a placed shard would keep the blocks of the old posting lists, the empty index is constructed anew over it
+        std::destroy_at(&shard.Index);
+        shard.Pool->release();
+        std::construct_at(&shard.Index, shard.Pool.get());
+    }
+
+    m_Duplicates.clear();
+
+    m_PostingsCount = 0u;
+    m_DocumentsCount = 0u;
+    m_DuplicatesCount = 0u;
+}
+
+InvertedIndex::Stats InvertedIndex::GetStats() const
+{
+    Stats stats{ .PostingsCount = m_PostingsCount.load(), .DocumentsCount = m_DocumentsCount.load(), .DuplicatesCount = m_DuplicatesCount.load() };
+
+    for (const IndexShard& shard : m_Shards)
+    {
+        ReadLock _{ shard.ObjectLock };
+        stats.TermsCount += shard.Index.size();
+    }
 
-            if (it == m_Index.end())
+    return stats;
+}
+
+InvertedIndex::MemoryStats InvertedIndex::GetMemoryStats() const
+{
+    MemoryStats memoryStats{};
+
+    for (const IndexShard& shard : m_Shards)
+    {
+        ReadLock _{ shard.ObjectLock };
+
+        memoryStats.HashTables.AddHashTable(shard.Index);
+
+        for (const auto& [term, postingList] : shard.Index)
+        {
+            memoryStats.TermKeys.AddString(term);
+            memoryStats.PostingLists.AddVector(postingList);
+        }
+    }
+
+    ReadLock _{ m_DuplicatesLock };
+
+    memoryStats.HashTables.AddHashTable(m_Duplicates);
+
+    for (const auto& [fileID, duplicates] : m_Duplicates)
+        memoryStats.PostingLists.AddVector(duplicates);
+
+    return memoryStats;
+}
+
+size_t InvertedIndex::CompactPostingLists()
+{
+    size_t releasedBytes{ 0u };
+
+    for (IndexShard& shard : m_Shards)
+    {
+        WriteLock _{ shard.ObjectLock };
+
+        for (auto& [term, postingList] : shard.Index)
+        {
+            if (postingList.capacity() == postingList.size())
                 continue;
 
-            const std::vector<FileSystem::FileID>& fileIDs{ it->second };
+            MemoryUsage before{};
+            before.AddVector(postingList);
+
+            postingList.shrink_to_fit();
+
+            MemoryUsage after{};
+            after.AddVector(postingList);
+
+            releasedBytes += before.GetTotalBytes() - after.GetTotalBytes();
+        }
+    }
+
+    return releasedBytes;
+}
+
+InvertedIndex::SearchResult InvertedIndex::Search(std::string_view query, const SearchOptions& options, std::pmr::memory_resource* resource) const
+{
+    const ShardsReadLock _{ LockShardsForReading() };
+
+    return SearchUnlocked(query, options, resource);
+}
+
+InvertedIndex::BatchSearchResult InvertedIndex::SearchBatch(std::span<const std::string_view> queries, const SearchOptions& options) const
+{
+    BatchSearchResult batchResult{};
+    batchResult.ResultIndices.reserve(queries.size());
+
+    std::vector<std::string_view>                distinctQueries{};
+    std::unordered_map<std::string_view, size_t> distinctQueryIndices{};
+
+    for (const std::string_view query : queries)
+    {
+        const auto [it, isInserted]{ distinctQueryIndices.try_emplace(query, distinctQueries.size()) };
+        if (isInserted)
+            distinctQueries.push_back(query);
+
+        batchResult.ResultIndices.push_back(it->second);
+    }
+
+    batchResult.Results.resize(distinctQueries.size());
+
+    // The read locks are held by this thread for the whole batch, so the helping workers search the same snapshot without locking
+    const ShardsReadLock _{ LockShardsForReading() };
+
+    const auto searchDistinctQuery{ [this, &batchResult, &distinctQueries, &options](size_t i) {
+        batchResult.Results[i] = SearchUnlocked(distinctQueries[i], options, std::pmr::get_default_resource());
+    } };
+
+    if (m_ThreadPool)
+        m_ThreadPool->ParallelFor(m_TaskPriority, distinctQueries.size(), searchDistinctQuery);
+    else
+        for (size_t i{ 0u }; i < distinctQueries.size(); ++i)
+            searchDistinctQuery(i);
+
+    return batchResult;
+}
+
+InvertedIndex::SearchResult InvertedIndex::SearchUnlocked(std::string_view query, const SearchOptions& options, std::pmr::memory_resource* resource) const
+{
+    ScratchArena scratchArena{};
+
+    std::pmr::vector<std::pmr::string> tokens{ Tokenize(query, scratchArena.GetResource()) };
+
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    // The cost of a query is estimated by the total length of its posting lists
+    std::pmr::vector<const PostingList*> postingLists{ scratchArena.GetResource() };
+    size_t                               postingsCount{ 0u };
+
+    for (const auto& token : tokens)
+    {
+        const PostingList* postingList{ FindPostingList(token) };
+
+        if (!postingList)
+            continue;
+
+        postingLists.push_back(postingList);
+        postingsCount += postingList->size();
+    }
+
+    if (m_ThreadPool && m_ThreadPool->GetWorkersCount() > 0u && postingsCount >= s_ParallelSearchMinPostingsCount)
+        return SearchParallel(postingLists, postingsCount, options, resource);
+
+    std::pmr::unordered_map<FileSystem::FileID, uint32_t> filesOccurenceCount{ scratchArena.GetResource() };
+
+    const bool hasDeadline{ options.Deadline != std::chrono::steady_clock::time_point::max() };
+    bool       isPartial{ false };
 
-            for (const auto& fileID : fileIDs)
+    {
+        TRACE_SCOPE("InvertedIndex::TraversePostings");
+
+        for (const PostingList* postingList : postingLists)
+        {
+            const PostingList& fileIDs{ *postingList };
+
+            for (size_t i{ 0u }; i < fileIDs.size() && !isPartial; ++i)
             {
-                if (filesOccurenceCount.find(fileID) == filesOccurenceCount.end())
-                    filesOccurenceCount[fileID] = 1;
-                else
-                    ++filesOccurenceCount[fileID];
+                if (hasDeadline && i % s_DeadlineCheckInterval == 0u)
+                    isPartial = std::chrono::steady_clock::now() >= options.Deadline;
+
+                ++filesOccurenceCount[fileIDs[i]];
             }
+
+            if (isPartial)
+                break;
         }
     }
 
-    std::vector<std::pair<FileSystem::FileID, uint32_t>> filesOccurenceCountVector{ filesOccurenceCount.begin(), filesOccurenceCount.end() };
-    std::sort(filesOccurenceCountVector.begin(), filesOccurenceCountVector.end(), [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+    const size_t topCount{ GetTopCount(options) };
 
-    std::vector<FileSystem::FileID> result{};
-    result.reserve(filesOccurenceCountVector.size());
+    RankedFiles topFiles{ scratchArena.GetResource() };
+    topFiles.reserve(std::min(topCount, filesOccurenceCount.size()));
 
-    for (const auto& [fileID, _] : filesOccurenceCountVector)
-        result.push_back(fileID);
+    {
+        TRACE_SCOPE("InvertedIndex::SelectTopFiles");
 
-    return result;
+        for (const auto& rankedFile : filesOccurenceCount)
+            PushTopFile(topFiles, rankedFile, topCount);
+    }
+
+    size_t totalHitsCount{ filesOccurenceCount.size() };
+    if (!m_Duplicates.empty())
+    {
+        for (const auto& [fileID, _] : filesOccurenceCount)
+            totalHitsCount += FindDuplicates(fileID).size();
+    }
+
+    return MakeSearchResult(topFiles, totalHitsCount, isPartial, options, resource);
 }
 
-std::vector<std::string> InvertedIndex::Tokenize(std::string_view content)
+InvertedIndex::SearchResult InvertedIndex::SearchParallel(std::span<const PostingList* const> postingLists, size_t postingsCount, const SearchOptions& options, std::pmr::memory_resource* resource) const
 {
-    std::vector<std::string> tokens{};
-    tokens.reserve(std::count_if(content.begin(), content.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }) + 1u);
+    // The doc-ID space is split into ranges by the high bits of the FileIDs, which are path hashes and so spread evenly over them
+    const size_t rangesCount{ std::bit_floor(std::clamp<size_t>(postingsCount / s_ParallelSearchMinRangePostingsCount, 2u, m_ThreadPool->GetWorkersCount() + 1u)) };
+    const int    rangeShift{ std::numeric_limits<FileSystem::FileID>::digits - std::countr_zero(rangesCount) };
+    const size_t slicesCount{ rangesCount };
 
-    for (size_t i{ 0u }, j{ 0u }; j < content.size(); ++j)
-    {
-        if (std::isspace(static_cast<unsigned char>(content[j])))
+    const bool        hasDeadline{ options.Deadline != std::chrono::steady_clock::time_point::max() };
+    std::atomic<bool> isPartial{ false };
+
+    // Phase 1
+    // Every slice of the concatenated posting lists is scattered into per-range buckets, bucket [slice * rangesCount + range]
+    std::vector<std::vector<FileSystem::FileID>> buckets(slicesCount * rangesCount);
+
+    m_ThreadPool->ParallelFor(m_TaskPriority, slicesCount, [&](size_t slice) {
+        TRACE_SCOPE("InvertedIndex::ScatterPostings");
+
+        const size_t sliceBegin{ postingsCount * slice / slicesCount };
+        const size_t sliceEnd{ postingsCount * (slice + 1u) / slicesCount };
+
+        const size_t sliceLength{ sliceEnd - sliceBegin };
+
+        // Slack for the uneven spread of the FileIDs over the ranges
+        for (size_t range{ 0u }; range < rangesCount; ++range)
+            buckets[slice * rangesCount + range].reserve(sliceLength / rangesCount + sliceLength / rangesCount / 8u);
+
+        size_t listBegin{ 0u };
+        for (const PostingList* postingList : postingLists)
         {
-            if (j > i)
-                tokens.push_back(Normalize(content.substr(i, j - i)));
+            const size_t listEnd{ listBegin + postingList->size() };
 
-            i = j + 1;
+            if (listEnd > sliceBegin && listBegin < sliceEnd)
+            {
+                const size_t begin{ std::max(sliceBegin, listBegin) - listBegin };
+                const size_t end{ std::min(sliceEnd, listEnd) - listBegin };
+
+                for (size_t i{ begin }; i < end; ++i)
+                {
+                    if (hasDeadline && (i - begin) % s_DeadlineCheckInterval == 0u && std::chrono::steady_clock::now() >= options.Deadline)
+                    {
+                        isPartial.store(true);
+                        return;
+                    }
+
+                    const FileSystem::FileID fileID{ (*postingList)[i] };
+                    buckets[slice * rangesCount + (fileID >> rangeShift)].push_back(fileID);
+                }
+            }
+
+            listBegin = listEnd;
+        }
+    });
+
+    // Phase 2
+    // Every range counts the occurences of its own files and keeps its local top-k
+    const size_t topCount{ GetTopCount(options) };
+
+    // Filled in by the workers, so allocated from the default resource rather than from an arena of this thread
+    std::vector<RankedFiles> rangesTopFiles(rangesCount);
+    std::vector<size_t>      rangesHitsCounts(rangesCount, 0u);
+
+    m_ThreadPool->ParallelFor(m_TaskPriority, rangesCount, [&](size_t range) {
+        TRACE_SCOPE("InvertedIndex::CountRange");
+
+        size_t rangePostingsCount{ 0u };
+        for (size_t slice{ 0u }; slice < slicesCount; ++slice)
+            rangePostingsCount += buckets[slice * rangesCount + range].size();
+
+        std::unordered_map<FileSystem::FileID, uint32_t> filesOccurenceCount{};
+        filesOccurenceCount.reserve(rangePostingsCount);
+
+        for (size_t slice{ 0u }; slice < slicesCount; ++slice)
+        {
+            for (const FileSystem::FileID fileID : buckets[slice * rangesCount + range])
+                ++filesOccurenceCount[fileID];
+
+            std::vector<FileSystem::FileID>{}.swap(buckets[slice * rangesCount + range]);
         }
+
+        rangesHitsCounts[range] = filesOccurenceCount.size();
+        if (!m_Duplicates.empty())
+        {
+            for (const auto& [fileID, _] : filesOccurenceCount)
+                rangesHitsCounts[range] += FindDuplicates(fileID).size();
+        }
+
+        RankedFiles& topFiles{ rangesTopFiles[range] };
+        topFiles.reserve(std::min(topCount, filesOccurenceCount.size()));
+
+        for (const auto& rankedFile : filesOccurenceCount)
+            PushTopFile(topFiles, rankedFile, topCount);
+    });
+
+    // The ranges hold disjoint sets of files, so the global top-k is the top-k of the local ones
+    RankedFiles topFiles{};
+    size_t      totalHitsCount{ 0u };
+
+    for (size_t range{ 0u }; range < rangesCount; ++range)
+    {
+        totalHitsCount += rangesHitsCounts[range];
+
+        for (const RankedFile& rankedFile : rangesTopFiles[range])
+            PushTopFile(topFiles, rankedFile, topCount);
     }
 
-    if (content.size() > 0 && !std::isspace(static_cast<unsigned char>(content.back())))
-        tokens.push_back(Normalize(content.substr(content.find_last_of(' ') + 1u)));
+    return MakeSearchResult(topFiles, totalHitsCount, isPartial.load(), options, resource);
+}
+
+InvertedIndex::ShardsReadLock InvertedIndex::LockShardsForReading() const
+{
+    ShardsReadLock shardsLock{};
+
+    for (size_t i{ 0u }; i < s_ShardsCount; ++i)
+        shardsLock[i] = ReadLock{ m_Shards[i].ObjectLock };
 
-    return tokens;
+    shardsLock[s_ShardsCount] = ReadLock{ m_DuplicatesLock };
+
+    return shardsLock;
+}
+
+const InvertedIndex::PostingList* InvertedIndex::FindPostingList(std::string_view term) const
+{
+    const IndexShard& shard{ m_Shards[GetShardIndex(term)] };
+
+    const auto it{ shard.Index.find(term) };
+    return it != shard.Index.end() ? &it->second : nullptr;
+}
+
+std::span<const FileSystem::FileID> InvertedIndex::FindDuplicates(FileSystem::FileID fileID) const
+{
+    const auto it{ m_Duplicates.find(fileID) };
+    return it != m_Duplicates.end() ? std::span<const FileSystem::FileID>{ it->second } : std::span<const FileSystem::FileID>{};
 }
 
-std::string InvertedIndex::Normalize(const std::string_view token)
+size_t InvertedIndex::GetShardIndex(std::string_view term) noexcept
 {
-    std::string normalizedToken{ token };
+    return std::hash<std::string_view>{}(term) % s_ShardsCount;
+}
 
-    std::erase_if(normalizedToken, [](char c) { return !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')); });
-    std::transform(normalizedToken.begin(), normalizedToken.end(), normalizedToken.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+bool InvertedIndex::RanksHigher(const RankedFile& lhs, const RankedFile& rhs) noexcept
+{
+    // Files with more matching tokens come first, ties are broken by the FileID so that pages are stable between requests
+    return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first;
+}
 
-    return normalizedToken;
+size_t InvertedIndex::GetTopCount(const SearchOptions& options) noexcept
+{
+    return options.Limit > std::numeric_limits<size_t>::max() - options.Offset ? std::numeric_limits<size_t>::max() : options.Offset + options.Limit;
 }
+
+void InvertedIndex::PushTopFile(RankedFiles& topFiles, const RankedFile& rankedFile, size_t topCount)
+{
+    // Partial top-k selection: only the best topCount files are kept in a heap whose top is the worst ranked one
+    if (topFiles.size() < topCount)
+    {
+        topFiles.push_back(rankedFile);
+        std::push_heap(topFiles.begin(), topFiles.end(), RanksHigher);
+    }
+    else if (topCount > 0u && RanksHigher(rankedFile, topFiles.front()))
+    {
+        std::pop_heap(topFiles.begin(), topFiles.end(), RanksHigher);
+        topFiles.back() = rankedFile;
+        std::push_heap(topFiles.begin(), topFiles.end(), RanksHigher);
+    }
+}
+
+InvertedIndex::SearchResult InvertedIndex::MakeSearchResult(RankedFiles& topFiles, size_t totalHitsCount, bool isPartial, const SearchOptions& options, std::pmr::memory_resource* resource) const
+{
+    SearchResult result{ .FileIDs = std::pmr::vector<FileSystem::FileID>{ resource }, .Scores = std::pmr::vector<uint32_t>{ resource } };
+    result.TotalHitsCount = totalHitsCount;
+    result.IsPartial = isPartial;
+
+    // Every file stands for at least one entry of the expanded ranking, so the top Offset + Limit files always cover the page.
+    // Only without duplicates can an offset past the top files be told to leave the page empty
+    if (options.Offset >= topFiles.size() && m_Duplicates.empty())
+        return result;
+
+    {
+        TRACE_SCOPE("InvertedIndex::SortTopFiles");
+        std::sort_heap(topFiles.begin(), topFiles.end(), RanksHigher);
+    }
+
+    result.FileIDs.reserve(std::min(topFiles.size() - std::min(options.Offset, topFiles.size()), options.Limit));
+    if (options.WithScores)
+        result.Scores.reserve(result.FileIDs.capacity());
+
+    size_t     rank{ 0u };
+    const auto appendFile{ [&result, &rank, &options](FileSystem::FileID fileID, uint32_t score) {
+        if (rank++ < options.Offset || result.FileIDs.size() >= options.Limit)
+            return;
+
+        result.FileIDs.push_back(fileID);
+        if (options.WithScores)
+            result.Scores.push_back(score);
+    } };
+
+    for (const auto& [fileID, score] : topFiles)
+    {
+        if (result.FileIDs.size() >= options.Limit)
+            break;
+
+        appendFile(fileID, score);
+
+        for (const FileSystem::FileID duplicateFileID : FindDuplicates(fileID))
+            appendFile(duplicateFileID, score);
+    }
+
+    return result;
+}
+
+std::pmr::vector<std::pmr::string> InvertedIndex::ExtractTerms(std::string_view content, std::pmr::memory_resource* resource) const
+{
+    std::pmr::vector<std::pmr::string> tokens{ Tokenize(content, resource) };
+
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    // Counting sort of the distinct terms by their shard
+    ScratchArena scratchArena{};
+
+    std::pmr::vector<size_t>               shardIndices(tokens.size(), scratchArena.GetResource());
+    std::array<size_t, s_ShardsCount + 1u> shardOffsets{};
+
+    for (size_t i{ 0u }; i < tokens.size(); ++i)
+    {
+        shardIndices[i] = GetShardIndex(tokens[i]);
+        ++shardOffsets[shardIndices[i] + 1u];
+    }
+
+    std::partial_sum(shardOffsets.begin(), shardOffsets.end(), shardOffsets.begin());
+
+    std::pmr::vector<std::pmr::string> terms(tokens.size(), resource);
+    for (size_t i{ 0u }; i < tokens.size(); ++i)
+        terms[shardOffsets[shardIndices[i]]++] = std::move(tokens[i]);
+
+    return terms;
+}
+
+std::pmr::vector<std::pmr::string> InvertedIndex::Tokenize(std::string_view content, std::pmr::memory_resource* resource) const
+{
+    TRACE_SCOPE("InvertedIndex::Tokenize");
+
+    return VisitAnalyzer(m_AnalyzerType, [&](auto analyzer) { return analyzer.Tokenize(content, resource); });
+}
\ No newline at end of file
@@ -1,7 +1,20 @@
 #pragma once
+#include "Analyzer.h"
 #include "FileSystem.h"
+#include "IndexFile.h"
+#include "MemoryUsage.h"
+#include "ThreadPool.h"
+#include "Topology.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <shared_mutex>
+#include <span>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -13,17 +26,191 @@ public:
     using ReadLock = std::shared_lock<ReadWriteLock>;
     using WriteLock = std::unique_lock<ReadWriteLock>;
 
+public:
+    struct SearchOptions
+    {
+        size_t Offset{ 0u };
+        size_t Limit{ std::numeric_limits<size_t>::max() };
+
+        // The posting traversal stops once the deadline has passed, the result is then built from the postings seen so far
+        std::chrono::steady_clock::time_point Deadline{ std::chrono::steady_clock::time_point::max() };
+
+        bool WithScores{ false }; // Fills SearchResult::Scores in, e.g. for a coordinator that merges the results of several servers
+    };
+
+    struct SearchResult
+    {
+        std::pmr::vector<FileSystem::FileID> FileIDs{}; // Ranked page [Offset, Offset + Limit) of the matching files, duplicates included
+        std::pmr::vector<uint32_t>           Scores{};  // Number of the matching terms of every file of the page, if asked for
+        std::pmr::vector<std::pmr::string>   Paths{};   // Paths of the files of the page, only filled in by a coordinator, whose files are not registered locally
+        size_t                               TotalHitsCount{ 0u };
+        bool                                 IsPartial{ false }; // The deadline has been reached before all postings were traversed
+    };
+
+    struct Stats
+    {
+        size_t TermsCount{ 0u };
+        size_t PostingsCount{ 0u };
+        size_t DocumentsCount{ 0u };
+        size_t DuplicatesCount{ 0u }; // Files that share the postings of a document with the same content
+    };
+
+    struct MemoryStats
+    {
+        MemoryUsage TermKeys{};
+        MemoryUsage PostingLists{};
+        MemoryUsage HashTables{}; // Nodes and buckets of the shard indices
+
+        size_t GetTotalBytes() const noexcept { return TermKeys.GetTotalBytes() + PostingLists.GetTotalBytes() + HashTables.GetTotalBytes(); }
+    };
+
+    struct BatchSearchResult
+    {
+        std::vector<SearchResult> Results{};       // One result per distinct query of the batch
+        std::vector<size_t>       ResultIndices{}; // Index into Results for every query of the batch, in order
+    };
+
+public:
+    // Batches and expensive queries are spread over the pool's workers, tasks are submitted with the given priority.
+    // The contents and the queries are both turned into terms by the analyzer of the given type
+    explicit InvertedIndex(ThreadPool* threadPool = nullptr, uint8_t taskPriority = 0u, AnalyzerType analyzerType = ANALYZER_TYPE_STANDARD) noexcept
+        : m_ThreadPool{ threadPool }
+        , m_TaskPriority{ taskPriority }
+        , m_AnalyzerType{ analyzerType }
+    {
+    }
+
 public:
     void Add(FileSystem::FileID fileID, std::string_view content);
 
-    std::vector<FileSystem::FileID> Search(std::string_view query) const;
+    // Merges terms produced by ExtractTerms(), only one shard is locked at a time
+    void AddTerms(FileSystem::FileID fileID, std::span<const std::pmr::string> terms);
+
+    // A file whose content is identical to that of an indexed file is not indexed itself, it is listed in the results right
+    // after the canonical file with the same score and counts as a hit of its own
+    void AddDuplicate(FileSystem::FileID canonicalFileID, FileSystem::FileID fileID);
+
+    // Binds the memory of every shard to a NUMA node, the shards are spread over the nodes in turn so that no single node
+    // serves all the posting traversals. Has to be called while the index is still empty. The shards that are not placed
+    // allocate from the default resource like the rest of the process
+    void PlaceShards(const Topology& topology);
+
+    // Throws if the index of the reader has been built with another analyzer. Called before the files of the reader are
+    // registered, so that an index that cannot be loaded leaves no files without postings behind
+    void CheckAnalyzerType(const IndexFile::Reader& reader) const;
+
+    // Appends the posting lists and the duplicates of a prebuilt index, returns the number of terms read. Only the postings
+    // of the partition the reader has been opened for are read. Throws if the index has been built with another analyzer
+    size_t Load(IndexFile::Reader& reader);
+
+    // Drops every posting list and duplicate, e.g. for a replica that reloads the index of its primary. All the locks are
+    // taken in the order of the searches, so a search sees the index either whole or empty
+    void Clear();
+
+    // The shards are counted one after another, so the counts may be off by the files merged meanwhile
+    Stats GetStats() const;
+
+    // Walks every posting list, one shard at a time. The overhead is estimated after the Windows heap, which the placed
+    // shards do not use: their pools hand out blocks without headers out of whole pages, so it is only an approximation there
+    MemoryStats GetMemoryStats() const;
+
+    // Trims the slack capacity the posting lists have grown while files were merged, returns the number of bytes released
+    // to the allocators of the shards.
+    // Every shard is write-locked in turn, so the searches and merges of that shard wait for its posting lists to be copied
+    size_t CompactPostingLists();
+
+    // The result is allocated from the given resource, e.g. the scratch arena of the request. The scratch memory of the
+    // search itself comes from an arena of the calling thread, so a serial search makes no global heap allocation
+    SearchResult Search(std::string_view query, const SearchOptions& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    // Deduplicates the queries and runs the distinct ones in parallel against a single snapshot of the index.
+    // The results are filled in by several threads, so they are always allocated from the default resource
+    BatchSearchResult SearchBatch(std::span<const std::string_view> queries, const SearchOptions& options) const;
+
+    // Distinct terms of the content, grouped by shard so that AddTerms() visits every shard once
+    std::pmr::vector<std::pmr::string> ExtractTerms(std::string_view content, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    // The terms of the content in order, duplicates included
+    std::pmr::vector<std::pmr::string> Tokenize(std::string_view content, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    AnalyzerType GetAnalyzerType() const noexcept { return m_AnalyzerType; }
+
+    // A file and its score, the number of the query terms it holds
+    using RankedFile = std::pair<FileSystem::FileID, uint32_t>;
+
+    // The coordinator of a cluster ranks the files of its shards the same way, so that its pages match those of a single server
+    static bool RanksHigher(const RankedFile& lhs, const RankedFile& rhs) noexcept;
+
+private:
+    using PostingList = std::pmr::vector<FileSystem::FileID>;
+    using RankedFiles = std::pmr::vector<RankedFile>;
+
+    // Lets the terms be looked up by std::string_view, without building a std::string for every lookup
+    struct TermHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view term) const noexcept { return std::hash<std::string_view>{}(term); }
+    };
+
+    using TermIndex = std::pmr::unordered_map<std::pmr::string, PostingList, TermHash, std::equal_to<>>;
+
+    // The terms are spread over shards by their hash, so that files can be merged into different shards concurrently.
+    // The terms and the posting lists of a shard come from the default resource, or from a pool of the pages of its NUMA
+    // node once PlaceShards() has placed it, always under the write lock of the shard
+    struct IndexShard
+    {
+        mutable ReadWriteLock ObjectLock{};
+
+        std::unique_ptr<NodeMemoryResource>                     NodeMemory{}; // Only for a placed shard
+        std::unique_ptr<std::pmr::unsynchronized_pool_resource> Pool{};       // Only for a placed shard
+        TermIndex                                               Index{};
+    };
+
+    static constexpr size_t s_ShardsCount{ 16u };
+
+    // The read locks of all the shards, then that of the duplicates
+    using ShardsReadLock = std::array<ReadLock, s_ShardsCount + 1u>;
 
 private:
-    static std::vector<std::string> Tokenize(std::string_view content);
-    static std::string              Normalize(const std::string_view token);
+    SearchResult SearchUnlocked(std::string_view query, const SearchOptions& options, std::pmr::memory_resource* resource) const;
+
+    // Splits the doc-ID space into ranges that are counted and ranked in parallel, then merges their partial top-k results
+    SearchResult SearchParallel(std::span<const PostingList* const> postingLists, size_t postingsCount, const SearchOptions& options, std::pmr::memory_resource* resource) const;
+
+    // A consistent snapshot for searching: writers only ever hold one shard lock or the duplicates lock, so taking them all
+    // in order cannot deadlock
+    ShardsReadLock LockShardsForReading() const;
+
+    const PostingList*                   FindPostingList(std::string_view term) const;
+    std::span<const FileSystem::FileID> FindDuplicates(FileSystem::FileID fileID) const;
+
+    static size_t       GetShardIndex(std::string_view term) noexcept;
+    static size_t       GetTopCount(const SearchOptions& options) noexcept;
+    static void         PushTopFile(RankedFiles& topFiles, const RankedFile& rankedFile, size_t topCount);
+
+    // Every file of the page is followed by its duplicates, so that the page is cut out of the expanded ranking
+    SearchResult MakeSearchResult(RankedFiles& topFiles, size_t totalHitsCount, bool isPartial, const SearchOptions& options, std::pmr::memory_resource* resource) const;
 
 private:
-    mutable ReadWriteLock m_ObjectLock{};
+    static constexpr size_t s_DeadlineCheckInterval{ 4096u }; // Postings traversed between two deadline checks
+
+    // Queries with fewer postings are not worth splitting, each parallel range gets at least s_ParallelSearchMinRangePostingsCount
+    static constexpr size_t s_ParallelSearchMinPostingsCount{ 256u * 1024u };
+    static constexpr size_t s_ParallelSearchMinRangePostingsCount{ 64u * 1024u };
+
+private:
+    ThreadPool* const  m_ThreadPool{ nullptr };
+    const uint8_t      m_TaskPriority{ 0u };
+    const AnalyzerType m_AnalyzerType{ ANALYZER_TYPE_STANDARD };
+
+    std::array<IndexShard, s_ShardsCount> m_Shards{};
+
+    // Canonical FileID -> the FileIDs of its duplicates in ascending order
+    mutable ReadWriteLock                                                   m_DuplicatesLock{};
+    std::unordered_map<FileSystem::FileID, std::vector<FileSystem::FileID>> m_Duplicates{};
 
-    std::unordered_map<std::string, std::vector<FileSystem::FileID>> m_Index;
+    std::atomic<size_t> m_PostingsCount{ 0u };
+    std::atomic<size_t> m_DocumentsCount{ 0u };
+    std::atomic<size_t> m_DuplicatesCount{ 0u };
 };
\ No newline at end of file
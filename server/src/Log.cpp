@@ -1,9 +1,15 @@
 #include "Log.h"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
-void Log::Init()
+void Log::Init(const std::string& loggerName)
 {
+    // A single background thread writes to the console. When it falls behind, the oldest queued messages are dropped
+    // rather than blocking the threads that log
+    if (!spdlog::thread_pool())
+        spdlog::init_thread_pool(s_QueueSize, 1u);
+
     spdlog::set_pattern("%^[%T] [%t] %n: %v%$");
 
 #ifdef DEBUG
@@ -12,13 +18,43 @@ void Log::Init()
     spdlog::set_level(spdlog::level::info);
 #endif
 
-    s_Logger = spdlog::stdout_color_mt("SERVER");
+    s_Logger = std::make_shared<spdlog::async_logger>(loggerName, std::make_shared<spdlog::sinks::stdout_color_sink_mt>(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    spdlog::initialize_logger(s_Logger);
+}
+
+void Log::Shutdown()
+{
+    // Every thread that logs must have stopped, spdlog::shutdown() waits for the queued messages to be written
+    s_Logger.reset();
+    spdlog::shutdown();
 }
 
 void Log::PrintAssertMessage(std::string_view prefix)
 {
-    auto logger{ Log::GetLogger() };
-    logger->error("{0}", prefix);
+    s_Logger->error("{0}", prefix);
+    s_Logger->flush();
 
     MessageBoxA(nullptr, "No message :/", "Assert", MB_OK | MB_ICONERROR);
 }
+
+bool Log::Throttle::ShouldLog(uint64_t& suppressedCount) noexcept
+{
+    const int64_t currentTimeNS{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() };
+    int64_t       nextMessageTimeNS{ m_NextMessageTimeNS.load(std::memory_order_relaxed) };
+
+    // Of the threads that reach the end of the interval together, only the one that moves it forward logs
+    if (currentTimeNS < nextMessageTimeNS || !m_NextMessageTimeNS.compare_exchange_strong(nextMessageTimeNS, currentTimeNS + m_IntervalNS, std::memory_order_relaxed))
+    {
+        m_SuppressedCount.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressedCount = m_SuppressedCount.exchange(0u, std::memory_order_relaxed);
+    return true;
+}
+
+std::string& Log::GetThreadBuffer()
+{
+    thread_local std::string t_Buffer{};
+    return t_Buffer;
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <spdlog/spdlog.h>
 
+#include <atomic>
+#include <chrono>
 #include <string_view>
 
 #ifndef NOMINMAX
@@ -9,77 +11,177 @@
 
 #include <Windows.h>
 
+// Messages below LOG_ACTIVE_LEVEL are removed at compile time, their arguments are not even evaluated.
+// Debug builds keep everything, the others keep INFO and above, a build can override it with -DLOG_ACTIVE_LEVEL=N.
+#define LOG_LEVEL_TRACE    0
+#define LOG_LEVEL_DEBUG    1
+#define LOG_LEVEL_INFO     2
+#define LOG_LEVEL_WARN     3
+#define LOG_LEVEL_ERROR    4
+#define LOG_LEVEL_CRITICAL 5
+
+#ifndef LOG_ACTIVE_LEVEL
+    #ifdef DEBUG
+        #define LOG_ACTIVE_LEVEL LOG_LEVEL_TRACE
+    #else
+        #define LOG_ACTIVE_LEVEL LOG_LEVEL_INFO
+    #endif
+#endif
+
 class Log
 {
 public:
     enum class Level
     {
-        Trace = 0,
-        Debug,
-        Info,
-        Warn,
-        Error,
-        Critical,
+        Trace = LOG_LEVEL_TRACE,
+        Debug = LOG_LEVEL_DEBUG,
+        Info = LOG_LEVEL_INFO,
+        Warn = LOG_LEVEL_WARN,
+        Error = LOG_LEVEL_ERROR,
+        Critical = LOG_LEVEL_CRITICAL,
+    };
+
+    // Per call site state of the throttled macros: lets at most one message through every interval
+    class Throttle
+    {
+    public:
+        explicit Throttle(std::chrono::milliseconds interval) noexcept
+            : m_IntervalNS{ std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count() }
+        {
+        }
+
+    public:
+        // When it returns true, `suppressedCount` is the number of messages dropped since the previous one
+        bool ShouldLog(uint64_t& suppressedCount) noexcept;
+
+    private:
+        const int64_t         m_IntervalNS;
+        std::atomic<int64_t>  m_NextMessageTimeNS{ 0 };
+        std::atomic<uint64_t> m_SuppressedCount{ 0u };
     };
 
 public:
-    static void                            Init();
-    static std::shared_ptr<spdlog::logger> GetLogger() { return s_Logger; }
+    // Messages are formatted on the calling thread and written by a background one, Shutdown() writes the queued ones
+    static void Init(const std::string& loggerName = "SERVER");
+    static void Shutdown();
+
+    static const std::shared_ptr<spdlog::logger>& GetLogger() { return s_Logger; }
 
     template <typename... Args>
     static void PrintMessageWithTag(Log::Level level, std::string_view tag, std::format_string<Args...> format, Args&&... args);
 
+    template <typename... Args>
+    static void PrintThrottledMessageWithTag(Log::Level level, std::string_view tag, uint64_t suppressedCount, std::format_string<Args...> format, Args&&... args);
+
     template <typename... Args>
     static void PrintAssertMessage(std::string_view prefix, std::format_string<Args...> message, Args&&... args);
 
     static void PrintAssertMessage(std::string_view prefix);
 
 private:
+    static bool         ShouldLog(Log::Level level) { return s_Logger && s_Logger->should_log(static_cast<spdlog::level::level_enum>(level)); }
+    static std::string& GetThreadBuffer();
+
+private:
+    static constexpr size_t s_QueueSize{ 8192u }; // Messages, preallocated by spdlog
+
     inline static std::shared_ptr<spdlog::logger> s_Logger{ nullptr };
 };
 
 template <typename... Args>
 void Log::PrintMessageWithTag(Log::Level level, std::string_view tag, std::format_string<Args...> format, Args&&... args)
 {
-    auto        logger{ GetLogger() };
-    std::string formatted{ std::format(format, std::forward<Args>(args)...) };
+    if (!ShouldLog(level))
+        return;
 
-    switch (level)
-    {
-        case Log::Level::Trace:
-            logger->trace("[{0}] {1}", tag, formatted);
-            break;
-        case Log::Level::Debug:
-            logger->debug("[{0}] {1}", tag, formatted);
-            break;
-        case Log::Level::Info:
-            logger->info("[{0}] {1}", tag, formatted);
-            break;
-        case Log::Level::Warn:
-            logger->warn("[{0}] {1}", tag, formatted);
-            break;
-        case Log::Level::Error:
-            logger->error("[{0}] {1}", tag, formatted);
-            break;
-        case Log::Level::Critical:
-            logger->critical("[{0}] {1}", tag, formatted);
-            break;
-    }
+    // Formatted once into a buffer of the thread, spdlog only copies the result into its queue
+    std::string& message{ GetThreadBuffer() };
+    message.clear();
+
+    std::format_to(std::back_inserter(message), "[{0}] ", tag);
+    std::format_to(std::back_inserter(message), format, std::forward<Args>(args)...);
+
+    s_Logger->log(static_cast<spdlog::level::level_enum>(level), std::string_view{ message });
+}
+
+template <typename... Args>
+void Log::PrintThrottledMessageWithTag(Log::Level level, std::string_view tag, uint64_t suppressedCount, std::format_string<Args...> format, Args&&... args)
+{
+    if (!ShouldLog(level))
+        return;
+
+    std::string& message{ GetThreadBuffer() };
+    message.clear();
+
+    std::format_to(std::back_inserter(message), "[{0}] ", tag);
+    std::format_to(std::back_inserter(message), format, std::forward<Args>(args)...);
+
+    if (suppressedCount > 0u)
+        std::format_to(std::back_inserter(message), " ({0} similar messages suppressed)", suppressedCount);
+
+    s_Logger->log(static_cast<spdlog::level::level_enum>(level), std::string_view{ message });
 }
 
 template <typename... Args>
 void Log::PrintAssertMessage(std::string_view prefix, std::format_string<Args...> message, Args&&... args)
 {
-    auto        logger{ Log::GetLogger() };
-    std::string formatted{ std::format(message, std::forward<Args>(args)...) };
-    logger->error("{0}: {1}", prefix, formatted);
+    const std::string formatted{ std::format(message, std::forward<Args>(args)...) };
+
+    // The message must be out before the debugger breaks in
+    s_Logger->error("{0}: {1}", prefix, formatted);
+    s_Logger->flush();
 
     MessageBoxA(nullptr, formatted.c_str(), "Assert", MB_OK | MB_ICONERROR);
 }
 
-#define LOG_TRACE_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Trace, tag, __VA_ARGS__)
-#define LOG_DEBUG_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Debug, tag, __VA_ARGS__)
-#define LOG_INFO_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Info, tag, __VA_ARGS__)
-#define LOG_WARN_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Warn, tag, __VA_ARGS__)
-#define LOG_ERROR_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Error, tag, __VA_ARGS__)
+#define LOG_TAG_THROTTLED(level, tag, intervalMS, ...)                                                             \
+    do                                                                                                             \
+    {                                                                                                              \
+        static ::Log::Throttle s_LogThrottle{ std::chrono::milliseconds{ intervalMS } };                           \
+        uint64_t               logSuppressedCount{ 0u };                                                           \
+        if (s_LogThrottle.ShouldLog(logSuppressedCount))                                                           \
+            ::Log::PrintThrottledMessageWithTag(level, tag, logSuppressedCount, __VA_ARGS__);                      \
+    } while (false)
+
+// The _THROTTLED variants are meant for messages that a misbehaving client or an overload can trigger at a high rate
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_TRACE
+    #define LOG_TRACE_TAG(tag, ...)                       ::Log::PrintMessageWithTag(::Log::Level::Trace, tag, __VA_ARGS__)
+    #define LOG_TRACE_TAG_THROTTLED(tag, intervalMS, ...) LOG_TAG_THROTTLED(::Log::Level::Trace, tag, intervalMS, __VA_ARGS__)
+#else
+    #define LOG_TRACE_TAG(tag, ...)                       ((void)0)
+    #define LOG_TRACE_TAG_THROTTLED(tag, intervalMS, ...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_DEBUG
+    #define LOG_DEBUG_TAG(tag, ...)                       ::Log::PrintMessageWithTag(::Log::Level::Debug, tag, __VA_ARGS__)
+    #define LOG_DEBUG_TAG_THROTTLED(tag, intervalMS, ...) LOG_TAG_THROTTLED(::Log::Level::Debug, tag, intervalMS, __VA_ARGS__)
+#else
+    #define LOG_DEBUG_TAG(tag, ...)                       ((void)0)
+    #define LOG_DEBUG_TAG_THROTTLED(tag, intervalMS, ...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_INFO
+    #define LOG_INFO_TAG(tag, ...)                       ::Log::PrintMessageWithTag(::Log::Level::Info, tag, __VA_ARGS__)
+    #define LOG_INFO_TAG_THROTTLED(tag, intervalMS, ...) LOG_TAG_THROTTLED(::Log::Level::Info, tag, intervalMS, __VA_ARGS__)
+#else
+    #define LOG_INFO_TAG(tag, ...)                       ((void)0)
+    #define LOG_INFO_TAG_THROTTLED(tag, intervalMS, ...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_WARN
+    #define LOG_WARN_TAG(tag, ...)                       ::Log::PrintMessageWithTag(::Log::Level::Warn, tag, __VA_ARGS__)
+    #define LOG_WARN_TAG_THROTTLED(tag, intervalMS, ...) LOG_TAG_THROTTLED(::Log::Level::Warn, tag, intervalMS, __VA_ARGS__)
+#else
+    #define LOG_WARN_TAG(tag, ...)                       ((void)0)
+    #define LOG_WARN_TAG_THROTTLED(tag, intervalMS, ...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= LOG_LEVEL_ERROR
+    #define LOG_ERROR_TAG(tag, ...)                       ::Log::PrintMessageWithTag(::Log::Level::Error, tag, __VA_ARGS__)
+    #define LOG_ERROR_TAG_THROTTLED(tag, intervalMS, ...) LOG_TAG_THROTTLED(::Log::Level::Error, tag, intervalMS, __VA_ARGS__)
+#else
+    #define LOG_ERROR_TAG(tag, ...)                       ((void)0)
+    #define LOG_ERROR_TAG_THROTTLED(tag, intervalMS, ...) ((void)0)
+#endif
+
 #define LOG_CRITICAL_TAG(tag, ...) ::Log::PrintMessageWithTag(::Log::Level::Critical, tag, __VA_ARGS__)
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Byte accounting of the in-memory structures. Strings and vectors are counted by their capacity and every heap block
+// is charged an estimate of the allocator overhead, so that the totals follow the private bytes of the process rather
+// than the payload sizes. The hash tables are estimated after the MSVC layout: a doubly linked list of nodes, one heap
+// block each, and two pointers per bucket.
+struct MemoryUsage
+{
+    size_t UsedBytes{ 0u };     // Payload
+    size_t SlackBytes{ 0u };    // Capacity that holds no payload
+    size_t OverheadBytes{ 0u }; // Heap block headers and padding, hash table nodes and buckets
+
+    size_t GetTotalBytes() const noexcept { return UsedBytes + SlackBytes + OverheadBytes; }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) noexcept
+    {
+        UsedBytes += other.UsedBytes;
+        SlackBytes += other.SlackBytes;
+        OverheadBytes += other.OverheadBytes;
+        return *this;
+    }
+
+    // A heap block of capacityBytes of which usedBytes hold payload
+    void AddHeapBlock(size_t usedBytes, size_t capacityBytes) noexcept
+    {
+        UsedBytes += usedBytes;
+        SlackBytes += capacityBytes - usedBytes;
+        OverheadBytes += GetHeapBlockSize(capacityBytes) - capacityBytes;
+    }
+
+    // Short strings live in the object itself, which is counted with the structure holding it. The terminator counts as overhead
+    template <typename Allocator>
+    void AddString(const std::basic_string<char, std::char_traits<char>, Allocator>& string) noexcept
+    {
+        if (string.capacity() <= s_ShortStringCapacity)
+            return;
+
+        AddHeapBlock(string.size(), string.capacity());
+        OverheadBytes += GetHeapBlockSize(string.capacity() + 1u) - GetHeapBlockSize(string.capacity());
+    }
+
+    template <typename T, typename Allocator>
+    void AddVector(const std::vector<T, Allocator>& vector) noexcept
+    {
+        if (vector.capacity() > 0u)
+            AddHeapBlock(vector.size() * sizeof(T), vector.capacity() * sizeof(T));
+    }
+
+    // The nodes and the buckets only, the heap blocks owned by the keys and the values have to be added separately
+    template <typename... Args>
+    void AddHashTable(const std::unordered_map<Args...>& map) noexcept
+    {
+        using Node = typename std::unordered_map<Args...>::value_type;
+
+        OverheadBytes += map.size() * GetHeapBlockSize(sizeof(Node) + 2u * sizeof(void*));
+        OverheadBytes += GetHeapBlockSize(2u * sizeof(void*) * map.bucket_count());
+    }
+
+    template <typename... Args>
+    void AddHashTable(const std::unordered_set<Args...>& set) noexcept
+    {
+        using Node = typename std::unordered_set<Args...>::value_type;
+
+        OverheadBytes += set.size() * GetHeapBlockSize(sizeof(Node) + 2u * sizeof(void*));
+        OverheadBytes += GetHeapBlockSize(2u * sizeof(void*) * set.bucket_count());
+    }
+
+    static constexpr size_t GetHeapBlockSize(size_t size) noexcept
+    {
+        return (size + s_HeapBlockAlignment - 1u) / s_HeapBlockAlignment * s_HeapBlockAlignment + s_HeapBlockHeaderSize;
+    }
+
+    // The Windows heap keeps a 16-byte header in front of every block and rounds the blocks up to 16 bytes
+    static constexpr size_t s_HeapBlockHeaderSize{ 16u };
+    static constexpr size_t s_HeapBlockAlignment{ 16u };
+
+    static inline const size_t s_ShortStringCapacity{ std::string{}.capacity() };
+};
\ No newline at end of file
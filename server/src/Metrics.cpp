@@ -0,0 +1,75 @@
+#include "Metrics.h"
+
+namespace Metrics
+{
+    size_t GetThreadShardIndex() noexcept
+    {
+        static std::atomic<size_t> s_NextShardIndex{ 0u };
+
+        thread_local const size_t t_ShardIndex{ s_NextShardIndex.fetch_add(1u, std::memory_order_relaxed) % SHARDS_COUNT };
+        return t_ShardIndex;
+    }
+
+    uint64_t Counter::GetValue() const noexcept
+    {
+        uint64_t value{ 0u };
+        for (const Shard& shard : m_Shards)
+            value += shard.Value.load(std::memory_order_relaxed);
+
+        return value;
+    }
+
+    void Histogram::Observe(double value) noexcept
+    {
+        const size_t bucketIndex{ static_cast<size_t>(std::lower_bound(LATENCY_BUCKETS.begin(), LATENCY_BUCKETS.end(), value) - LATENCY_BUCKETS.begin()) };
+
+        Shard& shard{ m_Shards[GetThreadShardIndex()] };
+        shard.Counts[bucketIndex].fetch_add(1u, std::memory_order_relaxed);
+        shard.Sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    Histogram::Snapshot Histogram::GetSnapshot() const
+    {
+        Snapshot snapshot{ .CumulativeCounts = std::vector<uint64_t>(LATENCY_BUCKETS.size() + 1u, 0u) };
+
+        for (const Shard& shard : m_Shards)
+        {
+            for (size_t i{ 0u }; i < shard.Counts.size(); ++i)
+                snapshot.CumulativeCounts[i] += shard.Counts[i].load(std::memory_order_relaxed);
+
+            snapshot.Sum += shard.Sum.load(std::memory_order_relaxed);
+        }
+
+        std::partial_sum(snapshot.CumulativeCounts.begin(), snapshot.CumulativeCounts.end(), snapshot.CumulativeCounts.begin());
+
+        return snapshot;
+    }
+
+    void AppendHeader(std::string& destination, std::string_view name, std::string_view type, std::string_view help)
+    {
+        std::format_to(std::back_inserter(destination), "# HELP {0} {1}\n# TYPE {0} {2}\n", name, help, type);
+    }
+
+    void AppendSample(std::string& destination, std::string_view name, std::string_view labels, double value)
+    {
+        if (labels.empty())
+            std::format_to(std::back_inserter(destination), "{0} {1}\n", name, value);
+        else
+            std::format_to(std::back_inserter(destination), "{0}{{{1}}} {2}\n", name, labels, value);
+    }
+
+    void AppendHistogram(std::string& destination, std::string_view name, std::string_view labels, const Histogram& histogram)
+    {
+        const Histogram::Snapshot snapshot{ histogram.GetSnapshot() };
+        const std::string_view    separator{ labels.empty() ? "" : "," };
+
+        for (size_t i{ 0u }; i < LATENCY_BUCKETS.size(); ++i)
+            std::format_to(std::back_inserter(destination), "{0}_bucket{{{1}{2}le=\"{3}\"}} {4}\n", name, labels, separator, LATENCY_BUCKETS[i], snapshot.CumulativeCounts[i]);
+
+        std::format_to(std::back_inserter(destination), "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n", name, labels, separator, snapshot.CumulativeCounts.back());
+
+        const std::string suffixLabels{ labels.empty() ? std::string{} : std::format("{{{0}}}", labels) };
+        std::format_to(std::back_inserter(destination), "{0}_sum{1} {2}\n", name, suffixLabels, snapshot.Sum);
+        std::format_to(std::back_inserter(destination), "{0}_count{1} {2}\n", name, suffixLabels, snapshot.CumulativeCounts.back());
+    }
+} // namespace Metrics
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Counters and histograms cheap enough to be recorded on the request path: every thread records into a shard of its own,
+// on a cache line that no other thread writes to, and the shards are only summed when the metrics are scraped.
+// Everything is exposed in the Prometheus text format.
+namespace Metrics
+{
+    inline constexpr size_t SHARDS_COUNT{ 32u };
+
+    // Upper bounds of the latency buckets, in seconds
+    inline constexpr std::array LATENCY_BUCKETS{ 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+
+    // The shard of the calling thread, threads are given shards round-robin on their first call
+    size_t GetThreadShardIndex() noexcept;
+
+    class Counter
+    {
+    public:
+        void Increment(uint64_t value = 1u) noexcept { m_Shards[GetThreadShardIndex()].Value.fetch_add(value, std::memory_order_relaxed); }
+
+        uint64_t GetValue() const noexcept;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> Value{ 0u };
+        };
+
+    private:
+        std::array<Shard, SHARDS_COUNT> m_Shards{};
+    };
+
+    class Histogram
+    {
+    public:
+        struct Snapshot
+        {
+            std::vector<uint64_t> CumulativeCounts{}; // One per upper bound, then the +Inf bucket, which is the count
+            double                Sum{ 0.0 };
+        };
+
+    public:
+        void Observe(double value) noexcept;
+        void Observe(std::chrono::steady_clock::duration duration) noexcept { Observe(std::chrono::duration<double>(duration).count()); }
+
+        Snapshot GetSnapshot() const;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::array<std::atomic<uint64_t>, LATENCY_BUCKETS.size() + 1u> Counts{};
+            std::atomic<double>                                             Sum{ 0.0 };
+        };
+
+    private:
+        std::array<Shard, SHARDS_COUNT> m_Shards{};
+    };
+
+    // Appends the Prometheus text format, the HELP and TYPE lines have to be written once before the samples of a metric
+    void AppendHeader(std::string& destination, std::string_view name, std::string_view type, std::string_view help);
+    void AppendSample(std::string& destination, std::string_view name, std::string_view labels, double value);
+    void AppendHistogram(std::string& destination, std::string_view name, std::string_view labels, const Histogram& histogram);
+} // namespace Metrics
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "PathStore.h"
+
+#include "HTTP.h"
+
+bool PathStore::Add(FileID fileID, std::string_view path)
+{
+    if (m_Files.contains(fileID))
+        return false;
+
+    // Step 1: Every piece of the path up to and including a separator is a directory, the rest is the file name
+    uint32_t directoryIndex{ s_NoDirectory };
+
+    for (size_t separatorIndex{ path.find_first_of("/\\") }; separatorIndex != std::string_view::npos; separatorIndex = path.find_first_of("/\\"))
+    {
+        directoryIndex = AddDirectory(directoryIndex, path.substr(0u, separatorIndex + 1u));
+        path.remove_prefix(separatorIndex + 1u);
+    }
+
+    // Step 2: The file refers to its directory
+    m_Files.emplace(fileID, File{ .DirectoryIndex = directoryIndex, .Name = AddName(path) });
+
+    return true;
+}
+
+MemoryUsage PathStore::GetMemoryUsage() const noexcept
+{
+    MemoryUsage memoryUsage{};
+
+    memoryUsage.AddString(m_Names);
+    memoryUsage.AddVector(m_Directories);
+    memoryUsage.AddHashTable(m_Files);
+    memoryUsage.AddHashTable(m_DirectoryIndices);
+
+    return memoryUsage;
+}
+
+uint32_t PathStore::AddDirectory(uint32_t parentIndex, std::string_view name)
+{
+    if (const auto it{ m_DirectoryIndices.find(DirectoryKey{ .ParentIndex = parentIndex, .Name = name }) }; it != m_DirectoryIndices.end())
+        return *it;
+
+    if (m_Directories.size() >= s_NoDirectory)
+        throw std::runtime_error("The directories of the paths exceed the 32-bit indices");
+
+    // The directory is hashed through its entry, so the entry comes first
+    const uint32_t directoryIndex{ static_cast<uint32_t>(m_Directories.size()) };
+    m_Directories.push_back({ .ParentIndex = parentIndex, .Name = AddName(name) });
+    m_DirectoryIndices.insert(directoryIndex);
+
+    return directoryIndex;
+}
+
+PathStore::NameRange PathStore::AddName(std::string_view name)
+{
+    const size_t offset{ m_Names.size() };
+
+    m_Names.append(name);
+    HTTP::AppendJSONEscaped(m_Names, name);
+
+    // Also in Release builds, the ranges of the names past 4 GB would silently wrap around
+    if (m_Names.size() > std::numeric_limits<uint32_t>::max())
+    {
+        m_Names.resize(offset);
+        throw std::runtime_error("The names of the paths exceed the 32-bit offsets");
+    }
+
+    NameRange nameRange{ .Offset = static_cast<uint32_t>(offset), .Length = static_cast<uint32_t>(name.size()) };
+
+    // Most names need no escaping, only their escaped forms that differ are kept
+    const size_t escapedLength{ m_Names.size() - nameRange.Offset - nameRange.Length };
+    if (escapedLength == nameRange.Length)
+        m_Names.resize(m_Names.size() - escapedLength);
+    else
+        nameRange.EscapedLength = static_cast<uint32_t>(escapedLength);
+
+    return nameRange;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+#include "MemoryUsage.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The paths of the files, kept as a table of directories with parent pointers. Every directory is stored once, with its
+// name and its separator, so a file only holds its own name and the index of its directory. All the names are packed into
+// a single buffer, and a name that JSON has to escape is followed by its escaped form, so that a path is written into a
+// response by copying its pieces, root first, without being built or escaped on every request.
+// Not synchronized, FileSystem guards it with its own lock
+class PathStore
+{
+public:
+    using FileID = size_t; // FileSystem::FileID
+
+public:
+    PathStore() noexcept = default;
+
+    // The directory table is hashed through a pointer to the store
+    PathStore(const PathStore&) noexcept = delete;
+    PathStore(PathStore&&) noexcept = delete;
+
+    PathStore& operator=(const PathStore&) noexcept = delete;
+    PathStore& operator=(PathStore&&) noexcept = delete;
+
+public:
+    // Returns false if the file has a path already, that path is kept. Throws if the names would exceed the 32-bit offsets
+    bool Add(FileID fileID, std::string_view path);
+
+    bool Contains(FileID fileID) const noexcept { return m_Files.contains(fileID); }
+
+    // Return false, and append nothing, if the file has no path
+    template <typename String>
+    bool AppendPath(FileID fileID, String& destination) const { return AppendPath(fileID, destination, false); }
+
+    template <typename String>
+    bool AppendJSONEscapedPath(FileID fileID, String& destination) const { return AppendPath(fileID, destination, true); }
+
+    size_t GetFilesCount() const noexcept { return m_Files.size(); }
+    size_t GetDirectoriesCount() const noexcept { return m_Directories.size(); }
+
+    // The names, the directories and the files, with the hash tables that index them
+    MemoryUsage GetMemoryUsage() const noexcept;
+
+private:
+    struct NameRange
+    {
+        uint32_t Offset{ 0u };        // Into m_Names
+        uint32_t Length{ 0u };
+        uint32_t EscapedLength{ 0u }; // The escaped form follows the name in m_Names, 0 if it is the name itself
+    };
+
+    struct Directory
+    {
+        uint32_t  ParentIndex{ s_NoDirectory };
+        NameRange Name{}; // With the trailing separator, e.g. "C:\" or "docs/"
+    };
+
+    struct File
+    {
+        uint32_t  DirectoryIndex{ s_NoDirectory };
+        NameRange Name{};
+    };
+
+    // A directory looked up before it has been added
+    struct DirectoryKey
+    {
+        uint32_t         ParentIndex{ s_NoDirectory };
+        std::string_view Name{};
+    };
+
+    // The directories are indexed by their parent and their name read from m_Names, so that no name is kept twice
+    struct DirectoryHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const DirectoryKey& key) const noexcept
+        {
+            return std::hash<std::string_view>{}(key.Name) ^ (static_cast<size_t>(key.ParentIndex) * 0x9E3779B97F4A7C15ull);
+        }
+
+        size_t operator()(uint32_t directoryIndex) const noexcept { return (*this)(Store->GetDirectoryKey(directoryIndex)); }
+
+        const PathStore* Store{ nullptr };
+    };
+
+    struct DirectoryEqual
+    {
+        using is_transparent = void;
+
+        // Every directory is added once, so two indices are equal only if they are the same
+        bool operator()(uint32_t lhs, uint32_t rhs) const noexcept { return lhs == rhs; }
+        bool operator()(const DirectoryKey& lhs, uint32_t rhs) const noexcept { return IsEqual(lhs, Store->GetDirectoryKey(rhs)); }
+        bool operator()(uint32_t lhs, const DirectoryKey& rhs) const noexcept { return IsEqual(Store->GetDirectoryKey(lhs), rhs); }
+
+        static bool IsEqual(const DirectoryKey& lhs, const DirectoryKey& rhs) noexcept { return lhs.ParentIndex == rhs.ParentIndex && lhs.Name == rhs.Name; }
+
+        const PathStore* Store{ nullptr };
+    };
+
+private:
+    uint32_t  AddDirectory(uint32_t parentIndex, std::string_view name);
+    NameRange AddName(std::string_view name);
+
+    DirectoryKey GetDirectoryKey(uint32_t directoryIndex) const noexcept
+    {
+        const Directory& directory{ m_Directories[directoryIndex] };
+        return { .ParentIndex = directory.ParentIndex, .Name = std::string_view{ m_Names }.substr(directory.Name.Offset, directory.Name.Length) };
+    }
+
+    template <typename String>
+    bool AppendPath(FileID fileID, String& destination, bool isEscaped) const
+    {
+        const auto it{ m_Files.find(fileID) };
+        if (it == m_Files.end())
+            return false;
+
+        if (it->second.DirectoryIndex != s_NoDirectory)
+            AppendDirectory(it->second.DirectoryIndex, destination, isEscaped);
+
+        AppendName(it->second.Name, destination, isEscaped);
+        return true;
+    }
+
+    // The parents first, the depth of the recursion is that of the directory
+    template <typename String>
+    void AppendDirectory(uint32_t directoryIndex, String& destination, bool isEscaped) const
+    {
+        const Directory& directory{ m_Directories[directoryIndex] };
+        if (directory.ParentIndex != s_NoDirectory)
+            AppendDirectory(directory.ParentIndex, destination, isEscaped);
+
+        AppendName(directory.Name, destination, isEscaped);
+    }
+
+    template <typename String>
+    void AppendName(const NameRange& name, String& destination, bool isEscaped) const
+    {
+        if (isEscaped && name.EscapedLength != 0u)
+            destination.append(m_Names.data() + name.Offset + name.Length, name.EscapedLength);
+        else
+            destination.append(m_Names.data() + name.Offset, name.Length);
+    }
+
+private:
+    static constexpr uint32_t s_NoDirectory{ std::numeric_limits<uint32_t>::max() }; // Parent of a root, directory of a bare file name
+
+private:
+    std::string                                                 m_Names{};
+    std::vector<Directory>                                      m_Directories{};
+    std::unordered_map<FileID, File>                            m_Files{};
+    std::unordered_set<uint32_t, DirectoryHash, DirectoryEqual> m_DirectoryIndices{ 0u, DirectoryHash{ .Store = this }, DirectoryEqual{ .Store = this } };
+};
\ No newline at end of file
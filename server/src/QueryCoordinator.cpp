@@ -0,0 +1,469 @@
+#include "QueryCoordinator.h"
+
+#include "ScratchArena.h"
+#include "Server.h"
+#include "Tracer.h"
+
+#include <ws2tcpip.h>
+
+namespace Utils
+{
+    namespace
+    {
+        int      GetPollTimeoutMS(std::chrono::steady_clock::time_point deadline);
+        bool     SendAll(SOCKET socket, std::string_view buffer, std::chrono::steady_clock::time_point deadline);
+        void     AppendUInt32NetworkOrder(std::pmr::string& destination, uint32_t value);
+        uint32_t ReadUInt32NetworkOrder(const char* source);
+    } // namespace
+} // namespace Utils
+
+QueryCoordinator::QueryCoordinator(std::span<const std::string> shardAddresses, uint32_t shardTimeoutMS, ThreadPool* threadPool, uint8_t taskPriority)
+    : m_ShardTimeout{ shardTimeoutMS }
+    , m_ThreadPool{ threadPool }
+    , m_TaskPriority{ taskPriority }
+{
+    for (const std::string& shardAddress : shardAddresses)
+    {
+        auto shard{ std::make_unique<Shard>() };
+        shard->Address = shardAddress;
+        shard->SocketAddress.sin_family = AF_INET;
+
+        const size_t      separatorIndex{ shardAddress.rfind(':') };
+        const std::string host{ shardAddress.substr(0u, separatorIndex) };
+        uint16_t          port{ 0u };
+
+        const char* const portBegin{ shardAddress.data() + separatorIndex + 1u };
+        const char* const portEnd{ shardAddress.data() + shardAddress.size() };
+
+        if (separatorIndex == std::string::npos
+            || inet_pton(AF_INET, host.c_str(), &shard->SocketAddress.sin_addr) != 1
+            || std::from_chars(portBegin, portEnd, port).ptr != portEnd || port == 0u)
+        {
+            throw std::runtime_error(std::format("Invalid shard address: {0}", shardAddress).c_str());
+        }
+
+        shard->SocketAddress.sin_port = htons(port);
+        m_Shards.push_back(std::move(shard));
+    }
+}
+
+QueryCoordinator::~QueryCoordinator()
+{
+    for (const std::unique_ptr<Shard>& shard : m_Shards)
+    {
+        for (const SOCKET socket : shard->IdleSockets)
+            closesocket(socket);
+    }
+}
+
+InvertedIndex::SearchResult QueryCoordinator::Search(std::string_view query, const InvertedIndex::SearchOptions& options, std::pmr::memory_resource* resource)
+{
+    TRACE_SCOPE("QueryCoordinator::Search");
+
+    ScratchArena scratchArena{};
+
+    const std::chrono::steady_clock::time_point startTimePoint{ std::chrono::steady_clock::now() };
+    std::chrono::steady_clock::time_point       deadline{ options.Deadline };
+
+    if (m_ShardTimeout.count() != 0 && startTimePoint + m_ShardTimeout < deadline)
+        deadline = startTimePoint + m_ShardTimeout;
+
+    // Step 1
+    // Build the query frame: every shard ranks its own files from the first one, the page is only cut out of the merged files
+    const size_t topCount{ options.Limit > std::numeric_limits<size_t>::max() - options.Offset ? std::numeric_limits<size_t>::max() : options.Offset + options.Limit };
+    const size_t payloadLength{ 2u * sizeof(uint32_t) + query.size() };
+
+    if (payloadLength > s_MaxPayloadLength)
+        throw std::runtime_error(std::format("Query is too long: {0} bytes", query.size()).c_str());
+
+    std::pmr::string request{ scratchArena.GetResource() };
+    request.reserve(sizeof(uint32_t) + payloadLength);
+
+    Utils::AppendUInt32NetworkOrder(request, (static_cast<uint32_t>(BINARY_FRAME_TYPE_SEARCH_SCORED) << 24u) | static_cast<uint32_t>(payloadLength));
+    Utils::AppendUInt32NetworkOrder(request, 0u);
+    Utils::AppendUInt32NetworkOrder(request, static_cast<uint32_t>(std::min<size_t>(topCount, std::numeric_limits<uint32_t>::max())));
+    request.append(query);
+
+    // Step 2
+    // Send the query to every shard before waiting for any of them
+    std::vector<ShardCall> shardCalls(m_Shards.size());
+
+    for (size_t i{ 0u }; i < m_Shards.size(); ++i)
+    {
+        ShardCall& shardCall{ shardCalls[i] };
+        shardCall.Target = m_Shards[i].get();
+        shardCall.Socket = AcquireSocket(*shardCall.Target, deadline);
+
+        if (shardCall.Socket == INVALID_SOCKET)
+            FailShardCall(shardCall, "is unreachable");
+        else if (!Utils::SendAll(shardCall.Socket, request, deadline))
+            FailShardCall(shardCall, "has not taken the query");
+    }
+
+    // Step 3
+    // Wait for the answers
+    GatherAnswers(shardCalls, startTimePoint, deadline);
+
+    // Step 4
+    // Collect the ranked files of the shards, a shard left out only makes the result partial
+    size_t                                      totalHitsCount{ 0u };
+    bool                                        isPartial{ false };
+    std::pmr::vector<MergedFile>                shardFiles{ scratchArena.GetResource() };
+    std::pmr::vector<std::pair<size_t, size_t>> shardRanges{ scratchArena.GetResource() }; // The files of every shard in shardFiles, in its order
+
+    for (const ShardCall& shardCall : shardCalls)
+    {
+        const std::string_view answer{ shardCall.Response };
+
+        if (!shardCall.IsAnswered)
+        {
+            isPartial = true;
+            continue;
+        }
+
+        // The shard has shed the query or has spent its own time budget on it
+        if (Utils::ReadUInt32NetworkOrder(answer.data()) == BINARY_ERROR_MARKER)
+        {
+            shardCall.Target->Metrics.FailuresCount.Increment();
+            isPartial = true;
+            continue;
+        }
+
+        totalHitsCount += Utils::ReadUInt32NetworkOrder(answer.data());
+        isPartial |= Utils::ReadUInt32NetworkOrder(answer.data() + sizeof(uint32_t)) != 0u;
+
+        const uint32_t filesCount{ Utils::ReadUInt32NetworkOrder(answer.data() + 2u * sizeof(uint32_t)) };
+        const size_t   firstFileIndex{ shardFiles.size() };
+        size_t         offset{ 3u * sizeof(uint32_t) };
+
+        // The paths come first, then the scores in the same order
+        for (uint32_t i{ 0u }; i < filesCount; ++i)
+        {
+            const uint32_t         pathLength{ Utils::ReadUInt32NetworkOrder(answer.data() + offset) };
+            const std::string_view path{ answer.substr(offset + sizeof(uint32_t), pathLength) };
+
+            shardFiles.push_back({ .FileID = FileSystem::GetFileID(path), .Path = path });
+            offset += sizeof(uint32_t) + pathLength;
+        }
+
+        for (MergedFile& shardFile : shardFiles | std::views::drop(firstFileIndex))
+        {
+            shardFile.Score = Utils::ReadUInt32NetworkOrder(answer.data() + offset);
+            offset += sizeof(uint32_t);
+        }
+
+        shardRanges.emplace_back(firstFileIndex, shardFiles.size());
+    }
+
+    // Step 5
+    // Merge the lists of the shards up to the end of the page. A shard lists the duplicates of a file right after it rather
+    // than at the rank of their own FileIDs, so sorting the files of all the shards would move duplicates across the cutoff
+    // of a shard, and the pages would skip some files and repeat others. Every list is kept in its own order and only their
+    // heads are ranked, ties going to the first shard, so the first N merged files depend on the first N files of every
+    // shard only. Without duplicates every list is ranked already and the merge ranks the files as a single server does
+    const size_t pageEnd{ std::min(topCount, shardFiles.size()) };
+    const size_t pageBegin{ std::min(options.Offset, pageEnd) };
+
+    InvertedIndex::SearchResult result{
+        .FileIDs = std::pmr::vector<FileSystem::FileID>{ resource },
+        .Scores = std::pmr::vector<uint32_t>{ resource },
+        .Paths = std::pmr::vector<std::pmr::string>{ resource }
+    };
+    result.TotalHitsCount = totalHitsCount;
+    result.IsPartial = isPartial;
+    result.FileIDs.reserve(pageEnd - pageBegin);
+    result.Paths.reserve(pageEnd - pageBegin);
+
+    for (size_t rank{ 0u }; rank < pageEnd; ++rank)
+    {
+        std::pair<size_t, size_t>* topShardRange{ nullptr };
+
+        for (std::pair<size_t, size_t>& shardRange : shardRanges)
+        {
+            if (shardRange.first == shardRange.second)
+                continue;
+
+            const MergedFile& shardFile{ shardFiles[shardRange.first] };
+            if (!topShardRange || InvertedIndex::RanksHigher({ shardFile.FileID, shardFile.Score }, { shardFiles[topShardRange->first].FileID, shardFiles[topShardRange->first].Score }))
+                topShardRange = &shardRange;
+        }
+
+        const MergedFile& mergedFile{ shardFiles[topShardRange->first++] };
+        if (rank < pageBegin)
+            continue;
+
+        result.FileIDs.push_back(mergedFile.FileID);
+        result.Paths.emplace_back(mergedFile.Path);
+
+        if (options.WithScores)
+            result.Scores.push_back(mergedFile.Score);
+    }
+
+    return result;
+}
+
+InvertedIndex::BatchSearchResult QueryCoordinator::SearchBatch(std::span<const std::string_view> queries, const InvertedIndex::SearchOptions& options)
+{
+    InvertedIndex::BatchSearchResult batchResult{};
+    batchResult.ResultIndices.reserve(queries.size());
+
+    std::vector<std::string_view>                distinctQueries{};
+    std::unordered_map<std::string_view, size_t> distinctQueryIndices{};
+
+    for (const std::string_view query : queries)
+    {
+        const auto [it, isInserted]{ distinctQueryIndices.try_emplace(query, distinctQueries.size()) };
+        if (isInserted)
+            distinctQueries.push_back(query);
+
+        batchResult.ResultIndices.push_back(it->second);
+    }
+
+    batchResult.Results.resize(distinctQueries.size());
+
+    const auto searchDistinctQuery{ [this, &batchResult, &distinctQueries, &options](size_t i) {
+        batchResult.Results[i] = Search(distinctQueries[i], options, std::pmr::get_default_resource());
+    } };
+
+    if (m_ThreadPool)
+        m_ThreadPool->ParallelFor(m_TaskPriority, distinctQueries.size(), searchDistinctQuery);
+    else
+        for (size_t i{ 0u }; i < distinctQueries.size(); ++i)
+            searchDistinctQuery(i);
+
+    return batchResult;
+}
+
+SOCKET QueryCoordinator::AcquireSocket(Shard& shard, std::chrono::steady_clock::time_point deadline)
+{
+    {
+        std::lock_guard _{ shard.IdleSocketsLock };
+
+        while (!shard.IdleSockets.empty())
+        {
+            const SOCKET socket{ shard.IdleSockets.back() };
+            shard.IdleSockets.pop_back();
+
+            // No query is in flight on an idle socket, so a readable one has been closed by the shard
+            WSAPOLLFD pollDescriptor{ .fd = socket, .events = POLLRDNORM, .revents = 0 };
+            if (WSAPoll(&pollDescriptor, 1u, 0) == 0)
+                return socket;
+
+            closesocket(socket);
+        }
+
+        if (std::chrono::steady_clock::now() < shard.ReconnectTimePoint)
+            return INVALID_SOCKET;
+    }
+
+    const SOCKET socket{ Connect(shard, deadline) };
+
+    if (socket == INVALID_SOCKET)
+    {
+        std::lock_guard _{ shard.IdleSocketsLock };
+        shard.ReconnectTimePoint = std::chrono::steady_clock::now() + std::chrono::milliseconds(s_ReconnectIntervalMS);
+    }
+
+    return socket;
+}
+
+void QueryCoordinator::ReleaseSocket(Shard& shard, SOCKET socket)
+{
+    std::lock_guard _{ shard.IdleSocketsLock };
+    shard.IdleSockets.push_back(socket);
+}
+
+void QueryCoordinator::FailShardCall(ShardCall& shardCall, std::string_view reason)
+{
+    // The shard may still answer on the socket later, so it cannot be reused for another query
+    if (shardCall.Socket != INVALID_SOCKET)
+    {
+        closesocket(shardCall.Socket);
+        shardCall.Socket = INVALID_SOCKET;
+    }
+
+    shardCall.Target->Metrics.FailuresCount.Increment();
+    LOG_WARN_TAG_THROTTLED("QueryCoordinator", s_LogThrottleIntervalMS, "Shard {0} {1}", shardCall.Target->Address, reason);
+}
+
+void QueryCoordinator::GatherAnswers(std::span<ShardCall> shardCalls, std::chrono::steady_clock::time_point startTimePoint, std::chrono::steady_clock::time_point deadline)
+{
+    TRACE_SCOPE("QueryCoordinator::GatherAnswers");
+
+    std::vector<WSAPOLLFD>  pollDescriptors{};
+    std::vector<ShardCall*> pendingShardCalls{};
+
+    while (true)
+    {
+        pollDescriptors.clear();
+        pendingShardCalls.clear();
+
+        for (ShardCall& shardCall : shardCalls)
+        {
+            if (shardCall.Socket != INVALID_SOCKET && !shardCall.IsAnswered)
+            {
+                pollDescriptors.push_back({ .fd = shardCall.Socket, .events = POLLRDNORM, .revents = 0 });
+                pendingShardCalls.push_back(&shardCall);
+            }
+        }
+
+        if (pendingShardCalls.empty())
+            return;
+
+        const int timeoutMS{ Utils::GetPollTimeoutMS(deadline) };
+        if (timeoutMS == 0)
+            break;
+
+        const int readyDescriptorsCount{ WSAPoll(pollDescriptors.data(), static_cast<ULONG>(pollDescriptors.size()), timeoutMS) };
+        if (readyDescriptorsCount == SOCKET_ERROR)
+            throw std::runtime_error(std::format("Poll failed: {0}", WSAGetLastError()).c_str());
+
+        for (size_t i{ 0u }; i < pollDescriptors.size(); ++i)
+        {
+            if (pollDescriptors[i].revents == 0)
+                continue;
+
+            ShardCall& shardCall{ *pendingShardCalls[i] };
+
+            char buffer[s_ReceiveBufferSize]{};
+            int  bytesReceived{ 0 };
+
+            while ((bytesReceived = recv(shardCall.Socket, buffer, sizeof(buffer), 0)) > 0)
+                shardCall.Response.append(buffer, static_cast<size_t>(bytesReceived));
+
+            if (bytesReceived == 0)
+            {
+                FailShardCall(shardCall, "has closed the connection");
+                continue;
+            }
+
+            if (const int error{ WSAGetLastError() }; error != WSAEWOULDBLOCK)
+            {
+                FailShardCall(shardCall, std::format("has failed to answer: {0}", error));
+                continue;
+            }
+
+            if (IsCompleteAnswer(shardCall.Response))
+            {
+                shardCall.IsAnswered = true;
+                shardCall.Target->Metrics.Latencies.Observe(std::chrono::steady_clock::now() - startTimePoint);
+
+                ReleaseSocket(*shardCall.Target, shardCall.Socket);
+                shardCall.Socket = INVALID_SOCKET;
+            }
+        }
+    }
+
+    for (ShardCall* shardCall : pendingShardCalls)
+        FailShardCall(*shardCall, "has not answered in time");
+}
+
+SOCKET QueryCoordinator::Connect(const Shard& shard, std::chrono::steady_clock::time_point deadline)
+{
+    const SOCKET shardSocket{ socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) };
+    if (shardSocket == INVALID_SOCKET)
+        return INVALID_SOCKET;
+
+    // The connection is made without blocking, so that a shard that does not accept it cannot hold the query past its deadline
+    u_long mode{ 1u }; // 1u - non-blocking, 0u - blocking
+    if (ioctlsocket(shardSocket, FIONBIO, &mode) == SOCKET_ERROR
+        || (connect(shardSocket, reinterpret_cast<const sockaddr*>(&shard.SocketAddress), sizeof(shard.SocketAddress)) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK))
+    {
+        closesocket(shardSocket);
+        return INVALID_SOCKET;
+    }
+
+    // A refused connection is reported as an error of the socket once it has been polled
+    WSAPOLLFD pollDescriptor{ .fd = shardSocket, .events = POLLWRNORM, .revents = 0 };
+    int       socketError{ 0 };
+    int       socketErrorSize{ sizeof(socketError) };
+
+    if (WSAPoll(&pollDescriptor, 1u, Utils::GetPollTimeoutMS(deadline)) != 1
+        || getsockopt(shardSocket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&socketError), &socketErrorSize) == SOCKET_ERROR
+        || socketError != 0)
+    {
+        closesocket(shardSocket);
+        return INVALID_SOCKET;
+    }
+
+    return shardSocket;
+}
+
+bool QueryCoordinator::IsCompleteAnswer(std::string_view response)
+{
+    // An error is the marker followed by the error code
+    if (response.size() < sizeof(uint32_t))
+        return false;
+
+    if (Utils::ReadUInt32NetworkOrder(response.data()) == BINARY_ERROR_MARKER)
+        return response.size() >= 2u * sizeof(uint32_t);
+
+    // A scored result is the total, the partial flag, the count, the length-prefixed paths and a score for every path
+    if (response.size() < 3u * sizeof(uint32_t))
+        return false;
+
+    const uint32_t filesCount{ Utils::ReadUInt32NetworkOrder(response.data() + 2u * sizeof(uint32_t)) };
+    size_t         offset{ 3u * sizeof(uint32_t) };
+
+    for (uint32_t i{ 0u }; i < filesCount; ++i)
+    {
+        if (response.size() < offset + sizeof(uint32_t))
+            return false;
+
+        offset += sizeof(uint32_t) + Utils::ReadUInt32NetworkOrder(response.data() + offset);
+    }
+
+    return response.size() >= offset + filesCount * sizeof(uint32_t);
+}
+
+namespace Utils
+{
+    namespace
+    {
+        int GetPollTimeoutMS(std::chrono::steady_clock::time_point deadline)
+        {
+            if (deadline == std::chrono::steady_clock::time_point::max())
+                return -1;
+
+            // Rounded up, so that a poll does not return right before the deadline over and over
+            const auto remaining{ deadline - std::chrono::steady_clock::now() };
+            return remaining.count() > 0 ? static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count()) : 0;
+        }
+
+        bool SendAll(SOCKET socket, std::string_view buffer, std::chrono::steady_clock::time_point deadline)
+        {
+            while (!buffer.empty())
+            {
+                const int bytesSent{ send(socket, buffer.data(), static_cast<int>(buffer.size()), 0) };
+                if (bytesSent == SOCKET_ERROR)
+                {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK)
+                        return false;
+
+                    WSAPOLLFD pollDescriptor{ .fd = socket, .events = POLLWRNORM, .revents = 0 };
+                    if (WSAPoll(&pollDescriptor, 1u, GetPollTimeoutMS(deadline)) != 1)
+                        return false;
+
+                    continue;
+                }
+
+                buffer.remove_prefix(static_cast<size_t>(bytesSent));
+            }
+
+            return true;
+        }
+
+        void AppendUInt32NetworkOrder(std::pmr::string& destination, uint32_t value)
+        {
+            const uint32_t valueNetworkOrder{ htonl(value) };
+            destination.append(reinterpret_cast<const char*>(&valueNetworkOrder), sizeof(valueNetworkOrder));
+        }
+
+        uint32_t ReadUInt32NetworkOrder(const char* source)
+        {
+            uint32_t valueNetworkOrder{ 0u };
+            memcpy(&valueNetworkOrder, source, sizeof(valueNetworkOrder));
+            return ntohl(valueNetworkOrder);
+        }
+    } // namespace
+} // namespace Utils
\ No newline at end of file
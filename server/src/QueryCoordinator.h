@@ -0,0 +1,109 @@
+#pragma once
+#include "FileSystem.h"
+#include "InvertedIndex.h"
+#include "Metrics.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <winsock2.h>
+
+// Front of a cluster whose servers each index one partition of the documents, see FileSystem::Partition.
+// Every query is fanned out to all the shards over the binary protocol (BINARY_FRAME_TYPE_SEARCH_SCORED), each shard
+// returns its own top files with their scores and the coordinator merges the lists with the ranking of the index, keeping
+// the order of every shard, so the pages never skip nor repeat a file. Without duplicate files a page holds the same files
+// a single server indexing the whole corpus would return.
+// A shard that fails or does not answer within the shard timeout is left out and the result is marked as partial.
+class QueryCoordinator
+{
+public:
+    struct ShardMetrics
+    {
+        Metrics::Counter   FailuresCount{}; // Queries the shard has failed or has not answered in time
+        Metrics::Histogram Latencies{};     // From sending a query to the shard to the receipt of its complete answer
+    };
+
+public:
+    // The shards are given as "IPv4:port". The paths of the merged files are returned in SearchResult::Paths, they are not
+    // registered in the local file system. Batches are spread over the pool's workers
+    QueryCoordinator(std::span<const std::string> shardAddresses, uint32_t shardTimeoutMS, ThreadPool* threadPool = nullptr, uint8_t taskPriority = 0u);
+    ~QueryCoordinator();
+
+    QueryCoordinator(const QueryCoordinator&) noexcept = delete;
+    QueryCoordinator(QueryCoordinator&&) noexcept = delete;
+
+    QueryCoordinator& operator=(const QueryCoordinator&) noexcept = delete;
+    QueryCoordinator& operator=(QueryCoordinator&&) noexcept = delete;
+
+public:
+    // Blocks the calling thread until every shard has answered or the earlier of the query deadline and the shard timeout
+    InvertedIndex::SearchResult Search(std::string_view query, const InvertedIndex::SearchOptions& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Deduplicates the queries and runs the distinct ones in parallel, every one of them with a scatter-gather of its own
+    InvertedIndex::BatchSearchResult SearchBatch(std::span<const std::string_view> queries, const InvertedIndex::SearchOptions& options);
+
+    size_t              GetShardsCount() const noexcept { return m_Shards.size(); }
+    std::string_view    GetShardAddress(size_t shardIndex) const noexcept { return m_Shards[shardIndex]->Address; }
+    const ShardMetrics& GetShardMetrics(size_t shardIndex) const noexcept { return m_Shards[shardIndex]->Metrics; }
+
+private:
+    // The connections to a shard are pooled, a query holds one for its whole round trip
+    struct Shard
+    {
+        std::string Address{};
+        sockaddr_in SocketAddress{};
+
+        std::mutex                            IdleSocketsLock{};
+        std::vector<SOCKET>                   IdleSockets{};
+        std::chrono::steady_clock::time_point ReconnectTimePoint{}; // A shard that has refused a connection is not retried before
+
+        ShardMetrics Metrics{};
+    };
+
+    // The round trip of a query to one shard
+    struct ShardCall
+    {
+        Shard*      Target{ nullptr };
+        SOCKET      Socket{ INVALID_SOCKET };
+        std::string Response{};
+        bool        IsAnswered{ false };
+    };
+
+    struct MergedFile
+    {
+        FileSystem::FileID FileID{ 0u };
+        uint32_t           Score{ 0u };
+        std::string_view   Path{};
+    };
+
+private:
+    SOCKET AcquireSocket(Shard& shard, std::chrono::steady_clock::time_point deadline);
+    void   ReleaseSocket(Shard& shard, SOCKET socket);
+    void   FailShardCall(ShardCall& shardCall, std::string_view reason);
+
+    // Reads the answers of the shards until all of them are complete or the deadline has passed
+    void GatherAnswers(std::span<ShardCall> shardCalls, std::chrono::steady_clock::time_point startTimePoint, std::chrono::steady_clock::time_point deadline);
+
+    static SOCKET Connect(const Shard& shard, std::chrono::steady_clock::time_point deadline);
+    static bool   IsCompleteAnswer(std::string_view response);
+
+private:
+    static constexpr size_t   s_MaxPayloadLength{ 0x00FFFFFFu }; // The 24 bits of the binary frame header
+    static constexpr size_t   s_ReceiveBufferSize{ 16u * 1024u };
+    static constexpr uint32_t s_ReconnectIntervalMS{ 1000u };
+    static constexpr uint32_t s_LogThrottleIntervalMS{ 1000u };
+
+private:
+    const std::chrono::milliseconds m_ShardTimeout{ 0 };
+
+    ThreadPool* const m_ThreadPool{ nullptr };
+    const uint8_t     m_TaskPriority{ 0u };
+
+    std::vector<std::unique_ptr<Shard>> m_Shards{};
+};
\ No newline at end of file
@@ -0,0 +1,590 @@
+#include "Replication.h"
+
+#include "IndexFile.h"
+#include "RandomGenerator.h"
+#include "Server.h"
+#include "Tracer.h"
+
+#include <queue>
+#include <tuple>
+#include <ws2tcpip.h>
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr std::string_view SEGMENT_FILE_PREFIX{ "segment-" };
+        constexpr std::string_view SNAPSHOT_FILE_PREFIX{ "snapshot-" };
+
+        SOCKET   Connect(const sockaddr_in& address, int timeoutMS);
+        void     WaitForSocket(SOCKET socket, short events, int timeoutMS);
+        void     SendAll(SOCKET socket, std::string_view buffer, int timeoutMS);
+        void     ReceiveAll(SOCKET socket, char* buffer, size_t length, int timeoutMS);
+        void     AppendUInt32NetworkOrder(std::string& destination, uint32_t value);
+        uint32_t ReadUInt32NetworkOrder(const char* source);
+    } // namespace
+} // namespace Utils
+
+ReplicationLog::ReplicationLog(const std::filesystem::path& directory, AnalyzerType analyzerType)
+    : m_Directory{ directory }
+    , m_AnalyzerType{ analyzerType }
+    , m_LogID{ RandomGenerator::GenerateRandom<uint32_t>(1u, BINARY_ERROR_MARKER - 1u) }
+{
+    std::filesystem::create_directories(m_Directory);
+
+    // The segments and the snapshot of a previous run belong to another log
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ m_Directory })
+    {
+        const std::string fileName{ entry.path().filename().string() };
+
+        if (entry.is_regular_file() && (fileName.starts_with(Utils::SEGMENT_FILE_PREFIX) || fileName.starts_with(Utils::SNAPSHOT_FILE_PREFIX)))
+            std::filesystem::remove(entry.path());
+    }
+
+    LOG_INFO_TAG("Replication", "Writing the replication log {0:08x} to {1}", m_LogID, m_Directory.string());
+}
+
+void ReplicationLog::AddFile(FileSystem::FileID fileID, std::span<const std::pmr::string> terms)
+{
+    PendingFile pendingFile{ .FileID = fileID };
+    pendingFile.TermEnds.reserve(terms.size());
+
+    size_t termsSize{ 0u };
+    for (const std::pmr::string& term : terms)
+        termsSize += term.size();
+
+    pendingFile.Terms.reserve(termsSize);
+    for (const std::pmr::string& term : terms)
+    {
+        pendingFile.Terms.append(term);
+        pendingFile.TermEnds.push_back(static_cast<uint32_t>(pendingFile.Terms.size()));
+    }
+
+    std::lock_guard _{ m_PendingFilesLock };
+    m_PendingFiles.push_back(std::move(pendingFile));
+}
+
+void ReplicationLog::AddDuplicate(FileSystem::FileID fileID, FileSystem::FileID canonicalFileID)
+{
+    std::lock_guard _{ m_PendingFilesLock };
+    m_PendingDuplicates.emplace_back(fileID, canonicalFileID);
+}
+
+void ReplicationLog::CommitSegment(const FileSystem& fileSystem)
+{
+    std::lock_guard commitLock{ m_CommitLock };
+
+    std::vector<PendingFile>                                       files{};
+    std::vector<std::pair<FileSystem::FileID, FileSystem::FileID>> duplicates{};
+    {
+        std::lock_guard _{ m_PendingFilesLock };
+        files.swap(m_PendingFiles);
+        duplicates.swap(m_PendingDuplicates);
+    }
+
+    if (files.empty() && duplicates.empty())
+        return;
+
+    TRACE_SCOPE("ReplicationLog::CommitSegment");
+
+    // Step 1
+    // Invert the files, the terms are written in order like those of the indexer
+    std::unordered_map<std::string_view, std::vector<FileSystem::FileID>> postingLists{};
+    for (const PendingFile& file : files)
+    {
+        uint32_t termBegin{ 0u };
+        for (const uint32_t termEnd : file.TermEnds)
+        {
+            postingLists[std::string_view{ file.Terms }.substr(termBegin, termEnd - termBegin)].push_back(file.FileID);
+            termBegin = termEnd;
+        }
+    }
+
+    std::vector<std::string_view> terms{};
+    terms.reserve(postingLists.size());
+
+    for (const auto& [term, _] : postingLists)
+        terms.push_back(term);
+
+    std::sort(terms.begin(), terms.end());
+
+    // Step 2
+    // Write the segment under a temporary name, so that a replica never fetches a segment that is still being written
+    const uint32_t              version{ m_Version.load() + 1u };
+    const std::filesystem::path segmentPath{ GetSegmentPath(version) };
+    std::filesystem::path       temporaryPath{ segmentPath };
+    temporaryPath += ".tmp";
+
+    try
+    {
+        IndexFile::Writer writer{ temporaryPath.string(), m_AnalyzerType };
+
+        for (const PendingFile& file : files)
+            writer.WriteFile(file.FileID, fileSystem.GetPath(file.FileID));
+
+        for (const auto& [fileID, _] : duplicates)
+            writer.WriteFile(fileID, fileSystem.GetPath(fileID));
+
+        for (const std::string_view term : terms)
+            writer.WriteTerm(term, postingLists.find(term)->second);
+
+        // The canonical file of a duplicate may be in an earlier segment, the replicas load the segments in order
+        for (const auto& [fileID, canonicalFileID] : duplicates)
+            writer.WriteDuplicate(fileID, canonicalFileID);
+
+        writer.Finish();
+
+        std::filesystem::rename(temporaryPath, segmentPath);
+    }
+    catch (const std::exception&)
+    {
+        // The files go into the next segment instead, the replicas must not miss any of them
+        std::error_code errorCode{};
+        std::filesystem::remove(temporaryPath, errorCode);
+
+        std::lock_guard _{ m_PendingFilesLock };
+        m_PendingFiles.insert(m_PendingFiles.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+        m_PendingDuplicates.insert(m_PendingDuplicates.end(), duplicates.begin(), duplicates.end());
+
+        throw;
+    }
+
+    m_Version.store(version);
+
+    LOG_INFO_TAG("Replication", "Committed the segment {0}: {1} files, {2} duplicates, {3} terms", version, files.size(), duplicates.size(), terms.size());
+
+    // The segment is committed whether or not it can be merged, the next commit tries again
+    if (version - m_SnapshotVersion.load() >= s_CompactionSegmentsCount)
+    {
+        try
+        {
+            Compact(version);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_TAG("Replication", "Failed to merge the segments up to {0} into a snapshot: {1}", version, e.what());
+        }
+    }
+}
+
+ReplicationLog::Segment ReplicationLog::GetNextSegment(uint32_t replicaLogID, uint32_t replicaVersion) const
+{
+    // The snapshot is read first, a compaction publishes it before the segments it holds are deleted
+    const uint32_t snapshotVersion{ m_SnapshotVersion.load() };
+    const uint32_t version{ m_Version.load() };
+    const uint32_t nextVersion{ replicaLogID == m_LogID ? replicaVersion + 1u : 1u };
+
+    if (nextVersion > version)
+        return {};
+
+    if (nextVersion <= snapshotVersion)
+        return { .FirstVersion = 1u, .LastVersion = snapshotVersion, .Path = GetSnapshotPath(snapshotVersion) };
+
+    return { .FirstVersion = nextVersion, .LastVersion = nextVersion, .Path = GetSegmentPath(nextVersion) };
+}
+
+void ReplicationLog::Compact(uint32_t version)
+{
+    TRACE_SCOPE("ReplicationLog::Compact");
+
+    // Step 1
+    // Open the previous snapshot and the segments committed since, in the order the replicas load them
+    const uint32_t previousSnapshotVersion{ m_SnapshotVersion.load() };
+
+    std::vector<IndexFile::Reader> readers{};
+    readers.reserve(version - previousSnapshotVersion + 1u);
+
+    if (previousSnapshotVersion != 0u)
+        readers.emplace_back(GetSnapshotPath(previousSnapshotVersion).string());
+
+    for (uint32_t segmentVersion{ previousSnapshotVersion + 1u }; segmentVersion <= version; ++segmentVersion)
+        readers.emplace_back(GetSegmentPath(segmentVersion).string());
+
+    const std::filesystem::path snapshotPath{ GetSnapshotPath(version) };
+    std::filesystem::path       temporaryPath{ snapshotPath };
+    temporaryPath += ".tmp";
+
+    try
+    {
+        IndexFile::Writer writer{ temporaryPath.string(), m_AnalyzerType };
+
+        // Step 2
+        // Copy the files of every segment
+        FileSystem::FileID fileID{ 0u };
+        std::string        path{};
+
+        for (IndexFile::Reader& reader : readers)
+        {
+            while (reader.ReadFile(fileID, path))
+                writer.WriteFile(fileID, path);
+        }
+
+        // Step 3
+        // K-way merge of the terms, which every segment holds in order. The posting lists of a term are concatenated in the
+        // order of the segments, so that a replica loading the snapshot ends up with the lists it would have loaded
+        struct SegmentCursor
+        {
+            std::string                     Term{};
+            std::vector<FileSystem::FileID> FileIDs{};
+        };
+
+        std::vector<SegmentCursor> cursors(readers.size());
+
+        const auto cursorIsAfter{ [&cursors](size_t lhs, size_t rhs) {
+            return std::tie(cursors[lhs].Term, lhs) > std::tie(cursors[rhs].Term, rhs);
+        } };
+
+        std::priority_queue<size_t, std::vector<size_t>, decltype(cursorIsAfter)> nextCursors{ cursorIsAfter };
+
+        for (size_t i{ 0u }; i < readers.size(); ++i)
+        {
+            if (readers[i].ReadTerm(cursors[i].Term, cursors[i].FileIDs))
+                nextCursors.push(i);
+        }
+
+        std::string                     term{};
+        std::vector<FileSystem::FileID> postingList{};
+
+        while (!nextCursors.empty())
+        {
+            term = cursors[nextCursors.top()].Term;
+            postingList.clear();
+
+            while (!nextCursors.empty() && cursors[nextCursors.top()].Term == term)
+            {
+                const size_t i{ nextCursors.top() };
+                nextCursors.pop();
+
+                postingList.insert(postingList.end(), cursors[i].FileIDs.begin(), cursors[i].FileIDs.end());
+
+                if (readers[i].ReadTerm(cursors[i].Term, cursors[i].FileIDs))
+                    nextCursors.push(i);
+            }
+
+            writer.WriteTerm(term, postingList);
+        }
+
+        // Step 4
+        // Copy the duplicates, their canonical files are all in the snapshot now
+        FileSystem::FileID canonicalFileID{ 0u };
+
+        for (IndexFile::Reader& reader : readers)
+        {
+            while (reader.ReadDuplicate(fileID, canonicalFileID))
+                writer.WriteDuplicate(fileID, canonicalFileID);
+        }
+
+        writer.Finish();
+        readers.clear();
+
+        std::filesystem::rename(temporaryPath, snapshotPath);
+
+        LOG_INFO_TAG("Replication", "Merged the segments up to {0} into a snapshot: {1} files, {2} duplicates, {3} terms", version, writer.GetFilesCount(), writer.GetDuplicatesCount(), writer.GetTermsCount());
+    }
+    catch (const std::exception&)
+    {
+        readers.clear();
+
+        std::error_code errorCode{};
+        std::filesystem::remove(temporaryPath, errorCode);
+
+        throw;
+    }
+
+    // Step 5
+    // Publish the snapshot, then delete what it replaces
+    m_SnapshotVersion.store(version);
+
+    RemoveMergedSegments(version);
+}
+
+void ReplicationLog::RemoveMergedSegments(uint32_t snapshotVersion) const
+{
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ m_Directory })
+    {
+        const std::string fileName{ entry.path().filename().string() };
+        const bool        isSegment{ fileName.starts_with(Utils::SEGMENT_FILE_PREFIX) };
+        const bool        isSnapshot{ fileName.starts_with(Utils::SNAPSHOT_FILE_PREFIX) };
+
+        if (!entry.is_regular_file() || (!isSegment && !isSnapshot))
+            continue;
+
+        const size_t prefixLength{ isSegment ? Utils::SEGMENT_FILE_PREFIX.size() : Utils::SNAPSHOT_FILE_PREFIX.size() };
+        uint32_t     fileVersion{ 0u };
+
+        if (std::from_chars(fileName.data() + prefixLength, fileName.data() + fileName.size(), fileVersion).ec != std::errc{})
+            continue;
+
+        // A file that is still being sent to a replica cannot be deleted on Windows, it is deleted by the next compaction
+        if ((isSegment && fileVersion <= snapshotVersion) || (isSnapshot && fileVersion < snapshotVersion))
+        {
+            std::error_code errorCode{};
+            std::filesystem::remove(entry.path(), errorCode);
+        }
+    }
+}
+
+std::filesystem::path ReplicationLog::GetSegmentPath(uint32_t version) const
+{
+    return m_Directory / std::format("{0}{1}.cwix", Utils::SEGMENT_FILE_PREFIX, version);
+}
+
+std::filesystem::path ReplicationLog::GetSnapshotPath(uint32_t version) const
+{
+    return m_Directory / std::format("{0}{1}.cwix", Utils::SNAPSHOT_FILE_PREFIX, version);
+}
+
+ReplicationClient::ReplicationClient(const std::string& primaryAddress, std::filesystem::path segmentPath, FileSystem& fileSystem, InvertedIndex& invertedIndex)
+    : m_SegmentPath{ std::move(segmentPath) }
+    , m_FileSystem{ fileSystem }
+    , m_InvertedIndex{ invertedIndex }
+{
+    m_PrimaryAddress.sin_family = AF_INET;
+
+    const size_t      separatorIndex{ primaryAddress.rfind(':') };
+    const std::string host{ primaryAddress.substr(0u, separatorIndex) };
+    uint16_t          port{ 0u };
+
+    const char* const portBegin{ primaryAddress.data() + separatorIndex + 1u };
+    const char* const portEnd{ primaryAddress.data() + primaryAddress.size() };
+
+    if (separatorIndex == std::string::npos
+        || inet_pton(AF_INET, host.c_str(), &m_PrimaryAddress.sin_addr) != 1
+        || std::from_chars(portBegin, portEnd, port).ptr != portEnd || port == 0u)
+    {
+        throw std::runtime_error(std::format("Invalid primary address: {0}", primaryAddress).c_str());
+    }
+
+    m_PrimaryAddress.sin_port = htons(port);
+}
+
+size_t ReplicationClient::Synchronize()
+{
+    TRACE_SCOPE("ReplicationClient::Synchronize");
+
+    const SOCKET primarySocket{ Utils::Connect(m_PrimaryAddress, s_TimeoutMS) };
+    if (primarySocket == INVALID_SOCKET)
+        throw std::runtime_error("Failed to connect to the primary");
+
+    size_t loadedSegmentsCount{ 0u };
+
+    try
+    {
+        while (FetchSegment(primarySocket))
+            ++loadedSegmentsCount;
+    }
+    catch (const std::exception&)
+    {
+        closesocket(primarySocket);
+        throw;
+    }
+
+    closesocket(primarySocket);
+
+    return loadedSegmentsCount;
+}
+
+bool ReplicationClient::FetchSegment(SOCKET primarySocket)
+{
+    // Step 1
+    // Ask for the segment that follows the last loaded one: the log ID and the version (4 bytes each, network byte order)
+    std::string request{};
+    Utils::AppendUInt32NetworkOrder(request, (static_cast<uint32_t>(BINARY_FRAME_TYPE_FETCH_SEGMENT) << 24u) | static_cast<uint32_t>(2u * sizeof(uint32_t)));
+    Utils::AppendUInt32NetworkOrder(request, m_LogID);
+    Utils::AppendUInt32NetworkOrder(request, m_Version.load());
+
+    Utils::SendAll(primarySocket, request, s_TimeoutMS);
+
+    // Step 2
+    // Receive the log ID, the first and the last version and the size of the segment, or an error
+    std::array<char, 4u * sizeof(uint32_t)> header{};
+    Utils::ReceiveAll(primarySocket, header.data(), sizeof(uint32_t), s_TimeoutMS);
+
+    const uint32_t logID{ Utils::ReadUInt32NetworkOrder(header.data()) };
+    if (logID == BINARY_ERROR_MARKER)
+    {
+        Utils::ReceiveAll(primarySocket, header.data(), sizeof(uint32_t), s_TimeoutMS);
+        throw std::runtime_error(std::format("The primary has rejected the fetch with the error {0}", Utils::ReadUInt32NetworkOrder(header.data())).c_str());
+    }
+
+    Utils::ReceiveAll(primarySocket, header.data() + sizeof(uint32_t), 3u * sizeof(uint32_t), s_TimeoutMS);
+
+    const uint32_t firstVersion{ Utils::ReadUInt32NetworkOrder(header.data() + sizeof(uint32_t)) };
+    const uint32_t lastVersion{ Utils::ReadUInt32NetworkOrder(header.data() + 2u * sizeof(uint32_t)) };
+    const uint32_t segmentSize{ Utils::ReadUInt32NetworkOrder(header.data() + 3u * sizeof(uint32_t)) };
+
+    // The postings of a new log, or of the snapshot of the segments the replica has loaded, would be appended to those
+    // already loaded. The replica starts over from the first segment instead
+    if (m_Version.load() != 0u && (logID != m_LogID || (segmentSize != 0u && firstVersion == 1u)))
+    {
+        LOG_WARN_TAG("Replication", "The primary has {0}, reloading the index from the segment 1", logID != m_LogID ? "started a new replication log" : "merged the next segment into its snapshot");
+
+        m_FileSystem.Clear();
+        m_InvertedIndex.Clear();
+
+        m_LogID = logID;
+        m_Version.store(0u);
+    }
+
+    if (segmentSize == 0u)
+        return false;
+
+    if (firstVersion != m_Version.load() + 1u || lastVersion < firstVersion)
+        throw std::runtime_error(std::format("The primary has sent the segments {0} to {1} instead of {2}", firstVersion, lastVersion, m_Version.load() + 1u).c_str());
+
+    // Step 3
+    // Receive the segment into the segment file
+    {
+        TRACE_SCOPE("ReplicationClient::ReceiveSegment");
+
+        std::ofstream stream{ m_SegmentPath, std::ios::out | std::ios::binary | std::ios::trunc };
+        if (!stream.is_open())
+            throw std::runtime_error(std::format("Failed to create the segment file {0}", m_SegmentPath.string()).c_str());
+
+        std::string buffer(s_ReceiveBufferSize, '\0');
+        for (size_t remainingBytes{ segmentSize }; remainingBytes > 0u;)
+        {
+            const size_t chunkSize{ std::min(remainingBytes, buffer.size()) };
+            Utils::ReceiveAll(primarySocket, buffer.data(), chunkSize, s_TimeoutMS);
+
+            stream.write(buffer.data(), static_cast<std::streamsize>(chunkSize));
+            remainingBytes -= chunkSize;
+        }
+
+        stream.close();
+        if (stream.fail())
+            throw std::runtime_error(std::format("Failed to write the segment file {0}", m_SegmentPath.string()).c_str());
+    }
+
+    // Step 4
+    // Load the segment into the index
+    LoadSegment(firstVersion, lastVersion);
+
+    m_LogID = logID;
+    m_Version.store(lastVersion);
+
+    return true;
+}
+
+void ReplicationClient::LoadSegment(uint32_t firstVersion, uint32_t lastVersion)
+{
+    TRACE_SCOPE("ReplicationClient::LoadSegment");
+
+    const std::chrono::steady_clock::time_point startTimePoint{ std::chrono::steady_clock::now() };
+
+    IndexFile::Reader reader{ m_SegmentPath.string() };
+    m_InvertedIndex.CheckAnalyzerType(reader);
+
+    const size_t filesCount{ m_FileSystem.LoadIndexedFiles(reader) };
+    const size_t termsCount{ m_InvertedIndex.Load(reader) };
+
+    const auto elapsedMS{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTimePoint).count() };
+    if (firstVersion == lastVersion)
+        LOG_INFO_TAG("Replication", "Loaded the segment {0}: {1} files and {2} terms in {3} ms", lastVersion, filesCount, termsCount, elapsedMS);
+    else
+        LOG_INFO_TAG("Replication", "Loaded the snapshot of the segments {0} to {1}: {2} files and {3} terms in {4} ms", firstVersion, lastVersion, filesCount, termsCount, elapsedMS);
+}
+
+namespace Utils
+{
+    namespace
+    {
+        SOCKET Connect(const sockaddr_in& address, int timeoutMS)
+        {
+            const SOCKET connectedSocket{ socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) };
+            if (connectedSocket == INVALID_SOCKET)
+                return INVALID_SOCKET;
+
+            // The connection is made without blocking, so that an unreachable primary does not hold the worker for long
+            u_long mode{ 1u }; // 1u - non-blocking, 0u - blocking
+            if (ioctlsocket(connectedSocket, FIONBIO, &mode) == SOCKET_ERROR
+                || (connect(connectedSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK))
+            {
+                closesocket(connectedSocket);
+                return INVALID_SOCKET;
+            }
+
+            // A refused connection is reported as an error of the socket once it has been polled
+            WSAPOLLFD pollDescriptor{ .fd = connectedSocket, .events = POLLWRNORM, .revents = 0 };
+            int       socketError{ 0 };
+            int       socketErrorSize{ sizeof(socketError) };
+
+            if (WSAPoll(&pollDescriptor, 1u, timeoutMS) != 1
+                || getsockopt(connectedSocket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&socketError), &socketErrorSize) == SOCKET_ERROR
+                || socketError != 0)
+            {
+                closesocket(connectedSocket);
+                return INVALID_SOCKET;
+            }
+
+            return connectedSocket;
+        }
+
+        void WaitForSocket(SOCKET socket, short events, int timeoutMS)
+        {
+            WSAPOLLFD pollDescriptor{ .fd = socket, .events = events, .revents = 0 };
+
+            const int readyDescriptorsCount{ WSAPoll(&pollDescriptor, 1u, timeoutMS) };
+            if (readyDescriptorsCount == SOCKET_ERROR)
+                throw std::runtime_error(std::format("Poll failed: {0}", WSAGetLastError()).c_str());
+
+            if (readyDescriptorsCount == 0)
+                throw std::runtime_error("Socket timed out");
+        }
+
+        void SendAll(SOCKET socket, std::string_view buffer, int timeoutMS)
+        {
+            while (!buffer.empty())
+            {
+                const int bytesSent{ send(socket, buffer.data(), static_cast<int>(buffer.size()), 0) };
+                if (bytesSent == SOCKET_ERROR)
+                {
+                    const int error{ WSAGetLastError() };
+                    if (error != WSAEWOULDBLOCK)
+                        throw std::runtime_error(std::format("Send failed: {0}", error).c_str());
+
+                    WaitForSocket(socket, POLLWRNORM, timeoutMS);
+                    continue;
+                }
+
+                buffer.remove_prefix(static_cast<size_t>(bytesSent));
+            }
+        }
+
+        void ReceiveAll(SOCKET socket, char* buffer, size_t length, int timeoutMS)
+        {
+            size_t totalBytesReceived{ 0u };
+            while (totalBytesReceived < length)
+            {
+                const int bytesReceived{ recv(socket, buffer + totalBytesReceived, static_cast<int>(length - totalBytesReceived), 0) };
+                if (bytesReceived == 0)
+                    throw std::runtime_error("The primary has closed the connection");
+
+                if (bytesReceived == SOCKET_ERROR)
+                {
+                    const int error{ WSAGetLastError() };
+                    if (error != WSAEWOULDBLOCK)
+                        throw std::runtime_error(std::format("Receive failed: {0}", error).c_str());
+
+                    WaitForSocket(socket, POLLRDNORM, timeoutMS);
+                    continue;
+                }
+
+                totalBytesReceived += static_cast<size_t>(bytesReceived);
+            }
+        }
+
+        void AppendUInt32NetworkOrder(std::string& destination, uint32_t value)
+        {
+            const uint32_t valueNetworkOrder{ htonl(value) };
+            destination.append(reinterpret_cast<const char*>(&valueNetworkOrder), sizeof(valueNetworkOrder));
+        }
+
+        uint32_t ReadUInt32NetworkOrder(const char* source)
+        {
+            uint32_t valueNetworkOrder{ 0u };
+            memcpy(&valueNetworkOrder, source, sizeof(valueNetworkOrder));
+            return ntohl(valueNetworkOrder);
+        }
+    } // namespace
+} // namespace Utils
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include "FileSystem.h"
+#include "InvertedIndex.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+
+// Primary side of the read replicas. The files every index update merges are also written to the log directory as an
+// immutable segment in the index file format, numbered from 1. The replicas fetch the segments they lack in order over
+// the binary protocol (BINARY_FRAME_TYPE_FETCH_SEGMENT), so only the primary crawls, reads and tokenizes the files.
+// Every s_CompactionSegmentsCount commits the segments are merged into a single snapshot that new replicas start from,
+// and the merged segments are deleted. The log is cleared when the primary starts and gets a new ID
+class ReplicationLog
+{
+public:
+    // The segments from FirstVersion to LastVersion merged into one file, FirstVersion is 1 for the snapshot
+    struct Segment
+    {
+        uint32_t              FirstVersion{ 0u };
+        uint32_t              LastVersion{ 0u };
+        std::filesystem::path Path{};
+    };
+
+public:
+    // The segments record the analyzer of the index, the replicas have to use the same one
+    ReplicationLog(const std::filesystem::path& directory, AnalyzerType analyzerType);
+
+    ReplicationLog(const ReplicationLog&) noexcept = delete;
+    ReplicationLog(ReplicationLog&&) noexcept = delete;
+
+    ReplicationLog& operator=(const ReplicationLog&) noexcept = delete;
+    ReplicationLog& operator=(ReplicationLog&&) noexcept = delete;
+
+public:
+    // Called by the merge stage for every file it has merged, the terms are copied
+    void AddFile(FileSystem::FileID fileID, std::span<const std::pmr::string> terms);
+
+    // Called by the read stage for every duplicate, see FileSystem::LoadedFile
+    void AddDuplicate(FileSystem::FileID fileID, FileSystem::FileID canonicalFileID);
+
+    // Writes the files added since the last commit as the next segment, does nothing if there are none
+    void CommitSegment(const FileSystem& fileSystem);
+
+    // The segment that follows the given version of a replica, the snapshot for a replica of another log or one whose next
+    // segment has been merged into it. The versions are 0 if the replica is up to date
+    Segment GetNextSegment(uint32_t replicaLogID, uint32_t replicaVersion) const;
+
+    uint32_t GetLogID() const noexcept { return m_LogID; }
+    uint32_t GetVersion() const noexcept { return m_Version.load(); } // Of the last committed segment, 0 before the first one
+
+private:
+    // The terms of a file packed into a single string, TermEnds holds the end offset of every term
+    struct PendingFile
+    {
+        FileSystem::FileID    FileID{ 0u };
+        std::string           Terms{};
+        std::vector<uint32_t> TermEnds{};
+    };
+
+private:
+    // Merges the snapshot and the segments up to the given version into the next snapshot, the caller holds m_CommitLock
+    void Compact(uint32_t version);
+
+    // Of the segments merged into the snapshot and of the older snapshots, those still being sent are left for the next compaction
+    void RemoveMergedSegments(uint32_t snapshotVersion) const;
+
+    std::filesystem::path GetSegmentPath(uint32_t version) const;
+    std::filesystem::path GetSnapshotPath(uint32_t version) const;
+
+private:
+    static constexpr uint32_t s_CompactionSegmentsCount{ 16u };
+
+private:
+    const std::filesystem::path m_Directory{};
+    const AnalyzerType          m_AnalyzerType{ ANALYZER_TYPE_STANDARD };
+    const uint32_t              m_LogID{ 0u };
+
+    std::mutex                                                     m_PendingFilesLock{};
+    std::vector<PendingFile>                                       m_PendingFiles{};
+    std::vector<std::pair<FileSystem::FileID, FileSystem::FileID>> m_PendingDuplicates{}; // FileID, canonical FileID
+
+    std::mutex            m_CommitLock{}; // The next update may finish while the segment of the previous one is being written
+    std::atomic<uint32_t> m_Version{ 0u };
+    std::atomic<uint32_t> m_SnapshotVersion{ 0u }; // Of the last segment merged into the snapshot, 0 before the first compaction
+};
+
+// Replica side: fetches the segments the replica lacks from its primary and loads them into the local index
+class ReplicationClient
+{
+public:
+    // The primary is given as "IPv4:port", the segments are received into segmentPath before they are loaded
+    ReplicationClient(const std::string& primaryAddress, std::filesystem::path segmentPath, FileSystem& fileSystem, InvertedIndex& invertedIndex);
+
+    ReplicationClient(const ReplicationClient&) noexcept = delete;
+    ReplicationClient(ReplicationClient&&) noexcept = delete;
+
+    ReplicationClient& operator=(const ReplicationClient&) noexcept = delete;
+    ReplicationClient& operator=(ReplicationClient&&) noexcept = delete;
+
+public:
+    // Loads the new segments until the replica has caught up, returns the number of the segments loaded. A primary that has
+    // restarted with a new log, or that has merged the next segment of the replica into its snapshot, is followed from the
+    // start: the index of the replica is cleared and loaded again from the first segment. Throws if the primary cannot be
+    // reached. Must not be called concurrently
+    size_t Synchronize();
+
+    uint32_t GetVersion() const noexcept { return m_Version.load(); } // Of the last loaded segment
+
+private:
+    // Returns false if the replica is up to date
+    bool FetchSegment(SOCKET primarySocket);
+    void LoadSegment(uint32_t firstVersion, uint32_t lastVersion);
+
+private:
+    static constexpr int    s_TimeoutMS{ 10000 }; // Time the primary may go without any progress being made in a fetch
+    static constexpr size_t s_ReceiveBufferSize{ 64u * 1024u };
+
+private:
+    sockaddr_in                 m_PrimaryAddress{};
+    const std::filesystem::path m_SegmentPath{};
+
+    FileSystem&    m_FileSystem;
+    InvertedIndex& m_InvertedIndex;
+
+    uint32_t              m_LogID{ 0u };
+    std::atomic<uint32_t> m_Version{ 0u };
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "ScratchArena.h"
+
+#include "Metrics.h"
+
+namespace
+{
+    Metrics::Counter s_BlockCacheHitsCount{};
+    Metrics::Counter s_BlockCacheMissesCount{};
+
+    // An unsynchronized cache of the blocks of one thread. Released blocks are kept up to s_MaxCachedBytes and handed out
+    // again for requests of the same size and alignment, which is what the arenas of similar requests ask for.
+    class BlockCache final : public std::pmr::memory_resource
+    {
+    public:
+        ~BlockCache() override
+        {
+            for (const CachedBlock& block : m_Blocks)
+                std::pmr::new_delete_resource()->deallocate(block.Data, block.Size, block.Alignment);
+        }
+
+    private:
+        struct CachedBlock
+        {
+            void*  Data{ nullptr };
+            size_t Size{ 0u };
+            size_t Alignment{ 0u };
+        };
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            const auto it{ std::find_if(m_Blocks.begin(), m_Blocks.end(), [bytes, alignment](const CachedBlock& block) {
+                return block.Size == bytes && block.Alignment == alignment;
+            }) };
+
+            if (it == m_Blocks.end())
+            {
+                s_BlockCacheMissesCount.Increment();
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            s_BlockCacheHitsCount.Increment();
+            void* data{ it->Data };
+
+            m_CachedBytes -= it->Size;
+            *it = m_Blocks.back();
+            m_Blocks.pop_back();
+
+            return data;
+        }
+
+        void do_deallocate(void* data, size_t bytes, size_t alignment) override
+        {
+            if (m_CachedBytes + bytes > s_MaxCachedBytes)
+            {
+                std::pmr::new_delete_resource()->deallocate(data, bytes, alignment);
+                return;
+            }
+
+            m_Blocks.push_back({ .Data = data, .Size = bytes, .Alignment = alignment });
+            m_CachedBytes += bytes;
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        // A thread keeps the blocks of its largest requests, the blocks of an exceptionally large one are freed right away
+        static constexpr size_t s_MaxCachedBytes{ 4u * 1024u * 1024u };
+
+        std::vector<CachedBlock> m_Blocks{};
+        size_t                   m_CachedBytes{ 0u };
+    };
+} // namespace
+
+ScratchArena::ScratchArena(size_t initialSize)
+    : m_Resource{ initialSize, GetThreadBlockCache() }
+{
+}
+
+ScratchArena::BlockCacheStats ScratchArena::GetBlockCacheStats() noexcept
+{
+    return { .HitsCount = s_BlockCacheHitsCount.GetValue(), .MissesCount = s_BlockCacheMissesCount.GetValue() };
+}
+
+std::pmr::memory_resource* ScratchArena::GetThreadBlockCache()
+{
+    static thread_local BlockCache s_BlockCache{};
+    return &s_BlockCache;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+// Scratch memory of a single request or document: allocations are bump-pointer and are all released at once when the
+// arena is destroyed. The blocks of the arena come from a cache of the thread and go back to it, so once a thread has
+// served a few requests of a kind, the next ones make no global heap allocation at all.
+// An arena must be allocated from and destroyed on the thread that created it, nothing allocated from it may outlive it.
+class ScratchArena
+{
+public:
+    explicit ScratchArena(size_t initialSize = s_DefaultInitialSize);
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena(ScratchArena&&) = delete;
+
+    ScratchArena& operator=(const ScratchArena&) = delete;
+    ScratchArena& operator=(ScratchArena&&) = delete;
+
+public:
+    std::pmr::memory_resource* GetResource() noexcept { return &m_Resource; }
+
+    // Over all the threads: a hit is a block of an arena handed out again by the cache of its thread
+    struct BlockCacheStats
+    {
+        uint64_t HitsCount{ 0u };
+        uint64_t MissesCount{ 0u };
+    };
+
+    static BlockCacheStats GetBlockCacheStats() noexcept;
+
+private:
+    // Recycles the blocks released by the arenas of the calling thread
+    static std::pmr::memory_resource* GetThreadBlockCache();
+
+private:
+    static constexpr size_t s_DefaultInitialSize{ 16u * 1024u };
+
+    std::pmr::monotonic_buffer_resource m_Resource;
+};
\ No newline at end of file
@@ -1,20 +1,54 @@
 #include "Server.h"
 
+#include "ScratchArena.h"
+#include "Tracer.h"
+
 namespace Utils
 {
     namespace
     {
-        void        RecvAll(SOCKET socket, char* buffer, uint32_t length);
-        void        SendAll(SOCKET socket, const char* buffer, uint32_t length);
-        std::string UrlDecode(std::string_view value);
+        void     WaitForSocket(SOCKET socket, short events, int timeoutMS);
+        void     SendAll(SOCKET socket, const char* buffer, uint32_t length, int timeoutMS);
+        void     AppendUInt32NetworkOrder(std::pmr::string& destination, uint32_t value);
+        void     WriteUInt32NetworkOrder(char* destination, uint32_t value);
+        void     AppendJSONMemoryUsage(std::pmr::string& destination, std::string_view name, const MemoryUsage& memoryUsage);
+        uint32_t ReadUInt32NetworkOrder(const char* source);
     } // namespace
 } // namespace Utils
 
-Server::Server()
+Server::Server(const ServerConfig& config)
+    : m_Config{ config }
+    , m_Topology{ config.SimulatedNUMANodesCount != 0u ? Topology::Simulate(config.SimulatedNUMANodesCount) : Topology::Detect() }
 {
     Log::Init();
 
-    m_ThreadPool.Create();
+    if (!m_Config.ShardAddresses.empty())
+    {
+        LOG_INFO_TAG("SERVER", "Coordinating {0} shards", m_Config.ShardAddresses.size());
+        m_QueryCoordinator = std::make_unique<QueryCoordinator>(m_Config.ShardAddresses, m_Config.ShardTimeoutMS, &m_ThreadPool, SERVER_TASK_PRIORITY_HELP_SEARCH);
+    }
+    else if (m_Config.Partition.Count > 1u)
+    {
+        LOG_INFO_TAG("SERVER", "Indexing the partition {0} of {1}", m_Config.Partition.Index, m_Config.Partition.Count);
+    }
+
+    if (!m_Config.ReplicationDirectory.empty())
+        m_ReplicationLog = std::make_unique<ReplicationLog>(m_Config.ReplicationDirectory, m_Config.Analyzer);
+
+    if (!m_Config.IsNUMAPlacementEnabled)
+    {
+        m_ThreadPool.Create(m_Config.WorkersCount);
+        return;
+    }
+
+    LOG_INFO_TAG("SERVER", "Placing the workers and the index shards over {0} {1}NUMA nodes", m_Topology.GetNodesCount(), m_Topology.IsSimulated() ? "simulated " : "");
+
+    // The event loops take the first cores, the workers the following ones
+    std::vector<uint32_t> workerCores{ m_Topology.GetCoresByNode() };
+    std::rotate(workerCores.begin(), workerCores.begin() + m_Config.EventLoopsCount % workerCores.size(), workerCores.end());
+
+    m_ThreadPool.Create(m_Config.WorkersCount, workerCores);
+    m_InvertedIndex.PlaceShards(m_Topology);
 }
 
 void Server::Start(const std::string& filesDirectory, uint16_t port)
@@ -25,13 +59,41 @@ void Server::Start(const std::string& filesDirectory, uint16_t port)
     m_Port = port;
     m_IsRunning = true;
 
+    // The replicas of a host receive their segments into files of their own, named after their ports
+    if (!m_Config.PrimaryAddress.empty())
+    {
+        LOG_INFO_TAG("SERVER", "Replicating the index of {0}", m_Config.PrimaryAddress);
+
+        const std::filesystem::path segmentPath{ std::filesystem::temp_directory_path() / std::format("course_work_replica_{0}.cwix", port) };
+        m_ReplicationClient = std::make_unique<ReplicationClient>(m_Config.PrimaryAddress, segmentPath, m_FileSystem, m_InvertedIndex);
+    }
+
+    Tracer::Enable(m_Config.IsTracingEnabled);
     m_ThreadPool.Start();
 
+    if (!m_Config.IndexPath.empty())
+        LoadIndex();
+
     CreateListenSocket();
+    CreateEventLoops();
 
     LOG_INFO_TAG("SERVER", "Server started successfully!");
 
-    Routine();
+    for (const std::unique_ptr<EventLoop>& eventLoop : m_EventLoops | std::views::drop(1u))
+    {
+        eventLoop->Thread = std::thread{ [this, &eventLoop = *eventLoop]() {
+            try
+            {
+                Routine(eventLoop);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_CRITICAL_TAG("SERVER", "Event loop {0} exception: {1}", eventLoop.Index, e.what());
+            }
+        } };
+    }
+
+    Routine(*m_EventLoops.front());
 }
 
 void Server::Stop()
@@ -40,13 +102,30 @@ void Server::Stop()
 
     m_IsRunning = false;
 
+    for (const std::unique_ptr<EventLoop>& eventLoop : m_EventLoops)
+    {
+        if (eventLoop->Thread.joinable())
+            eventLoop->Thread.join();
+    }
+
+    // The queued crawling and indexing tasks are dropped, the running ones finish the files they hold
     m_ThreadPool.Shutdown();
+    {
+        std::lock_guard _{ m_IndexingPipelineLock };
+        m_IndexingPipeline.reset();
+    }
 
-    for (auto& taskFuture : m_UpdateIndexFutures)
-        taskFuture.get();
+    // No worker is left to query the shards, their connections are closed before the sockets are cleaned up
+    m_QueryCoordinator.reset();
 
-    for (auto& taskFuture : m_ClientTasksFutures)
-        taskFuture.get();
+    // The workers are gone, so no connection can be resumed anymore
+    for (const std::unique_ptr<EventLoop>& eventLoop : m_EventLoops)
+    {
+        eventLoop->IdleConnections.clear();
+        eventLoop->ResumedConnections.clear();
+        closesocket(eventLoop->WakeupSocket);
+    }
+    m_EventLoops.clear();
 
     closesocket(m_ListenSocket);
     WSACleanup();
@@ -54,6 +133,26 @@ void Server::Stop()
     LOG_INFO_TAG("SERVER", "Server stopped successfully!");
 }
 
+void Server::StartInProcess()
+{
+    LOG_INFO_TAG("SERVER", "Starting server in process...");
+
+    Tracer::Enable(m_Config.IsTracingEnabled);
+    m_ThreadPool.Start();
+
+    if (!m_Config.IndexPath.empty())
+        LoadIndex();
+}
+
+void Server::ProcessHTTPRequest(std::string_view request, std::string& outputBuffer)
+{
+    // A connection without a socket, whose response is buffered like the ones of an event loop
+    const Connection connection{ INVALID_SOCKET, {}, m_Metrics.ClosedConnectionsCount, ConnectionProtocol::HTTP };
+
+    m_InFlightRequestsCount.fetch_add(1u);
+    ProcessRequest(connection, request, nullptr, std::chrono::steady_clock::now(), &outputBuffer);
+}
+
 void Server::CreateListenSocket()
 {
     WSADATA wsaData{};
@@ -112,385 +211,1610 @@ void Server::CreateListenSocket()
     }
 }
 
-void Server::Routine()
+void Server::CreateEventLoops()
 {
-    LOG_INFO_TAG("SERVER", "Starting routine...");
+    const uint32_t eventLoopsCount{ std::max(m_Config.EventLoopsCount, 1u) };
 
-    while (m_IsRunning)
+    for (uint32_t i{ 0u }; i < eventLoopsCount; ++i)
     {
-        RemoveFinishedTasksFutures();
+        auto eventLoop{ std::make_unique<EventLoop>() };
+        eventLoop->Index = i;
+        eventLoop->WakeupSocket = CreateWakeupSocket();
 
-        // Updat the inverted index
-        const std::chrono::time_point<std::chrono::steady_clock> currentTimePoint{ std::chrono::steady_clock::now() };
-        m_ElapsedAfterLastIndexUpdateMS += std::chrono::duration_cast<std::chrono::milliseconds>(currentTimePoint - m_LastIndexUpdateTimePoint).count();
-        if (m_ElapsedAfterLastIndexUpdateMS >= m_IndexUpdateIntervalMS && m_UpdateIndexFutures.empty())
-        {
-            m_LastIndexUpdateTimePoint = currentTimePoint,
-            UpdateInvertedIndex();
-        }
+        m_EventLoops.push_back(std::move(eventLoop));
+    }
+}
 
-        // Accept a client
-        const SOCKET clientSocket{ accept(m_ListenSocket, nullptr, nullptr) };
-        if (clientSocket == INVALID_SOCKET)
-        {
-            const int error{ WSAGetLastError() };
-            switch (error)
-            {
-                case WSAEWOULDBLOCK:
-                    break;
-                default:
-                    LOG_ERROR_TAG("SERVER", "Accept failed: {0}", error);
-                    break;
-            }
-            continue;
-        }
+SOCKET Server::CreateWakeupSocket()
+{
+    // A loopback UDP socket connected to itself: workers send a datagram to it to interrupt WSAPoll() in the routine
+    const SOCKET wakeupSocket{ socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP) };
+    if (wakeupSocket == INVALID_SOCKET)
+    {
+        LOG_CRITICAL_TAG("SERVER", "Wakeup socket failed: {0}", WSAGetLastError());
+
+        throw std::runtime_error("Wakeup socket failed");
+    }
+
+    sockaddr_in wakeupAddress{};
+    wakeupAddress.sin_family = AF_INET;
+    wakeupAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    wakeupAddress.sin_port = 0u;
+
+    int wakeupAddressSize{ sizeof(wakeupAddress) };
+
+    u_long mode{ 1u }; // 1u - non-blocking, 0u - blocking
+    if (bind(wakeupSocket, reinterpret_cast<sockaddr*>(&wakeupAddress), sizeof(wakeupAddress)) == SOCKET_ERROR
+        || getsockname(wakeupSocket, reinterpret_cast<sockaddr*>(&wakeupAddress), &wakeupAddressSize) == SOCKET_ERROR
+        || connect(wakeupSocket, reinterpret_cast<sockaddr*>(&wakeupAddress), sizeof(wakeupAddress)) == SOCKET_ERROR
+        || ioctlsocket(wakeupSocket, FIONBIO, &mode) == SOCKET_ERROR)
+    {
+        LOG_CRITICAL_TAG("SERVER", "Wakeup socket setup failed: {0}", WSAGetLastError());
+        closesocket(wakeupSocket);
 
-        // Process the client
-        m_ClientTasksFutures.emplace_back(m_ThreadPool.AddTask(SERVER_TASK_PRIORITY_HANDLE_CLIENT, [this, clientSocket]() { ProcessClient(clientSocket); }));
+        throw std::runtime_error("Wakeup socket setup failed");
     }
+
+    return wakeupSocket;
 }
 
-void Server::RemoveFinishedTasksFutures()
+void Server::LoadIndex()
 {
-    const auto taskCanBeDeletedPredicate{ []<typename T>(const std::future<T>& taskFuture) -> bool { return taskFuture.valid() ? taskFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready : true; } };
+    LOG_INFO_TAG("SERVER", "Loading index {0}...", m_Config.IndexPath);
+
+    const std::chrono::steady_clock::time_point startTimePoint{ std::chrono::steady_clock::now() };
 
-    std::erase_if(m_ClientTasksFutures, taskCanBeDeletedPredicate);
-    std::erase_if(m_UpdateIndexFutures, taskCanBeDeletedPredicate);
+    IndexFile::Reader reader{ m_Config.IndexPath, m_Config.Partition };
+    m_InvertedIndex.CheckAnalyzerType(reader);
+
+    const size_t filesCount{ m_FileSystem.LoadIndexedFiles(reader) };
+    const size_t termsCount{ m_InvertedIndex.Load(reader) };
+
+    {
+        std::lock_guard _{ m_IndexingPipelineLock };
+        m_LastIndexUpdateFinishTimePoint = std::chrono::steady_clock::now();
+    }
+
+    const auto elapsedMS{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTimePoint).count() };
+    LOG_INFO_TAG("SERVER", "Loaded {0} files and {1} terms in {2} ms", filesCount, termsCount, elapsedMS);
 }
 
-void Server::UpdateInvertedIndex()
+void Server::Routine(EventLoop& eventLoop)
 {
-    std::vector<std::string> filePaths{};
+    if (m_Config.EventLoopsCount == 0u)
+    {
+        LOG_INFO_TAG("SERVER", "Starting routine...");
+        Tracer::SetThreadName("Server routine");
+    }
+    else
+    {
+        // The loops fill the cores node after node
+        const std::vector<uint32_t> cores{ m_Topology.GetCoresByNode() };
+        const uint32_t              coreIndex{ cores[eventLoop.Index % cores.size()] };
+        if (!Topology::PinCurrentThread(coreIndex))
+            LOG_WARN_TAG("SERVER", "Failed to pin the event loop {0} to the core {1}", eventLoop.Index, coreIndex);
+
+        LOG_INFO_TAG("SERVER", "Starting event loop {0} on the core {1}...", eventLoop.Index, coreIndex);
+        Tracer::SetThreadName(std::format("Server event loop {0}", eventLoop.Index));
+    }
 
-    std::filesystem::recursive_directory_iterator directoryIterator{ m_FilesDirectory };
-    for (const auto& directoryEntry : directoryIterator)
+    while (m_IsRunning)
     {
-        const std::string& filePath{ directoryEntry.path().string() };
-        if (directoryEntry.is_regular_file() && !m_FileSystem.FileIsLoaded(filePath))
-            filePaths.emplace_back(filePath);
+        // Update the inverted index, a new crawl only starts once the previous one has finished. A coordinator has no index,
+        // a replica loads the segments of its primary instead of crawling
+        const std::chrono::time_point<std::chrono::steady_clock> currentTimePoint{ std::chrono::steady_clock::now() };
+        const bool isIndexUpdateDue{ currentTimePoint - m_LastIndexUpdateTimePoint >= std::chrono::milliseconds(m_IndexUpdateIntervalMS) };
+        if (eventLoop.Index == 0u && isIndexUpdateDue && m_ReplicationClient)
+        {
+            m_LastIndexUpdateTimePoint = currentTimePoint;
+            SynchronizeReplica();
+        }
+        else if (eventLoop.Index == 0u && !m_QueryCoordinator && isIndexUpdateDue && (!m_IndexingPipeline || m_IndexingPipeline->IsFinished()))
+        {
+            m_LastIndexUpdateTimePoint = currentTimePoint;
+            UpdateInvertedIndex();
+        }
+
+        // Take back the connections whose requests have been processed and drop the ones past their deadlines
+        ResumeConnections(eventLoop);
+        ExpireConnections(eventLoop);
+
+        // Accept new clients and read the requests of the idle ones
+        PollConnections(eventLoop);
     }
+}
+
+void Server::UpdateInvertedIndex()
+{
+    TRACE_SCOPE("Server::UpdateInvertedIndex");
 
+    // The directory tree is crawled and indexed on the ThreadPool, so the routine never waits on the file system metadata
     const uint32_t freeWorkersCount{ std::max(m_ThreadPool.GetFreeWorkersCount(), 1u) };
-    const uint32_t filesCount{ static_cast<uint32_t>(filePaths.size()) };
-    const uint32_t filesPerWorkerCount{ filesCount / freeWorkersCount };
 
-    const auto& workerFileLoadRoutine{
-        [this, filePaths = std::move(filePaths)](uint32_t beginIndex, uint32_t filesCount) {
-            for (const auto& filePath : filePaths | std::views::drop(beginIndex) | std::views::take(filesCount))
-            {
-                // LOG_TRACE_TAG("SERVER", "Loading file: {0}", filePath);
+    auto indexingPipeline{ std::make_shared<IndexingPipeline>(m_ThreadPool, SERVER_TASK_PRIORITY_UPDATE_INVERTED_INDEX, freeWorkersCount, m_FileSystem, m_InvertedIndex, m_Config.Partition, m_ReplicationLog.get()) };
+    indexingPipeline->Start(m_FilesDirectory);
 
-                const FileSystem::FileID fileID{ m_FileSystem.LoadFile(filePath) };
-                m_InvertedIndex.Add(fileID, m_FileSystem.GetContent(fileID));
-            }
-        }
-    };
+    std::lock_guard _{ m_IndexingPipelineLock };
 
-    for (uint32_t i{ 0u }; i < freeWorkersCount - 1u; ++i)
-        m_UpdateIndexFutures.emplace_back(m_ThreadPool.AddTask(SERVER_TASK_PRIORITY_UPDATE_INVERTED_INDEX, workerFileLoadRoutine, i * filesPerWorkerCount, filesPerWorkerCount));
+    if (m_IndexingPipeline)
+        m_LastIndexUpdateFinishTimePoint = m_IndexingPipeline->GetFinishTimePoint();
 
-    const uint32_t alreadyProcessedFilesCount{ (freeWorkersCount - 1u) * filesPerWorkerCount };
-    m_UpdateIndexFutures.emplace_back(m_ThreadPool.AddTask(SERVER_TASK_PRIORITY_UPDATE_INVERTED_INDEX, workerFileLoadRoutine, alreadyProcessedFilesCount, filesCount - alreadyProcessedFilesCount));
+    m_IndexingPipeline = std::move(indexingPipeline);
 }
 
-void Server::ProcessClient(SOCKET clientSocket)
+void Server::SynchronizeReplica()
 {
-    sockaddr_in clientAddr{};
-    int         clientAddrSize{ sizeof(clientAddr) };
-    char        clientIP[INET_ADDRSTRLEN]{};
-    uint16_t    clientPort{ 0u };
+    // The segments are fetched and loaded on the ThreadPool like the files of an update, one synchronization at a time
+    if (m_IsSynchronizingReplica.exchange(true))
+        return;
 
-    if (getpeername(clientSocket, reinterpret_cast<sockaddr*>(&clientAddr), &clientAddrSize) == 0)
+    try
     {
-        // Convert the client's IP address to a string
-        inet_ntop(AF_INET, &(clientAddr.sin_addr), clientIP, INET_ADDRSTRLEN);
-        clientPort = ntohs(clientAddr.sin_port);
+        m_ThreadPool.AddTask(SERVER_TASK_PRIORITY_UPDATE_INVERTED_INDEX, [this]() {
+            try
+            {
+                if (m_ReplicationClient->Synchronize() != 0u)
+                {
+                    std::lock_guard _{ m_IndexingPipelineLock };
+                    m_LastIndexUpdateFinishTimePoint = std::chrono::steady_clock::now();
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Failed to synchronize with the primary {0}: {1}", m_Config.PrimaryAddress, e.what());
+            }
 
-        LOG_INFO_TAG("SERVER", "Connected to the client {0}:{1}", clientIP, clientPort);
+            m_IsSynchronizingReplica = false;
+        });
     }
-    else
+    catch (const std::runtime_error&)
+    {
+        // The ThreadPool is shutting down
+        m_IsSynchronizingReplica = false;
+    }
+}
+
+void Server::PollConnections(EventLoop& eventLoop)
+{
+    // Every loop polls the shared listen socket, the loops that lose the race for a client get WSAEWOULDBLOCK from accept()
+    std::vector<WSAPOLLFD>& pollDescriptors{ eventLoop.PollDescriptors };
+    pollDescriptors.clear();
+    pollDescriptors.push_back({ .fd = m_ListenSocket, .events = POLLRDNORM, .revents = 0 });
+    pollDescriptors.push_back({ .fd = eventLoop.WakeupSocket, .events = POLLRDNORM, .revents = 0 });
+
+    // A connection with buffered responses reads nothing more until they have been flushed, so the client cannot pile them up
+    for (const auto& [clientSocket, connection] : eventLoop.IdleConnections)
+        pollDescriptors.push_back({ .fd = clientSocket, .events = connection->OutputBuffer.empty() ? POLLRDNORM : POLLWRNORM, .revents = 0 });
+
+    const int readyDescriptorsCount{ WSAPoll(pollDescriptors.data(), static_cast<ULONG>(pollDescriptors.size()), s_PollTimeoutMS) };
+    if (readyDescriptorsCount == SOCKET_ERROR)
     {
-        closesocket(clientSocket);
-        LOG_ERROR_TAG("SERVER", "Failed to get the client information: {0}\nClosed the client socket", WSAGetLastError());
+        LOG_ERROR_TAG("SERVER", "Poll failed: {0}", WSAGetLastError());
         return;
     }
 
-    try
+    if (readyDescriptorsCount == 0)
+        return;
+
+    // Drain the wakeup datagrams, the resumed connections are picked up on the next iteration
+    if (pollDescriptors[1u].revents != 0)
+    {
+        char wakeupBuffer[64u]{};
+        while (recv(eventLoop.WakeupSocket, wakeupBuffer, sizeof(wakeupBuffer), 0) > 0)
+            ;
+    }
+
+    for (const WSAPOLLFD& pollDescriptor : pollDescriptors | std::views::drop(2u))
     {
-        constexpr uint32_t peekBufferSize{ 1024u };
-        char               peekBuffer[peekBufferSize]{};
-        int                bytesPeeked{ 0 };
+        if (pollDescriptor.revents == 0)
+            continue;
+
+        const auto it{ eventLoop.IdleConnections.find(pollDescriptor.fd) };
+        if (it == eventLoop.IdleConnections.end())
+            continue;
 
-        while (true)
+        const ConnectionRef connection{ it->second };
+
+        try
         {
-            bytesPeeked = recv(clientSocket, peekBuffer, peekBufferSize, MSG_PEEK);
-            if (bytesPeeked == SOCKET_ERROR)
-            {
-                const int error{ WSAGetLastError() };
-                switch (error)
-                {
-                    case WSAEWOULDBLOCK:
-                        continue;
-                    default:
-                        throw std::runtime_error(std::format("Peek failed: {0}", error).c_str());
-                }
-            }
-            else if (bytesPeeked == 0) // The connection has been gracefully closed
-            {
-                closesocket(clientSocket);
-                LOG_INFO_TAG("SERVER", "Closed the client socket {0}:{1}", clientIP, clientPort);
-                return;
-            }
-            else
+            // Either the client has gone away, its last response has been flushed or its request has been handed over to a worker
+            bool isReleased{ false };
+            if (connection->OutputBuffer.empty())
+                isReleased = !ReceiveFromConnection(*connection) || DispatchRequest(eventLoop, connection);
+            else if (!FlushConnection(*connection))
+                isReleased = true;
+            else if (connection->OutputBuffer.empty()) // The requests the client has pipelined meanwhile are dispatched now
+                isReleased = connection->IsClosing || DispatchRequest(eventLoop, connection);
+
+            if (isReleased)
+                eventLoop.IdleConnections.erase(it);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Client {0} exception: {1}", connection->Peer, e.what());
+            eventLoop.IdleConnections.erase(it);
+        }
+    }
+
+    if (pollDescriptors[0u].revents != 0)
+        AcceptClients(eventLoop);
+}
+
+void Server::AcceptClients(EventLoop& eventLoop)
+{
+    TRACE_SCOPE("Server::AcceptClients");
+
+    while (true)
+    {
+        sockaddr_in clientAddr{};
+        int         clientAddrSize{ sizeof(clientAddr) };
+
+        const SOCKET clientSocket{ accept(m_ListenSocket, reinterpret_cast<sockaddr*>(&clientAddr), &clientAddrSize) };
+        if (clientSocket == INVALID_SOCKET)
+        {
+            const int error{ WSAGetLastError() };
+            switch (error)
             {
-                break;
+                case WSAEWOULDBLOCK:
+                    break;
+                default:
+                    LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Accept failed: {0}", error);
+                    break;
             }
+            return;
         }
 
-        std::string_view peekData{ peekBuffer, static_cast<size_t>(bytesPeeked) };
-
-        bool isHTTPRequest{ false };
+        // Convert the client's IP address to a string
+        char clientIP[INET_ADDRSTRLEN]{};
+        inet_ntop(AF_INET, &(clientAddr.sin_addr), clientIP, INET_ADDRSTRLEN);
 
-        using namespace std::literals;
-        constexpr std::array httpMethods{ "GET"sv, "POST"sv, "PUT"sv, "DELETE"sv, "HEAD"sv, "CONNECT"sv, "OPTIONS"sv, "TRACE"sv, "PATCH"sv };
+        std::string peer{ std::format("{0}:{1}", clientIP, ntohs(clientAddr.sin_port)) };
 
-        std::ranges::any_of(httpMethods, [&isHTTPRequest, &peekData](const std::string_view& httpMethod) { return isHTTPRequest = peekData.starts_with(httpMethod); });
+        LOG_DEBUG_TAG("SERVER", "Connected to the client {0}", peer);
+        m_Metrics.AcceptedConnectionsCount.Increment();
 
-        if (isHTTPRequest)
-            HandleHTTPClient(clientSocket);
-        else
-            HandleSocketClient(clientSocket);
+        // Sockets returned by accept() inherit the non-blocking mode of the listen socket
+        eventLoop.IdleConnections.emplace(clientSocket, std::make_shared<Connection>(clientSocket, std::move(peer), m_Metrics.ClosedConnectionsCount));
     }
-    catch (const std::exception& e)
+}
+
+void Server::ResumeConnections(EventLoop& eventLoop)
+{
+    std::vector<ConnectionRef> resumedConnections{};
     {
-        LOG_ERROR_TAG("SERVER", "Client {0}:{1} exception: {2}", clientIP, clientPort, e.what());
+        std::lock_guard _{ eventLoop.ResumedConnectionsLock };
+        resumedConnections.swap(eventLoop.ResumedConnections);
     }
 
-    // Step 6
-    // Close the client socket
-    closesocket(clientSocket);
-    LOG_INFO_TAG("SERVER", "Closed the client socket {0}:{1}", clientIP, clientPort);
+    for (ConnectionRef& connection : resumedConnections)
+    {
+        try
+        {
+            // The client may have already pipelined its next request
+            if (DispatchRequest(eventLoop, connection))
+                continue;
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Client {0} exception: {1}", connection->Peer, e.what());
+            continue;
+        }
+
+        const SOCKET clientSocket{ connection->Socket };
+        eventLoop.IdleConnections.emplace(clientSocket, std::move(connection));
+    }
 }
 
-void Server::HandleSocketClient(SOCKET clientSocket)
+void Server::ResumeConnection(EventLoop& eventLoop, const ConnectionRef& connection)
 {
-    while (true)
     {
-        // Step 1
-        // Receive the length of the query string (4 bytes, network byte order)
-        uint32_t requestLength{ 0u };
-        Utils::RecvAll(clientSocket, reinterpret_cast<char*>(&requestLength), sizeof(requestLength));
-        const uint32_t requestLengthNetworkOrder{ htonl(requestLength) };
+        std::lock_guard _{ eventLoop.ResumedConnectionsLock };
+        eventLoop.ResumedConnections.push_back(connection);
+    }
 
-        if (requestLengthNetworkOrder == 0u)
-            break;
+    WakeUpRoutine(eventLoop);
+}
 
-        // Step 2
-        // Receive the query string based on the received length
-        std::string request(requestLengthNetworkOrder, '\0');
-        Utils::RecvAll(clientSocket, request.data(), requestLengthNetworkOrder);
+void Server::ExpireConnections(EventLoop& eventLoop)
+{
+    const std::chrono::steady_clock::time_point currentTimePoint{ std::chrono::steady_clock::now() };
+    if (currentTimePoint - eventLoop.LastExpirationTimePoint < std::chrono::milliseconds(s_PollTimeoutMS))
+        return;
 
-        // Step 3
-        // Search the query in the inverted index
-        const auto&              foundFiles{ m_InvertedIndex.Search(request) };
-        std::vector<std::string> foundFilesPaths{};
-        foundFilesPaths.reserve(foundFiles.size());
+    eventLoop.LastExpirationTimePoint = currentTimePoint;
 
-        std::ranges::for_each(foundFiles, [this, &foundFilesPaths](const FileSystem::FileID fileID) { foundFilesPaths.emplace_back(m_FileSystem.GetPath(fileID)); });
+    const auto isExpired{ [](std::chrono::steady_clock::duration elapsed, uint32_t timeoutMS) {
+        return timeoutMS != 0u && elapsed > std::chrono::milliseconds(timeoutMS);
+    } };
 
-        // Step 4
-        // Send the number of the found files (4 bytes, network byte order)
-        const uint32_t resultsCount{ static_cast<uint32_t>(foundFilesPaths.size()) };
-        const uint32_t resultsCountNetworkOrder{ htonl(resultsCount) };
-        Utils::SendAll(clientSocket, reinterpret_cast<const char*>(&resultsCountNetworkOrder), sizeof(resultsCountNetworkOrder));
+    std::erase_if(eventLoop.IdleConnections, [this, &isExpired, currentTimePoint](const auto& idleConnection) {
+        const Connection& connection{ *idleConnection.second };
 
-        // Step 5
-        // Send each found file path
-        for (const std::string& filePath : foundFilesPaths)
+        if (!connection.OutputBuffer.empty())
         {
-            const uint32_t filePathLength{ static_cast<uint32_t>(filePath.size()) };
-            const uint32_t filePathLengthNetworkOrder{ htonl(filePathLength) };
+            if (!isExpired(currentTimePoint - connection.LastSendTimePoint, m_Config.WriteTimeoutMS))
+                return false;
 
-            Utils::SendAll(clientSocket, reinterpret_cast<const char*>(&filePathLengthNetworkOrder), sizeof(filePathLengthNetworkOrder));
+            LOG_WARN_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Client {0} has not read its responses in time", connection.Peer);
+            return true;
+        }
 
-            if (filePathLength == 0u)
-                continue;
+        if (!connection.InputBuffer.empty() && isExpired(currentTimePoint - connection.RequestStartTimePoint, m_Config.ReadTimeoutMS))
+        {
+            LOG_WARN_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Client {0} has not sent a complete request in time", connection.Peer);
+            return true;
+        }
 
-            Utils::SendAll(clientSocket, filePath.data(), filePathLength);
+        if (connection.InputBuffer.empty() && isExpired(currentTimePoint - connection.LastActivityTimePoint, m_Config.IdleTimeoutMS))
+        {
+            LOG_DEBUG_TAG("SERVER", "Client {0} has been idle for too long", connection.Peer);
+            return true;
         }
-    }
+
+        return false;
+    });
+}
+
+void Server::WakeUpRoutine(const EventLoop& eventLoop)
+{
+    constexpr char wakeupSignal{ 0 };
+    send(eventLoop.WakeupSocket, &wakeupSignal, sizeof(wakeupSignal), 0);
 }
 
-void Server::HandleHTTPClient(SOCKET clientSocket)
+bool Server::ReceiveFromConnection(Connection& connection)
 {
-    std::string        requestStr{};
-    constexpr uint32_t bufferSize{ 1024u };
+    constexpr uint32_t bufferSize{ 4096u };
     char               buffer[bufferSize]{};
 
-    while (requestStr.find("\r\n\r\n") == std::string::npos)
+    while (true)
     {
-        int bytesReceived{ recv(clientSocket, buffer, bufferSize - 1u, 0) };
+        const int bytesReceived{ recv(connection.Socket, buffer, bufferSize, 0) };
         if (bytesReceived == SOCKET_ERROR)
         {
             const int error{ WSAGetLastError() };
             switch (error)
             {
                 case WSAEWOULDBLOCK:
-                    continue;
+                    return true;
                 default:
-                    throw std::runtime_error(std::format("Recv failed: {0}", error).c_str());
+                    LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Recv from the client {0} failed: {1}", connection.Peer, error);
+                    return false;
             }
         }
         else if (bytesReceived == 0) // The connection has been gracefully closed
         {
-            return;
+            return false;
         }
 
-        buffer[bytesReceived] = '\0';
-        requestStr.append(buffer, bytesReceived);
-    }
-
-    std::istringstream requestStream{ requestStr };
-    std::string        requestLine{};
-    if (std::getline(requestStream, requestLine); requestLine.empty())
-        throw std::runtime_error("Empty request line from HTTP request");
+        connection.LastActivityTimePoint = std::chrono::steady_clock::now();
 
-    if (requestLine.back() == '\r')
-        requestLine.pop_back();
+        if (connection.InputBuffer.empty())
+            connection.RequestStartTimePoint = connection.LastActivityTimePoint;
 
-    std::istringstream requestLineStream{ requestLine };
-    std::string        method{}, path{}, httpVersion{};
-    requestLineStream >> method >> path >> httpVersion;
+        connection.InputBuffer.append(buffer, bytesReceived);
 
-    if (method.empty() || method != "GET")
-    {
-        std::string response{ "HTTP/1.1 405 Method Not Allowed\r\n"
-                              "Content-Length: 0\r\n"
-                              "Connection: close\r\n\r\n" };
-        Utils::SendAll(clientSocket, response.data(), response.size());
-        return;
+        // The socket has been drained, skip the recv() that would only report WSAEWOULDBLOCK
+        if (static_cast<uint32_t>(bytesReceived) < bufferSize)
+            return true;
     }
+}
 
-    std::unordered_map<std::string, std::string> headers{};
-    std::string                                  headerLine{};
-    while (std::getline(requestStream, headerLine) && !headerLine.empty() && headerLine != "\r")
+bool Server::FlushConnection(Connection& connection)
+{
+    // Send as much as the socket takes without blocking, the rest waits for the loop to poll the socket as writable
+    while (!connection.OutputBuffer.empty())
     {
-        if (headerLine.back() == '\r')
-            headerLine.pop_back();
+        const int bytesSent{ send(connection.Socket, connection.OutputBuffer.data(), static_cast<int>(std::min<size_t>(connection.OutputBuffer.size(), s_SendBufferSize)), 0) };
+        if (bytesSent == SOCKET_ERROR)
+        {
+            const int error{ WSAGetLastError() };
+            switch (error)
+            {
+                case WSAEWOULDBLOCK:
+                    return true;
+                default:
+                    LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Send to the client {0} failed: {1}", connection.Peer, error);
+                    return false;
+            }
+        }
 
-        const size_t colonPos{ headerLine.find(':') };
-        if (colonPos == std::string::npos)
-            continue;
+        connection.OutputBuffer.erase(0u, bytesSent);
+        connection.LastSendTimePoint = std::chrono::steady_clock::now();
+    }
 
-        const std::string headerName{ headerLine.substr(0u, colonPos) };
-        const std::string headerValue{ headerLine.substr(colonPos + 1u) };
+    // A large response does not keep its memory for the lifetime of the connection
+    if (connection.OutputBuffer.capacity() > s_SendBufferSize)
+        connection.OutputBuffer = std::string{};
 
-        headers[headerName] = headerValue.substr(headerValue.find_first_not_of(' '));
-    }
+    return true;
+}
 
-    std::string  queryStr{};
-    const size_t queryPos{ path.find('?') };
-    if (queryPos != std::string::npos)
-    {
-        queryStr = path.substr(queryPos + 1u);
-        path.resize(queryPos); // path = path.substr(0u, queryPos);
-    }
+size_t Server::GetCompleteRequestLength(Connection& connection)
+{
+    const std::string_view inputData{ connection.InputBuffer };
 
-    std::unordered_map<std::string, std::string> queryParams{};
-    std::istringstream                           queryStream{ queryStr };
-    std::string                                  keyValuePair{};
-    while (std::getline(queryStream, keyValuePair, '&'))
+    if (connection.Protocol == ConnectionProtocol::Unknown)
     {
-        const size_t equalPos{ keyValuePair.find('=') };
-        if (equalPos == std::string::npos)
-            continue;
+        TRACE_SCOPE("Server::SniffProtocol");
 
-        const std::string key{ keyValuePair.substr(0u, equalPos) };
-        const std::string value{ keyValuePair.substr(equalPos + 1u) };
+        // HTTP requests start with a method name, binary frames start with a frame type byte
+        using namespace std::literals;
+        constexpr std::array httpMethods{ "GET"sv, "POST"sv, "PUT"sv, "DELETE"sv, "HEAD"sv, "CONNECT"sv, "OPTIONS"sv, "TRACE"sv, "PATCH"sv };
 
-        queryParams[Utils::UrlDecode(key)] = Utils::UrlDecode(value);
-    }
+        bool mayBeHTTPRequest{ false };
+        for (const std::string_view httpMethod : httpMethods)
+        {
+            if (inputData.starts_with(httpMethod))
+            {
+                connection.Protocol = ConnectionProtocol::HTTP;
+                break;
+            }
 
-    if (!queryParams.contains("q"))
-    {
-        std::string response{ "HTTP/1.1 400 Bad Request\r\n"
-                              "Content-Length: 0\r\n"
-                              "Connection: close\r\n\r\n" };
-        Utils::SendAll(clientSocket, response.data(), response.size());
-        return;
-    }
+            mayBeHTTPRequest |= httpMethod.starts_with(inputData);
+        }
 
-    const std::string_view   query{ queryParams["q"] };
-    const auto&              foundFiles{ m_InvertedIndex.Search(query) };
-    std::vector<std::string> foundFilesPaths{};
-    foundFilesPaths.reserve(foundFiles.size());
+        if (connection.Protocol == ConnectionProtocol::Unknown)
+        {
+            if (mayBeHTTPRequest)
+                return 0u;
 
-    std::ranges::for_each(foundFiles, [this, &foundFilesPaths](const FileSystem::FileID fileID) { foundFilesPaths.emplace_back(m_FileSystem.GetPath(fileID)); });
+            connection.Protocol = ConnectionProtocol::Binary;
+        }
+    }
 
-    std::ostringstream jsonStream{};
-    jsonStream << "{ \"results\": [";
-    for (size_t i{ 0u }; i < foundFilesPaths.size(); ++i)
+    switch (connection.Protocol)
     {
-        std::string escapedFilePath{};
-        for (const char c : foundFilesPaths[i])
+        case ConnectionProtocol::HTTP:
         {
-            if (c == '\\' || c == '"')
-                escapedFilePath.push_back('\\');
-            escapedFilePath.push_back(c);
-        }
+            const size_t headersEndPos{ inputData.find("\r\n\r\n") };
+            if (headersEndPos == std::string_view::npos)
+            {
+                if (inputData.size() > s_MaxHTTPHeadersSize)
+                    throw std::runtime_error("HTTP request headers are too large");
 
-        jsonStream << "\"" << escapedFilePath << "\"";
-        if (i + 1 < foundFilesPaths.size())
-            jsonStream << ", ";
-    }
-    jsonStream << "] }";
+                return 0u;
+            }
 
-    const std::string jsonBody{ jsonStream.str() };
+            const size_t contentLength{ HTTP::GetContentLength(inputData.substr(0u, headersEndPos)) };
+            if (contentLength > s_MaxHTTPBodySize)
+                throw std::runtime_error("HTTP request body is too large");
 
-    std::ostringstream responseStream{};
-    responseStream << "HTTP/1.1 200 OK\r\n"
-                   << "Content-Type: application/json\r\n"
-                   << "Content-Length: " << jsonBody.size() << "\r\n"
-                   << "Connection: close\r\n\r\n"
-                   << jsonBody;
+            const size_t requestLength{ headersEndPos + 4u + contentLength };
 
-    const std::string httpResponse{ responseStream.str() };
-    Utils::SendAll(clientSocket, httpResponse.data(), httpResponse.size());
+            return inputData.size() >= requestLength ? requestLength : 0u;
+        }
+        case ConnectionProtocol::Binary:
+        {
+            if (inputData.size() < sizeof(uint32_t))
+                return 0u;
+
+            const uint32_t requestHeader{ Utils::ReadUInt32NetworkOrder(inputData.data()) };
+            const size_t   requestLength{ sizeof(uint32_t) + (requestHeader & s_BinaryFramePayloadLengthMask) };
+
+            return inputData.size() >= requestLength ? requestLength : 0u;
+        }
+        default:
+            return 0u;
+    }
 }
 
-namespace Utils
+bool Server::DispatchRequest(EventLoop& eventLoop, const ConnectionRef& connection)
 {
-    namespace
+    // The responses go out in the order of the requests, the next one is only dispatched once the previous ones have been flushed
+    while (connection->OutputBuffer.empty())
     {
-        void RecvAll(SOCKET socket, char* buffer, uint32_t length)
+        const size_t requestLength{ GetCompleteRequestLength(*connection) };
+        if (requestLength == 0u)
+            return false;
+
+        const std::chrono::steady_clock::time_point receiveTimePoint{ connection->LastActivityTimePoint };
+        connection->RequestStartTimePoint = receiveTimePoint;
+
+        // The request is processed where it has been received and only then dropped from the buffer: the loop reads nothing
+        // more from the connection until it is done, whether the loop or a worker processes it
+        const std::string_view request{ connection->InputBuffer.data(), requestLength };
+
+        if (!IsOverloaded())
         {
-            uint32_t totalBytesReceived{ 0u };
-            while (totalBytesReceived < length)
+            m_InFlightRequestsCount.fetch_add(1u);
+
+            // An event loop answers the quick requests of its clients itself, one after another on its own core, and buffers the
+            // responses the sockets do not take right away, so that a client that reads slowly only holds up itself
+            if (m_Config.EventLoopsCount != 0u)
             {
-                const int bytesReceived{ recv(socket, buffer + totalBytesReceived, static_cast<int>(length - totalBytesReceived), 0) };
-                if (bytesReceived == SOCKET_ERROR)
-                {
-                    const int error{ WSAGetLastError() };
-                    switch (error)
-                    {
-                        case WSAEWOULDBLOCK:
-                            continue;
-                        default:
-                            throw std::runtime_error(std::format("Recv failed: {0}", error).c_str());
-                    }
-                }
-                else if (bytesReceived == 0) // The connection has been gracefully closed
+                // An HTTP request is parsed once, both to tell whether it is quick and to answer it. A slow one is parsed again
+                // by its worker, the arena of the loop cannot be handed over to another thread
+                ScratchArena                       scratchArena{};
+                const std::optional<HTTP::Request> httpRequest{ TryParseHTTPRequest(*connection, request, scratchArena.GetResource()) };
+                const HTTP::Request*               parsedRequest{ httpRequest ? &*httpRequest : nullptr };
+
+                if (!IsSlowRequest(*connection, request, parsedRequest))
                 {
-                    memset(buffer, 0, length);
-                    return;
-                }
+                    connection->IsClosing = !ProcessRequest(*connection, request, parsedRequest, receiveTimePoint, &connection->OutputBuffer);
+                    connection->InputBuffer.erase(0u, requestLength);
+                    connection->LastSendTimePoint = std::chrono::steady_clock::now();
 
-                totalBytesReceived += bytesReceived;
-            }
+                    if (!FlushConnection(*connection) || (connection->IsClosing && connection->OutputBuffer.empty()))
+                        return true;
+
+                    continue;
+                }
+            }
+
+            try
+            {
+                // Five words, within the small-object buffer of std::function on MSVC, so queueing it allocates nothing
+                m_ThreadPool.AddDetachedTask(SERVER_TASK_PRIORITY_HANDLE_CLIENT, [this, &eventLoop, connection, requestLength, receiveTimePoint]() {
+                    if (!ProcessRequest(*connection, { connection->InputBuffer.data(), requestLength }, nullptr, receiveTimePoint, nullptr))
+                        return;
+
+                    connection->InputBuffer.erase(0u, requestLength);
+                    ResumeConnection(eventLoop, connection);
+                });
+            }
+            catch (...)
+            {
+                // The ThreadPool is shutting down, the request will never be processed
+                m_InFlightRequestsCount.fetch_sub(1u);
+                throw;
+            }
+
+            return true;
+        }
+
+        connection->InputBuffer.erase(0u, requestLength);
+
+        m_Metrics.ShedRequestsCount.Increment();
+        LOG_WARN_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Shedding a request of the client {0}: {1} requests in flight, {2} queued", connection->Peer, m_InFlightRequestsCount.load(), m_ThreadPool.GetQueuedTasksCount(SERVER_TASK_PRIORITY_HANDLE_CLIENT));
+
+        // The routine must never block on a client, the connection is dropped if the rejection does not fit into the socket buffer
+        if (!ShedRequest(*connection, BINARY_ERROR_CODE_OVERLOADED))
+            return true;
+    }
+
+    return false;
+}
+
+bool Server::IsOverloaded() const
+{
+    // Only the client tasks are counted, the crawler and the indexing tasks may queue by the thousands on a large tree, and
+    // the helpers of a heavy search by as many as there are workers
+    return m_InFlightRequestsCount.load() >= m_Config.MaxInFlightRequests
+        || m_ThreadPool.GetQueuedTasksCount(SERVER_TASK_PRIORITY_HANDLE_CLIENT) >= m_Config.MaxQueuedRequests;
+}
+
+bool Server::IsSlowRequest(const Connection& connection, std::string_view request, const HTTP::Request* httpRequest) const
+{
+    // A coordinator waits for its shards on every search
+    if (m_QueryCoordinator)
+        return true;
+
+    // A loop buffers a whole response before flushing any of it, so the searches whose results are not bounded by a page
+    // are answered by the workers, which send them a chunk at a time. So are the pages past s_MaxEventLoopOffset, the
+    // search of a page keeps and sorts the top Offset + Limit hits
+    if (connection.Protocol == ConnectionProtocol::Binary)
+    {
+        const auto isOffsetAbove{ [&request](size_t offsetPosition, size_t maxOffset) {
+            return request.size() < offsetPosition + sizeof(uint32_t) || Utils::ReadUInt32NetworkOrder(request.data() + offsetPosition) > maxOffset;
+        } };
+
+        switch (static_cast<BinaryFrameType>(Utils::ReadUInt32NetworkOrder(request.data()) >> 24u))
+        {
+            case BINARY_FRAME_TYPE_SEARCH: // Every result, the legacy frame has no limit
+            case BINARY_FRAME_TYPE_SEARCH_BATCH:
+            case BINARY_FRAME_TYPE_FETCH_SEGMENT:
+                return true;
+            case BINARY_FRAME_TYPE_SEARCH_PAGE:
+                return isOffsetAbove(sizeof(uint32_t), s_MaxEventLoopOffset);
+            case BINARY_FRAME_TYPE_SEARCH_SCORED: // The limit is not capped
+                return isOffsetAbove(sizeof(uint32_t), s_MaxEventLoopOffset) || isOffsetAbove(2u * sizeof(uint32_t), s_MaxPageSize);
+            default:
+                return false;
+        }
+    }
+
+    // A malformed request is rejected by ProcessRequest() wherever it runs
+    if (httpRequest == nullptr)
+        return false;
+
+    // Only POST /search/batch and POST /stats/compact take a POST, the other requests get 405 from wherever they run
+    if (httpRequest->Method == "POST")
+        return true;
+
+    // "limit=all" streams every result, "snippets=1" reads the files whose contents are not in memory from the disk
+    const HTTPQueryParams& queryParams{ httpRequest->QueryParams };
+
+    const auto offsetIt{ queryParams.find("offset") };
+    const auto limitIt{ queryParams.find("limit") };
+    const auto snippetsIt{ queryParams.find("snippets") };
+
+    size_t offset{ 0u };
+    if (offsetIt != queryParams.end() && HTTP::ParseSize(offsetIt->second, offset) && offset > s_MaxEventLoopOffset)
+        return true;
+
+    return (limitIt != queryParams.end() && limitIt->second == "all") || (snippetsIt != queryParams.end() && snippetsIt->second == "1");
+}
+
+std::optional<HTTP::Request> Server::TryParseHTTPRequest(const Connection& connection, std::string_view request, std::pmr::memory_resource* resource)
+{
+    if (connection.Protocol != ConnectionProtocol::HTTP)
+        return std::nullopt;
+
+    try
+    {
+        return HTTP::ParseRequest(request, resource);
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
+}
+
+bool Server::ProcessRequest(const Connection& connection, std::string_view request, const HTTP::Request* httpRequest, std::chrono::steady_clock::time_point receiveTimePoint, std::string* outputBuffer)
+{
+    TRACE_SCOPE("Server::ProcessRequest");
+
+    // Everything the request allocates is released at once when it has been answered
+    ScratchArena scratchArena{};
+
+    RequestContext context{};
+    context.Socket = connection.Socket;
+    context.OutputBuffer = outputBuffer;
+    context.Scratch = scratchArena.GetResource();
+    context.WriteTimeoutMS = m_Config.WriteTimeoutMS != 0u ? static_cast<int>(m_Config.WriteTimeoutMS) : -1;
+
+    if (m_Config.QueryTimeBudgetMS != 0u)
+        context.QueryDeadline = receiveTimePoint + std::chrono::milliseconds(m_Config.QueryTimeBudgetMS);
+
+    bool keepConnection{ false };
+
+    try
+    {
+        // Fail fast if the whole time budget has been spent waiting in the queue
+        if (std::chrono::steady_clock::now() >= context.QueryDeadline)
+        {
+            const std::string_view response{ GetSheddingResponse(connection.Protocol, BINARY_ERROR_CODE_TIMED_OUT) };
+            SendResponse(context, { response });
+
+            keepConnection = connection.Protocol == ConnectionProtocol::Binary;
+        }
+        else
+        {
+            switch (connection.Protocol)
+            {
+                case ConnectionProtocol::HTTP:
+                    if (httpRequest != nullptr)
+                        HandleHTTPRequest(context, *httpRequest);
+                    else
+                        HandleHTTPRequest(context, HTTP::ParseRequest(request, context.Scratch));
+                    break;
+                case ConnectionProtocol::Binary:
+                    keepConnection = HandleSocketRequest(context, request);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR_TAG_THROTTLED("SERVER", s_LogThrottleIntervalMS, "Client {0} exception: {1}", connection.Peer, e.what());
+        keepConnection = false;
+    }
+
+    m_Metrics.RequestLatencies[context.Endpoint].Observe(std::chrono::steady_clock::now() - receiveTimePoint);
+    m_InFlightRequestsCount.fetch_sub(1u);
+
+    // Otherwise the client socket is closed together with the last reference to the connection
+    return keepConnection;
+}
+
+bool Server::ShedRequest(const Connection& connection, BinaryErrorCode errorCode)
+{
+    const std::string_view response{ GetSheddingResponse(connection.Protocol, errorCode) };
+
+    const int bytesSent{ send(connection.Socket, response.data(), static_cast<int>(response.size()), 0) };
+
+    return connection.Protocol == ConnectionProtocol::Binary && bytesSent == static_cast<int>(response.size());
+}
+
+std::string_view Server::GetSheddingResponse(ConnectionProtocol protocol, BinaryErrorCode errorCode)
+{
+    using namespace std::literals;
+
+    if (protocol == ConnectionProtocol::HTTP)
+    {
+        return "HTTP/1.1 503 Service Unavailable\r\n"
+               "Retry-After: 1\r\n"
+               "Content-Length: 0\r\n"
+               "Connection: close\r\n\r\n"sv;
+    }
+
+    // BINARY_ERROR_MARKER followed by the error code, both in network byte order
+    switch (errorCode)
+    {
+        case BINARY_ERROR_CODE_OVERLOADED:
+            return "\xFF\xFF\xFF\xFF\x00\x00\x00\x01"sv;
+        case BINARY_ERROR_CODE_TIMED_OUT:
+            return "\xFF\xFF\xFF\xFF\x00\x00\x00\x02"sv;
+        default:
+            return "\xFF\xFF\xFF\xFF\x00\x00\x00\x00"sv;
+    }
+}
+
+Server::Connection::~Connection()
+{
+    // The requests processed in process have no client, see ProcessHTTPRequest()
+    if (Socket == INVALID_SOCKET)
+        return;
+
+    closesocket(Socket);
+    ClosedConnectionsCount.Increment();
+    LOG_DEBUG_TAG("SERVER", "Closed the client socket {0}", Peer);
+}
+
+bool Server::HandleSocketRequest(RequestContext& context, std::string_view request)
+{
+    // Step 1
+    // Parse the frame header: the frame type and the payload length (4 bytes, network byte order)
+    const uint32_t requestHeader{ Utils::ReadUInt32NetworkOrder(request.data()) };
+
+    if (requestHeader == 0u)
+        return false;
+
+    const auto frameType{ static_cast<BinaryFrameType>(requestHeader >> 24u) };
+
+    if (frameType == BINARY_FRAME_TYPE_SEARCH_BATCH)
+    {
+        context.Endpoint = SERVER_ENDPOINT_BINARY_SEARCH_BATCH;
+        HandleSocketSearchBatch(context, request.substr(sizeof(uint32_t)));
+        return true;
+    }
+
+    if (frameType == BINARY_FRAME_TYPE_SEARCH_SCORED)
+    {
+        context.Endpoint = SERVER_ENDPOINT_BINARY_SEARCH_SCORED;
+        HandleSocketSearchScored(context, request.substr(sizeof(uint32_t)));
+        return true;
+    }
+
+    if (frameType == BINARY_FRAME_TYPE_FETCH_SEGMENT)
+    {
+        context.Endpoint = SERVER_ENDPOINT_BINARY_FETCH_SEGMENT;
+        HandleSocketFetchSegment(context, request.substr(sizeof(uint32_t)));
+        return true;
+    }
+
+    // Step 2
+    // The payload follows the header, the routine has already received all of it
+    std::string_view             query{ request.substr(sizeof(uint32_t)) };
+    InvertedIndex::SearchOptions searchOptions{};
+    searchOptions.Deadline = context.QueryDeadline;
+
+    switch (frameType)
+    {
+        case BINARY_FRAME_TYPE_SEARCH:
+            context.Endpoint = SERVER_ENDPOINT_BINARY_SEARCH;
+            break;
+        case BINARY_FRAME_TYPE_SEARCH_PAGE:
+        {
+            context.Endpoint = SERVER_ENDPOINT_BINARY_SEARCH_PAGE;
+
+            if (query.size() < 2u * sizeof(uint32_t))
+                throw std::runtime_error("Malformed search page frame");
+
+            const uint32_t limit{ Utils::ReadUInt32NetworkOrder(query.data() + sizeof(uint32_t)) };
+
+            searchOptions.Offset = Utils::ReadUInt32NetworkOrder(query.data());
+            searchOptions.Limit = limit == 0u ? s_DefaultPageSize : std::min<size_t>(limit, s_MaxPageSize);
+
+            query.remove_prefix(2u * sizeof(uint32_t));
+            break;
+        }
+        default:
+            throw std::runtime_error(std::format("Unknown binary frame type: {0}", static_cast<uint32_t>(frameType)).c_str());
+    }
+
+    // Step 3
+    // Search the query in the inverted index
+    const InvertedIndex::SearchResult searchResult{ Search(query, searchOptions, context.Scratch) };
+
+    std::pmr::string sendBuffer{ context.Scratch };
+    sendBuffer.reserve(std::min(s_SendBufferSize, searchResult.FileIDs.size() * 64u + 2u * sizeof(uint32_t)));
+
+    // Step 4
+    // Send the search result
+    SendSocketSearchResult(context, sendBuffer, searchResult, frameType == BINARY_FRAME_TYPE_SEARCH_PAGE);
+
+    SendResponse(context, { sendBuffer });
+
+    return true;
+}
+
+void Server::HandleSocketSearchBatch(const RequestContext& context, std::string_view payload)
+{
+    // Step 1
+    // Parse the offset, the limit and the number of the queries (4 bytes each, network byte order)
+    if (payload.size() < 3u * sizeof(uint32_t))
+        throw std::runtime_error("Malformed search batch frame");
+
+    const uint32_t limit{ Utils::ReadUInt32NetworkOrder(payload.data() + sizeof(uint32_t)) };
+    const uint32_t queriesCount{ Utils::ReadUInt32NetworkOrder(payload.data() + 2u * sizeof(uint32_t)) };
+
+    InvertedIndex::SearchOptions searchOptions{};
+    searchOptions.Offset = Utils::ReadUInt32NetworkOrder(payload.data());
+    searchOptions.Limit = limit == 0u ? s_DefaultPageSize : std::min<size_t>(limit, s_MaxPageSize);
+    searchOptions.Deadline = context.QueryDeadline;
+
+    if (queriesCount > s_MaxBatchSize)
+        throw std::runtime_error(std::format("Search batch is too large: {0} queries", queriesCount).c_str());
+
+    payload.remove_prefix(3u * sizeof(uint32_t));
+
+    // Step 2
+    // Parse each query: its length (4 bytes, network byte order) and the query string
+    std::pmr::vector<std::string_view> queries{ context.Scratch };
+    queries.reserve(queriesCount);
+
+    for (uint32_t i{ 0u }; i < queriesCount; ++i)
+    {
+        if (payload.size() < sizeof(uint32_t))
+            throw std::runtime_error("Malformed search batch frame");
+
+        const uint32_t queryLength{ Utils::ReadUInt32NetworkOrder(payload.data()) };
+        payload.remove_prefix(sizeof(uint32_t));
+
+        if (payload.size() < queryLength)
+            throw std::runtime_error("Malformed search batch frame");
+
+        queries.push_back(payload.substr(0u, queryLength));
+        payload.remove_prefix(queryLength);
+    }
+
+    // Step 3
+    // Search all the queries at once
+    const InvertedIndex::BatchSearchResult batchResult{ SearchBatch(queries, searchOptions) };
+
+    // Step 4
+    // Send the number of the queries, then the result of each query in order
+    std::pmr::string sendBuffer{ context.Scratch };
+    sendBuffer.reserve(s_SendBufferSize);
+
+    Utils::AppendUInt32NetworkOrder(sendBuffer, queriesCount);
+
+    for (const size_t resultIndex : batchResult.ResultIndices)
+        SendSocketSearchResult(context, sendBuffer, batchResult.Results[resultIndex], true);
+
+    SendResponse(context, { sendBuffer });
+}
+
+void Server::HandleSocketSearchScored(const RequestContext& context, std::string_view payload)
+{
+    // Step 1
+    // Parse the offset and the limit (4 bytes each, network byte order), the query follows
+    if (payload.size() < 2u * sizeof(uint32_t))
+        throw std::runtime_error("Malformed scored search frame");
+
+    InvertedIndex::SearchOptions searchOptions{};
+    searchOptions.Offset = Utils::ReadUInt32NetworkOrder(payload.data());
+    searchOptions.Limit = Utils::ReadUInt32NetworkOrder(payload.data() + sizeof(uint32_t));
+    searchOptions.Deadline = context.QueryDeadline;
+    searchOptions.WithScores = true;
+
+    const std::string_view query{ payload.substr(2u * sizeof(uint32_t)) };
+
+    // Step 2
+    // Search the query, a coordinator may itself be the shard of another one
+    const InvertedIndex::SearchResult searchResult{ Search(query, searchOptions, context.Scratch) };
+
+    // Step 3
+    // Send the total, the partial flag, the files, then their scores
+    std::pmr::string sendBuffer{ context.Scratch };
+    sendBuffer.reserve(std::min(s_SendBufferSize, searchResult.FileIDs.size() * 68u + 3u * sizeof(uint32_t)));
+
+    Utils::AppendUInt32NetworkOrder(sendBuffer, static_cast<uint32_t>(searchResult.TotalHitsCount));
+    Utils::AppendUInt32NetworkOrder(sendBuffer, searchResult.IsPartial ? 1u : 0u);
+
+    SendSocketSearchResult(context, sendBuffer, searchResult, false);
+
+    for (const uint32_t score : searchResult.Scores)
+    {
+        Utils::AppendUInt32NetworkOrder(sendBuffer, score);
+
+        if (sendBuffer.size() >= s_SendBufferSize)
+        {
+            SendResponse(context, { sendBuffer });
+            sendBuffer.clear();
+        }
+    }
+
+    SendResponse(context, { sendBuffer });
+}
+
+void Server::HandleSocketFetchSegment(const RequestContext& context, std::string_view payload)
+{
+    // Step 1
+    // Parse the log ID and the version of the last segment the replica has loaded (4 bytes each, network byte order)
+    if (!m_ReplicationLog)
+        throw std::runtime_error("Segments are only served by a primary");
+
+    if (payload.size() < 2u * sizeof(uint32_t))
+        throw std::runtime_error("Malformed fetch segment frame");
+
+    const uint32_t replicaLogID{ Utils::ReadUInt32NetworkOrder(payload.data()) };
+    const uint32_t replicaVersion{ Utils::ReadUInt32NetworkOrder(payload.data() + sizeof(uint32_t)) };
+
+    // Step 2
+    // Pick the next segment. A replica of another log, or one whose next segment has been merged into the snapshot, is sent
+    // the snapshot or the first segment and tells the reload from the first version and the log ID
+    const ReplicationLog::Segment segment{ m_ReplicationLog->GetNextSegment(replicaLogID, replicaVersion) };
+
+    std::pmr::string sendBuffer{ context.Scratch };
+    sendBuffer.reserve(s_SendBufferSize);
+
+    Utils::AppendUInt32NetworkOrder(sendBuffer, m_ReplicationLog->GetLogID());
+
+    if (segment.LastVersion == 0u)
+    {
+        Utils::AppendUInt32NetworkOrder(sendBuffer, 0u);
+        Utils::AppendUInt32NetworkOrder(sendBuffer, 0u);
+        Utils::AppendUInt32NetworkOrder(sendBuffer, 0u);
+        SendResponse(context, { sendBuffer });
+        return;
+    }
+
+    // The files merged into a newer snapshot meanwhile may be gone, the replica fetches again at its next synchronization
+    std::error_code errorCode{};
+    const uintmax_t segmentSize{ std::filesystem::file_size(segment.Path, errorCode) };
+
+    std::ifstream stream{ segment.Path, std::ios::in | std::ios::binary };
+    if (errorCode || !stream.is_open() || segmentSize > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error(std::format("Failed to serve the segments {0} to {1}", segment.FirstVersion, segment.LastVersion).c_str());
+
+    Utils::AppendUInt32NetworkOrder(sendBuffer, segment.FirstVersion);
+    Utils::AppendUInt32NetworkOrder(sendBuffer, segment.LastVersion);
+    Utils::AppendUInt32NetworkOrder(sendBuffer, static_cast<uint32_t>(segmentSize));
+
+    // Step 3
+    // Stream the segment through the send buffer, the first chunk goes out together with the header
+    size_t headerSize{ sendBuffer.size() };
+    sendBuffer.resize(s_SendBufferSize);
+
+    for (uintmax_t remainingBytes{ segmentSize }; remainingBytes > 0u;)
+    {
+        const size_t chunkSize{ static_cast<size_t>(std::min<uintmax_t>(remainingBytes, s_SendBufferSize - headerSize)) };
+
+        stream.read(sendBuffer.data() + headerSize, static_cast<std::streamsize>(chunkSize));
+        if (static_cast<size_t>(stream.gcount()) != chunkSize)
+            throw std::runtime_error(std::format("Failed to read the segments {0} to {1}", segment.FirstVersion, segment.LastVersion).c_str());
+
+        SendResponse(context, { std::string_view{ sendBuffer.data(), headerSize + chunkSize } });
+
+        headerSize = 0u;
+        remainingBytes -= chunkSize;
+    }
+}
+
+void Server::SendSocketSearchResult(const RequestContext& context, std::pmr::string& sendBuffer, const InvertedIndex::SearchResult& searchResult, bool withTotalHitsCount)
+{
+    TRACE_SCOPE("Server::SendSocketSearchResult");
+
+    // The total number of the found files (if requested) and the number of the returned files (4 bytes each, network byte order)
+    if (withTotalHitsCount)
+        Utils::AppendUInt32NetworkOrder(sendBuffer, static_cast<uint32_t>(searchResult.TotalHitsCount));
+
+    Utils::AppendUInt32NetworkOrder(sendBuffer, static_cast<uint32_t>(searchResult.FileIDs.size()));
+
+    // Each found file path, the send buffer is flushed whenever it fills up so memory stays bounded
+    for (size_t i{ 0u }; i < searchResult.FileIDs.size(); ++i)
+    {
+        // The path is decoded straight into the buffer, its length is filled in afterwards. A coordinator has the paths of
+        // the files of its shards in the result
+        const size_t lengthOffset{ sendBuffer.size() };
+        Utils::AppendUInt32NetworkOrder(sendBuffer, 0u);
+
+        if (searchResult.Paths.empty())
+            m_FileSystem.AppendPath(searchResult.FileIDs[i], sendBuffer);
+        else
+            sendBuffer.append(searchResult.Paths[i]);
+
+        Utils::WriteUInt32NetworkOrder(sendBuffer.data() + lengthOffset, static_cast<uint32_t>(sendBuffer.size() - lengthOffset - sizeof(uint32_t)));
+
+        if (sendBuffer.size() >= s_SendBufferSize)
+        {
+            SendResponse(context, { sendBuffer });
+            sendBuffer.clear();
+        }
+    }
+}
+
+void Server::HandleHTTPRequest(RequestContext& context, const HTTP::Request& httpRequest)
+{
+    if (httpRequest.Path == "/trace")
+    {
+        context.Endpoint = SERVER_ENDPOINT_HTTP_TRACE;
+
+        if (httpRequest.Method != "GET")
+            SendHTTPStatus(context, "405 Method Not Allowed");
+        else
+            HandleHTTPTrace(context, httpRequest.QueryParams);
+
+        return;
+    }
+
+    if (httpRequest.Path == "/metrics")
+    {
+        context.Endpoint = SERVER_ENDPOINT_HTTP_METRICS;
+
+        if (httpRequest.Method != "GET")
+            SendHTTPStatus(context, "405 Method Not Allowed");
+        else
+            HandleHTTPMetrics(context);
+
+        return;
+    }
+
+    if (httpRequest.Path == "/stats")
+    {
+        context.Endpoint = SERVER_ENDPOINT_HTTP_STATS;
+
+        if (httpRequest.Method != "GET")
+            SendHTTPStatus(context, "405 Method Not Allowed");
+        else
+            HandleHTTPStats(context);
+
+        return;
+    }
+
+    if (httpRequest.Path == "/stats/compact")
+    {
+        context.Endpoint = SERVER_ENDPOINT_HTTP_COMPACT;
+
+        if (httpRequest.Method != "POST")
+            SendHTTPStatus(context, "405 Method Not Allowed");
+        else
+            HandleHTTPCompact(context);
+
+        return;
+    }
+
+    if (httpRequest.Path == "/search/batch")
+    {
+        context.Endpoint = SERVER_ENDPOINT_HTTP_SEARCH_BATCH;
+
+        if (httpRequest.Method != "POST")
+            SendHTTPStatus(context, "405 Method Not Allowed");
+        else
+            HandleHTTPSearchBatch(context, httpRequest.QueryParams, httpRequest.Body);
+
+        return;
+    }
+
+    if (httpRequest.Method.empty() || httpRequest.Method != "GET")
+    {
+        SendHTTPStatus(context, "405 Method Not Allowed");
+        return;
+    }
+
+    context.Endpoint = SERVER_ENDPOINT_HTTP_SEARCH;
+    HandleHTTPSearch(context, httpRequest.QueryParams);
+}
+
+void Server::HandleHTTPSearch(const RequestContext& context, const HTTPQueryParams& queryParams)
+{
+    const auto queryIt{ queryParams.find("q") };
+
+    const auto snippetsIt{ queryParams.find("snippets") };
+
+    // "limit=all" streams every result with the chunked transfer encoding instead of returning a single page.
+    // "snippets=1" adds highlighted windows of the content of the first files of the page. A coordinator does not have
+    // the files of its shards, it rejects the option
+    InvertedIndex::SearchOptions searchOptions{ .Offset = 0u, .Limit = s_DefaultPageSize, .Deadline = context.QueryDeadline };
+    bool                         streamAllResults{ false };
+    const bool                   withSnippets{ snippetsIt != queryParams.end() && snippetsIt->second == "1" };
+
+    if (queryIt == queryParams.end() || !ParseHTTPPagination(queryParams, searchOptions, streamAllResults) || (snippetsIt != queryParams.end() && !withSnippets && snippetsIt->second != "0")
+        || (withSnippets && m_QueryCoordinator))
+    {
+        SendHTTPStatus(context, "400 Bad Request");
+        return;
+    }
+
+    const std::string_view            query{ queryIt->second };
+    const InvertedIndex::SearchResult searchResult{ Search(query, searchOptions, context.Scratch) };
+
+    std::pmr::string jsonBody{ context.Scratch };
+    jsonBody.reserve(streamAllResults ? s_SendBufferSize : searchResult.FileIDs.size() * 64u + 64u);
+    std::format_to(std::back_inserter(jsonBody), "{{ \"total\": {0}, \"offset\": {1}, \"partial\": {2}, \"results\": [", searchResult.TotalHitsCount, searchOptions.Offset, searchResult.IsPartial);
+
+    if (streamAllResults)
+    {
+        constexpr std::string_view responseHeaders{ "HTTP/1.1 200 OK\r\n"
+                                                    "Content-Type: application/json\r\n"
+                                                    "Transfer-Encoding: chunked\r\n"
+                                                    "Connection: close\r\n\r\n" };
+        SendResponse(context, { responseHeaders });
+    }
+
+    AppendJSONPaths(context, jsonBody, searchResult, streamAllResults);
+
+    jsonBody.push_back(']');
+
+    if (withSnippets)
+        AppendJSONSnippets(context, jsonBody, query, searchResult.FileIDs);
+
+    jsonBody.append(" }");
+
+    if (streamAllResults)
+    {
+        SendHTTPChunk(context, jsonBody);
+        SendHTTPChunk(context, {}); // The last chunk
+        return;
+    }
+
+    SendHTTPBody(context, "application/json", jsonBody);
+}
+
+void Server::HandleHTTPSearchBatch(const RequestContext& context, const HTTPQueryParams& queryParams, std::string_view body)
+{
+    InvertedIndex::SearchOptions searchOptions{ .Offset = 0u, .Limit = s_DefaultPageSize, .Deadline = context.QueryDeadline };
+    bool                         isLimitAll{ false };
+
+    // One query per line of the body
+    std::pmr::vector<std::string_view> queries{ context.Scratch };
+    for (const auto line : body | std::views::split('\n'))
+    {
+        std::string_view query{ line.begin(), line.end() };
+        if (query.ends_with('\r'))
+            query.remove_suffix(1u);
+
+        if (!query.empty())
+            queries.push_back(query);
+    }
+
+    if (!ParseHTTPPagination(queryParams, searchOptions, isLimitAll) || isLimitAll || queries.empty() || queries.size() > s_MaxBatchSize)
+    {
+        SendHTTPStatus(context, "400 Bad Request");
+        return;
+    }
+
+    const InvertedIndex::BatchSearchResult batchResult{ SearchBatch(queries, searchOptions) };
+
+    constexpr std::string_view responseHeaders{ "HTTP/1.1 200 OK\r\n"
+                                                "Content-Type: application/json\r\n"
+                                                "Transfer-Encoding: chunked\r\n"
+                                                "Connection: close\r\n\r\n" };
+    SendResponse(context, { responseHeaders });
+
+    // The results are streamed back in the order of the queries
+    std::pmr::string jsonBody{ context.Scratch };
+    jsonBody.reserve(s_SendBufferSize);
+    jsonBody.append("{ \"results\": [");
+
+    for (size_t i{ 0u }; i < queries.size(); ++i)
+    {
+        const InvertedIndex::SearchResult& searchResult{ batchResult.Results[batchResult.ResultIndices[i]] };
+
+        if (i > 0u)
+            jsonBody.append(", ");
+
+        jsonBody.append("{ \"query\": \"");
+        HTTP::AppendJSONEscaped(jsonBody, queries[i]);
+        std::format_to(std::back_inserter(jsonBody), "\", \"total\": {0}, \"partial\": {1}, \"results\": [", searchResult.TotalHitsCount, searchResult.IsPartial);
+
+        AppendJSONPaths(context, jsonBody, searchResult, true);
+
+        jsonBody.append("] }");
+    }
+
+    jsonBody.append("] }");
+
+    SendHTTPChunk(context, jsonBody);
+    SendHTTPChunk(context, {}); // The last chunk
+}
+
+void Server::HandleHTTPTrace(const RequestContext& context, const HTTPQueryParams& queryParams)
+{
+    // "enable=1" starts a new recording, "enable=0" stops it, the events recorded so far are returned otherwise
+    if (const auto enableIt{ queryParams.find("enable") }; enableIt != queryParams.end())
+    {
+        if (enableIt->second != "0" && enableIt->second != "1")
+        {
+            SendHTTPStatus(context, "400 Bad Request");
+            return;
+        }
+
+        Tracer::Enable(enableIt->second == "1");
+        SendHTTPStatus(context, "204 No Content");
+        return;
+    }
+
+    const std::string chromeTrace{ Tracer::ExportChromeTrace() };
+
+    SendHTTPBody(context, "application/json", chromeTrace);
+}
+
+void Server::HandleHTTPMetrics(const RequestContext& context)
+{
+    std::string body{};
+    body.reserve(16u * 1024u);
+
+    // Step 1
+    // ThreadPool: saturation and the queueing and running times of the tasks of every priority
+    Metrics::AppendHeader(body, "threadpool_workers", "gauge", "Worker threads of the ThreadPool");
+    Metrics::AppendSample(body, "threadpool_workers", {}, m_ThreadPool.GetWorkersCount());
+    Metrics::AppendHeader(body, "threadpool_busy_workers", "gauge", "Workers running a task");
+    Metrics::AppendSample(body, "threadpool_busy_workers", {}, m_ThreadPool.GetBusyWorkersCount());
+    Metrics::AppendHeader(body, "threadpool_queued_tasks", "gauge", "Tasks waiting for a worker");
+    Metrics::AppendSample(body, "threadpool_queued_tasks", {}, m_ThreadPool.GetQueuedTasksCount());
+
+    const auto appendTaskHistograms{ [this, &body](std::string_view name, std::string_view help, auto getHistogram) {
+        Metrics::AppendHeader(body, name, "histogram", help);
+
+        for (uint32_t priority{ 0u }; priority <= std::numeric_limits<uint8_t>::max(); ++priority)
+        {
+            if (const ThreadPool::TaskMetrics* taskMetrics{ m_ThreadPool.GetTaskMetrics(static_cast<uint8_t>(priority)) })
+                Metrics::AppendHistogram(body, name, std::format("priority=\"{0}\"", priority), getHistogram(*taskMetrics));
+        }
+    } };
+
+    appendTaskHistograms("threadpool_task_wait_seconds", "Time tasks spend queued, by priority (1 helps searches, 2 handles clients, 3 updates the index)",
+        [](const ThreadPool::TaskMetrics& taskMetrics) -> const Metrics::Histogram& { return taskMetrics.WaitTimes; });
+    appendTaskHistograms("threadpool_task_run_seconds", "Time tasks spend running, by priority (1 helps searches, 2 handles clients, 3 updates the index)",
+        [](const ThreadPool::TaskMetrics& taskMetrics) -> const Metrics::Histogram& { return taskMetrics.RunTimes; });
+
+    // Step 2
+    // Connections and requests
+    const uint64_t acceptedConnectionsCount{ m_Metrics.AcceptedConnectionsCount.GetValue() };
+    const uint64_t closedConnectionsCount{ m_Metrics.ClosedConnectionsCount.GetValue() };
+
+    Metrics::AppendHeader(body, "connections_accepted_total", "counter", "Accepted client connections");
+    Metrics::AppendSample(body, "connections_accepted_total", {}, static_cast<double>(acceptedConnectionsCount));
+    Metrics::AppendHeader(body, "connections_active", "gauge", "Open client connections");
+    Metrics::AppendSample(body, "connections_active", {}, static_cast<double>(acceptedConnectionsCount - std::min(closedConnectionsCount, acceptedConnectionsCount)));
+    Metrics::AppendHeader(body, "requests_in_flight", "gauge", "Requests either queued or being processed");
+    Metrics::AppendSample(body, "requests_in_flight", {}, m_InFlightRequestsCount.load());
+    Metrics::AppendHeader(body, "requests_shed_total", "counter", "Requests rejected by the admission control");
+    Metrics::AppendSample(body, "requests_shed_total", {}, static_cast<double>(m_Metrics.ShedRequestsCount.GetValue()));
+
+    Metrics::AppendHeader(body, "request_duration_seconds", "histogram", "Time from the receipt of a request to the end of its response, by endpoint");
+    for (uint8_t endpoint{ 0u }; endpoint < SERVER_ENDPOINTS_COUNT; ++endpoint)
+    {
+        const std::string labels{ std::format("endpoint=\"{0}\"", GetEndpointName(static_cast<ServerEndpoint>(endpoint))) };
+        Metrics::AppendHistogram(body, "request_duration_seconds", labels, m_Metrics.RequestLatencies[endpoint]);
+    }
+
+    // Step 3
+    // Index: size, indexing throughput and freshness
+    const InvertedIndex::Stats indexStats{ m_InvertedIndex.GetStats() };
+
+    Metrics::AppendHeader(body, "index_terms", "gauge", "Distinct terms of the inverted index");
+    Metrics::AppendSample(body, "index_terms", {}, static_cast<double>(indexStats.TermsCount));
+    Metrics::AppendHeader(body, "index_postings", "gauge", "Postings of the inverted index");
+    Metrics::AppendSample(body, "index_postings", {}, static_cast<double>(indexStats.PostingsCount));
+    Metrics::AppendHeader(body, "index_documents", "gauge", "Indexed files");
+    Metrics::AppendSample(body, "index_documents", {}, static_cast<double>(indexStats.DocumentsCount));
+    Metrics::AppendHeader(body, "index_duplicates", "gauge", "Files not indexed themselves because their content is that of an indexed file");
+    Metrics::AppendSample(body, "index_duplicates", {}, static_cast<double>(indexStats.DuplicatesCount));
+
+    std::shared_ptr<IndexingPipeline>     indexingPipeline{};
+    std::chrono::steady_clock::time_point lastUpdateFinishTimePoint{};
+    {
+        std::lock_guard _{ m_IndexingPipelineLock };
+        indexingPipeline = m_IndexingPipeline;
+        lastUpdateFinishTimePoint = m_LastIndexUpdateFinishTimePoint;
+    }
+
+    if (indexingPipeline)
+    {
+        if (indexingPipeline->IsFinished())
+            lastUpdateFinishTimePoint = indexingPipeline->GetFinishTimePoint();
+
+        Metrics::AppendHeader(body, "indexing_bytes", "gauge", "Bytes indexed by the latest index update");
+        Metrics::AppendSample(body, "indexing_bytes", {}, static_cast<double>(indexingPipeline->GetIndexedBytes()));
+        Metrics::AppendHeader(body, "indexing_bytes_per_second", "gauge", "Indexing throughput of the latest index update");
+        Metrics::AppendSample(body, "indexing_bytes_per_second", {}, indexingPipeline->GetIndexingRate());
+    }
+
+    // Omitted until the first update has finished
+    if (lastUpdateFinishTimePoint != std::chrono::steady_clock::time_point::max())
+    {
+        Metrics::AppendHeader(body, "index_last_update_age_seconds", "gauge", "Time since the latest index update finished");
+        Metrics::AppendSample(body, "index_last_update_age_seconds", {}, std::chrono::duration<double>(std::chrono::steady_clock::now() - lastUpdateFinishTimePoint).count());
+    }
+
+    if (m_ReplicationLog || m_ReplicationClient)
+    {
+        Metrics::AppendHeader(body, "replication_segment_version", "gauge", "Latest segment committed by the primary or loaded by the replica");
+        Metrics::AppendSample(body, "replication_segment_version", {}, m_ReplicationLog ? m_ReplicationLog->GetVersion() : m_ReplicationClient->GetVersion());
+    }
+
+    // Step 4
+    // Cluster: the round trips to every shard and the queries it has left out
+    if (m_QueryCoordinator)
+    {
+        Metrics::AppendHeader(body, "coordinator_shard_failures_total", "counter", "Queries a shard has failed or has not answered within the shard timeout");
+        for (size_t i{ 0u }; i < m_QueryCoordinator->GetShardsCount(); ++i)
+        {
+            const std::string labels{ std::format("shard=\"{0}\"", m_QueryCoordinator->GetShardAddress(i)) };
+            Metrics::AppendSample(body, "coordinator_shard_failures_total", labels, static_cast<double>(m_QueryCoordinator->GetShardMetrics(i).FailuresCount.GetValue()));
+        }
+
+        Metrics::AppendHeader(body, "coordinator_shard_duration_seconds", "histogram", "Time from sending a query to a shard to the receipt of its complete answer");
+        for (size_t i{ 0u }; i < m_QueryCoordinator->GetShardsCount(); ++i)
+        {
+            const std::string labels{ std::format("shard=\"{0}\"", m_QueryCoordinator->GetShardAddress(i)) };
+            Metrics::AppendHistogram(body, "coordinator_shard_duration_seconds", labels, m_QueryCoordinator->GetShardMetrics(i).Latencies);
+        }
+    }
+
+    // Step 5
+    // Scratch arenas: hits of the per-thread block cache, misses go to the global heap
+    const ScratchArena::BlockCacheStats blockCacheStats{ ScratchArena::GetBlockCacheStats() };
+    const uint64_t                      blockRequestsCount{ blockCacheStats.HitsCount + blockCacheStats.MissesCount };
+
+    Metrics::AppendHeader(body, "scratch_block_cache_hits_total", "counter", "Scratch arena blocks reused from the cache of the thread");
+    Metrics::AppendSample(body, "scratch_block_cache_hits_total", {}, static_cast<double>(blockCacheStats.HitsCount));
+    Metrics::AppendHeader(body, "scratch_block_cache_misses_total", "counter", "Scratch arena blocks allocated from the heap");
+    Metrics::AppendSample(body, "scratch_block_cache_misses_total", {}, static_cast<double>(blockCacheStats.MissesCount));
+    Metrics::AppendHeader(body, "scratch_block_cache_hit_ratio", "gauge", "Share of the scratch arena blocks reused from the cache");
+    Metrics::AppendSample(body, "scratch_block_cache_hit_ratio", {}, blockRequestsCount != 0u ? static_cast<double>(blockCacheStats.HitsCount) / blockRequestsCount : 0.0);
+
+    // Step 6
+    // Send the exposition
+    SendHTTPBody(context, "text/plain; version=0.0.4", body);
+}
+
+void Server::HandleHTTPStats(const RequestContext& context)
+{
+    const InvertedIndex::Stats       indexStats{ m_InvertedIndex.GetStats() };
+    const InvertedIndex::MemoryStats indexMemoryStats{ m_InvertedIndex.GetMemoryStats() };
+    const FileSystem::MemoryStats    filesMemoryStats{ m_FileSystem.GetMemoryStats() };
+
+    // Every structure is reported as its payload, its unused capacity and its overhead, all in bytes
+    std::pmr::string jsonBody{ context.Scratch };
+    std::format_to(std::back_inserter(jsonBody), "{{ \"terms\": {0}, \"postings\": {1}, \"documents\": {2}, \"duplicates\": {3}, ", indexStats.TermsCount, indexStats.PostingsCount, indexStats.DocumentsCount,
+        indexStats.DuplicatesCount);
+
+    jsonBody.append("\"index\": { ");
+    Utils::AppendJSONMemoryUsage(jsonBody, "term_keys", indexMemoryStats.TermKeys);
+    Utils::AppendJSONMemoryUsage(jsonBody, "posting_lists", indexMemoryStats.PostingLists);
+    Utils::AppendJSONMemoryUsage(jsonBody, "hash_tables", indexMemoryStats.HashTables);
+    std::format_to(std::back_inserter(jsonBody), "\"total\": {0} }}, ", indexMemoryStats.GetTotalBytes());
+
+    jsonBody.append("\"files\": { ");
+    Utils::AppendJSONMemoryUsage(jsonBody, "contents", filesMemoryStats.FileContents);
+    Utils::AppendJSONMemoryUsage(jsonBody, "paths", filesMemoryStats.FilePaths);
+    Utils::AppendJSONMemoryUsage(jsonBody, "hash_tables", filesMemoryStats.HashTables);
+    std::format_to(std::back_inserter(jsonBody), "\"total\": {0} }}, ", filesMemoryStats.GetTotalBytes());
+
+    std::format_to(std::back_inserter(jsonBody), "\"total\": {0} }}", indexMemoryStats.GetTotalBytes() + filesMemoryStats.GetTotalBytes());
+
+    SendHTTPBody(context, "application/json", jsonBody);
+}
+
+void Server::HandleHTTPCompact(const RequestContext& context)
+{
+    const std::chrono::steady_clock::time_point startTimePoint{ std::chrono::steady_clock::now() };
+
+    const size_t releasedBytes{ m_InvertedIndex.CompactPostingLists() };
+
+    const auto elapsedMS{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTimePoint).count() };
+    LOG_INFO_TAG("SERVER", "Compacted the posting lists in {0} ms, released {1} bytes", elapsedMS, releasedBytes);
+
+    std::pmr::string jsonBody{ context.Scratch };
+    std::format_to(std::back_inserter(jsonBody), "{{ \"released\": {0}, \"elapsed_ms\": {1} }}", releasedBytes, elapsedMS);
+
+    SendHTTPBody(context, "application/json", jsonBody);
+}
+
+void Server::AppendJSONPaths(const RequestContext& context, std::pmr::string& jsonBody, const InvertedIndex::SearchResult& searchResult, bool sendFullChunks)
+{
+    TRACE_SCOPE("Server::AppendJSONPaths");
+
+    for (size_t i{ 0u }; i < searchResult.FileIDs.size(); ++i)
+    {
+        if (i > 0u)
+            jsonBody.append(", ");
+
+        jsonBody.push_back('"');
+
+        if (searchResult.Paths.empty())
+            m_FileSystem.AppendJSONEscapedPath(searchResult.FileIDs[i], jsonBody);
+        else
+            HTTP::AppendJSONEscaped(jsonBody, searchResult.Paths[i]);
+
+        jsonBody.push_back('"');
+
+        if (sendFullChunks && jsonBody.size() >= s_SendBufferSize)
+        {
+            SendHTTPChunk(context, jsonBody);
+            jsonBody.clear();
+        }
+    }
+}
+
+void Server::AppendJSONSnippets(const RequestContext& context, std::pmr::string& jsonBody, std::string_view query, std::span<const FileSystem::FileID> fileIDs)
+{
+    TRACE_SCOPE("Server::AppendJSONSnippets");
+
+    const SnippetFinder          snippetFinder{ query, m_InvertedIndex.GetAnalyzerType(), context.Scratch };
+    const SnippetFinder::Options snippetOptions{ .Deadline = std::min(context.QueryDeadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(s_SnippetsTimeBudgetMS)) };
+
+    std::string fileContent{};
+
+    jsonBody.append(", \"snippets\": [");
+
+    for (size_t i{ 0u }; i < std::min(fileIDs.size(), s_MaxSnippetFilesCount); ++i)
+    {
+        if (i > 0u)
+            jsonBody.append(", ");
+
+        jsonBody.push_back('[');
+
+        // Step 1: The content of a file loaded from a prebuilt index is not kept in memory, its start is read from the disk
+        std::string_view content{ m_FileSystem.GetContent(fileIDs[i]) };
+        if (content.empty() && snippetFinder.HasTerms() && std::chrono::steady_clock::now() < snippetOptions.Deadline)
+        {
+            if (FileSystem::ReadFile(m_FileSystem.GetPath(fileIDs[i]), fileContent, s_MaxSnippetReadSize))
+                content = fileContent;
+        }
+
+        // Step 2: Every window with the offsets and the lengths of its highlights within the text, in bytes
+        const std::pmr::vector<SnippetFinder::Snippet> snippets{ snippetFinder.Find(content, snippetOptions, context.Scratch) };
+        for (size_t j{ 0u }; j < snippets.size(); ++j)
+        {
+            jsonBody.append(j > 0u ? ", { \"text\": \"" : "{ \"text\": \"");
+            HTTP::AppendJSONEscaped(jsonBody, snippets[j].Text);
+            jsonBody.append("\", \"highlights\": [");
+
+            for (size_t k{ 0u }; k < snippets[j].Highlights.size(); ++k)
+                std::format_to(std::back_inserter(jsonBody), "{0}[{1}, {2}]", k > 0u ? ", " : "", snippets[j].Highlights[k].first, snippets[j].Highlights[k].second);
+
+            jsonBody.append("] }");
+        }
+
+        jsonBody.push_back(']');
+    }
+
+    jsonBody.push_back(']');
+}
+
+InvertedIndex::SearchResult Server::Search(std::string_view query, const InvertedIndex::SearchOptions& options, std::pmr::memory_resource* resource)
+{
+    if (m_QueryCoordinator)
+        return m_QueryCoordinator->Search(query, options, resource);
+
+    return m_InvertedIndex.Search(query, options, resource);
+}
+
+InvertedIndex::BatchSearchResult Server::SearchBatch(std::span<const std::string_view> queries, const InvertedIndex::SearchOptions& options)
+{
+    if (m_QueryCoordinator)
+        return m_QueryCoordinator->SearchBatch(queries, options);
+
+    return m_InvertedIndex.SearchBatch(queries, options);
+}
+
+std::string_view Server::GetEndpointName(ServerEndpoint endpoint)
+{
+    switch (endpoint)
+    {
+        case SERVER_ENDPOINT_HTTP_SEARCH:
+            return "http_search";
+        case SERVER_ENDPOINT_HTTP_SEARCH_BATCH:
+            return "http_search_batch";
+        case SERVER_ENDPOINT_HTTP_TRACE:
+            return "http_trace";
+        case SERVER_ENDPOINT_HTTP_METRICS:
+            return "http_metrics";
+        case SERVER_ENDPOINT_HTTP_STATS:
+            return "http_stats";
+        case SERVER_ENDPOINT_HTTP_COMPACT:
+            return "http_compact";
+        case SERVER_ENDPOINT_BINARY_SEARCH:
+            return "binary_search";
+        case SERVER_ENDPOINT_BINARY_SEARCH_PAGE:
+            return "binary_search_page";
+        case SERVER_ENDPOINT_BINARY_SEARCH_BATCH:
+            return "binary_search_batch";
+        case SERVER_ENDPOINT_BINARY_SEARCH_SCORED:
+            return "binary_search_scored";
+        case SERVER_ENDPOINT_BINARY_FETCH_SEGMENT:
+            return "binary_fetch_segment";
+        default:
+            return "other";
+    }
+}
+
+bool Server::ParseHTTPPagination(const HTTPQueryParams& queryParams, InvertedIndex::SearchOptions& searchOptions, bool& isLimitAll)
+{
+    if (const auto it{ queryParams.find("offset") }; it != queryParams.end() && !HTTP::ParseSize(it->second, searchOptions.Offset))
+        return false;
+
+    if (const auto it{ queryParams.find("limit") }; it != queryParams.end())
+    {
+        if (it->second == "all")
+        {
+            isLimitAll = true;
+            searchOptions.Limit = std::numeric_limits<size_t>::max();
+        }
+        else if (!HTTP::ParseSize(it->second, searchOptions.Limit) || searchOptions.Limit == 0u || searchOptions.Limit > s_MaxPageSize)
+        {
+            return false;
         }
+    }
+
+    return true;
+}
+
+void Server::SendResponse(const RequestContext& context, std::initializer_list<std::string_view> buffers)
+{
+    // An event loop never waits for a client, the loop flushes the buffer whenever the socket becomes writable
+    if (context.OutputBuffer != nullptr)
+    {
+        for (const std::string_view buffer : buffers)
+            context.OutputBuffer->append(buffer);
+
+        return;
+    }
+
+    for (const std::string_view buffer : buffers)
+        Utils::SendAll(context.Socket, buffer.data(), static_cast<uint32_t>(buffer.size()), context.WriteTimeoutMS);
+}
 
-        void SendAll(SOCKET socket, const char* buffer, uint32_t length)
+void Server::SendHTTPStatus(const RequestContext& context, std::string_view status)
+{
+    std::pmr::string response{ context.Scratch };
+    std::format_to(std::back_inserter(response), "HTTP/1.1 {0}\r\n"
+                                                 "Content-Length: 0\r\n"
+                                                 "Connection: close\r\n\r\n",
+        status);
+
+    SendResponse(context, { response });
+}
+
+void Server::SendHTTPChunk(const RequestContext& context, std::string_view chunk)
+{
+    // A response may be made of many chunks, their headers are formatted on the stack rather than piled up in the arena
+    std::array<char, 2u * sizeof(size_t) + 2u> chunkHeader{};
+    const auto                                 chunkHeaderEnd{ std::format_to(chunkHeader.data(), "{0:x}\r\n", chunk.size()) };
+
+    SendResponse(context, { { chunkHeader.data(), chunkHeaderEnd }, chunk, "\r\n" });
+}
+
+void Server::SendHTTPBody(const RequestContext& context, std::string_view contentType, std::string_view body)
+{
+    std::pmr::string headers{ context.Scratch };
+    std::format_to(std::back_inserter(headers), "HTTP/1.1 200 OK\r\n"
+                                                "Content-Type: {0}\r\n"
+                                                "Content-Length: {1}\r\n"
+                                                "Connection: close\r\n\r\n",
+        contentType, body.size());
+
+    SendResponse(context, { headers, body });
+}
+
+namespace Utils
+{
+    namespace
+    {
+        void WaitForSocket(SOCKET socket, short events, int timeoutMS)
         {
+            WSAPOLLFD pollDescriptor{ .fd = socket, .events = events, .revents = 0 };
+
+            const int readyDescriptorsCount{ WSAPoll(&pollDescriptor, 1u, timeoutMS) };
+            if (readyDescriptorsCount == SOCKET_ERROR)
+                throw std::runtime_error(std::format("Poll failed: {0}", WSAGetLastError()).c_str());
+
+            if (readyDescriptorsCount == 0)
+                throw std::runtime_error("Socket timed out");
+        }
+
+        void SendAll(SOCKET socket, const char* buffer, uint32_t length, int timeoutMS)
+        {
+            TRACE_SCOPE("Server::SendAll");
+
             uint32_t totalBytesSent{ 0u };
             while (totalBytesSent < length)
             {
@@ -501,6 +1825,7 @@ namespace Utils
                     switch (error)
                     {
                         case WSAEWOULDBLOCK:
+                            WaitForSocket(socket, POLLWRNORM, timeoutMS);
                             continue;
                         default:
                             throw std::runtime_error(std::format("Send failed: {0}", error).c_str());
@@ -511,47 +1836,29 @@ namespace Utils
             }
         }
 
-        std::string UrlDecode(std::string_view value)
+        void AppendUInt32NetworkOrder(std::pmr::string& destination, uint32_t value)
         {
-            std::string decodedValue{};
-            decodedValue.reserve(value.size());
+            const uint32_t valueNetworkOrder{ htonl(value) };
+            destination.append(reinterpret_cast<const char*>(&valueNetworkOrder), sizeof(valueNetworkOrder));
+        }
 
-            for (size_t i{ 0u }; i < value.size(); ++i)
-            {
-                if (value[i] == '%')
-                {
-                    if (i + 2 < value.size())
-                    {
-                        const char hex1{ value[i + 1] };
-                        const char hex2{ value[i + 2] };
-
-                        if (isxdigit(hex1) && isxdigit(hex2))
-                        {
-                            const char decodedChar{ static_cast<char>(std::stoi(std::string{ hex1, hex2 }, nullptr, 16)) };
-                            decodedValue.push_back(decodedChar);
-                            i += 2;
-                        }
-                        else
-                        {
-                            decodedValue.push_back(value[i]);
-                        }
-                    }
-                    else
-                    {
-                        decodedValue.push_back(value[i]);
-                    }
-                }
-                else if (value[i] == '+')
-                {
-                    decodedValue.push_back(' ');
-                }
-                else
-                {
-                    decodedValue.push_back(value[i]);
-                }
-            }
+        void WriteUInt32NetworkOrder(char* destination, uint32_t value)
+        {
+            const uint32_t valueNetworkOrder{ htonl(value) };
+            memcpy(destination, &valueNetworkOrder, sizeof(valueNetworkOrder));
+        }
+
+        void AppendJSONMemoryUsage(std::pmr::string& destination, std::string_view name, const MemoryUsage& memoryUsage)
+        {
+            std::format_to(std::back_inserter(destination), "\"{0}\": {{ \"used\": {1}, \"slack\": {2}, \"overhead\": {3}, \"total\": {4} }}, ",
+                name, memoryUsage.UsedBytes, memoryUsage.SlackBytes, memoryUsage.OverheadBytes, memoryUsage.GetTotalBytes());
+        }
 
-            return decodedValue;
+        uint32_t ReadUInt32NetworkOrder(const char* source)
+        {
+            uint32_t valueNetworkOrder{ 0u };
+            memcpy(&valueNetworkOrder, source, sizeof(valueNetworkOrder));
+            return ntohl(valueNetworkOrder);
         }
     } // namespace
 } // namespace Utils
\ No newline at end of file
@@ -1,23 +1,136 @@
 #pragma once
 #include "FileSystem.h"
+#include "HTTP.h"
+#include "IndexingPipeline.h"
 #include "InvertedIndex.h"
+#include "Metrics.h"
+#include "QueryCoordinator.h"
+#include "Replication.h"
+#include "Snippets.h"
 #include "ThreadPool.h"
+#include "Topology.h"
 
+#include <array>
 #include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <winsock2.h>
 #include <ws2tcpip.h>
 
 enum ServerTaskPriority : uint8_t
 {
     SERVER_TASK_PRIORITY_NONE = 0u,
+    SERVER_TASK_PRIORITY_HELP_SEARCH, // The helpers of a search or a batch that is already running, not counted by the admission control
     SERVER_TASK_PRIORITY_HANDLE_CLIENT,
     SERVER_TASK_PRIORITY_UPDATE_INVERTED_INDEX,
 };
 
+// The high byte of the 4-byte request length prefix of the binary protocol selects the frame type,
+// the remaining 24 bits hold the payload length. Legacy clients always send BINARY_FRAME_TYPE_SEARCH.
+enum BinaryFrameType : uint8_t
+{
+    BINARY_FRAME_TYPE_SEARCH = 0u,   // Payload: query.                                  Response: count, paths
+    BINARY_FRAME_TYPE_SEARCH_PAGE,   // Payload: offset (4 bytes), limit (4 bytes), query. Response: total, count, paths
+    BINARY_FRAME_TYPE_SEARCH_BATCH,  // Payload: offset, limit, queries count (4 bytes each), then length-prefixed queries.
+                                     // Response: queries count, then total, count, paths for every query in order
+    BINARY_FRAME_TYPE_SEARCH_SCORED, // Payload: offset (4 bytes), limit (4 bytes), query, the limit is not capped.
+                                     // Response: total, partial flag, count, paths, then the score of every path (4 bytes each).
+                                     // Sent by the coordinator of a cluster to its shards
+    BINARY_FRAME_TYPE_FETCH_SEGMENT, // Payload: log ID (4 bytes), version of the last segment the replica has loaded (4 bytes).
+                                     // Response: log ID, first version, last version and size of the next segment (4 bytes each),
+                                     // then the segment. The first version is 1 for the snapshot of the merged segments. The versions
+                                     // and the size are 0 if the replica is up to date. Sent by the replicas to their primary
+};
+
+// A binary response that starts with BINARY_ERROR_MARKER instead of a count carries
+// one of the error codes below (4 bytes, network byte order) and nothing else
+inline constexpr uint32_t BINARY_ERROR_MARKER{ 0xFFFFFFFFu };
+
+enum BinaryErrorCode : uint32_t
+{
+    BINARY_ERROR_CODE_NONE = 0u,
+    BINARY_ERROR_CODE_OVERLOADED, // The request has been shed by the admission control
+    BINARY_ERROR_CODE_TIMED_OUT,  // The query time budget has been spent while the request was queued
+};
+
+// The request latencies are recorded per endpoint
+enum ServerEndpoint : uint8_t
+{
+    SERVER_ENDPOINT_OTHER = 0u, // Requests that have been rejected, have timed out or have not been routed
+    SERVER_ENDPOINT_HTTP_SEARCH,
+    SERVER_ENDPOINT_HTTP_SEARCH_BATCH,
+    SERVER_ENDPOINT_HTTP_TRACE,
+    SERVER_ENDPOINT_HTTP_METRICS,
+    SERVER_ENDPOINT_HTTP_STATS,
+    SERVER_ENDPOINT_HTTP_COMPACT,
+    SERVER_ENDPOINT_BINARY_SEARCH,
+    SERVER_ENDPOINT_BINARY_SEARCH_PAGE,
+    SERVER_ENDPOINT_BINARY_SEARCH_BATCH,
+    SERVER_ENDPOINT_BINARY_SEARCH_SCORED,
+    SERVER_ENDPOINT_BINARY_FETCH_SEGMENT,
+    SERVER_ENDPOINTS_COUNT,
+};
+
+struct ServerConfig
+{
+    uint32_t WorkersCount{ std::max(std::thread::hardware_concurrency(), 2u) - 1u };
+
+    // Admission control: requests above these limits are rejected right away with 503 or BINARY_ERROR_CODE_OVERLOADED
+    uint32_t MaxQueuedRequests{ 1024u };   // Requests waiting for a ThreadPool worker
+    uint32_t MaxInFlightRequests{ 4096u }; // Requests either waiting for a worker or being processed
+
+    // Per-connection deadlines, 0 disables a deadline
+    uint32_t ReadTimeoutMS{ 10000u }; // Time a client may take to send a complete request once it has started sending it
+    uint32_t WriteTimeoutMS{ 10000u }; // Time a response may go without any progress being made in sending it
+    uint32_t IdleTimeoutMS{ 0u };      // Time a connection may stay open without sending anything
+
+    // Time budget of a query, counted from the moment its request has been received, 0 disables the budget
+    uint32_t QueryTimeBudgetMS{ 1000u };
+
+    // Prebuilt index to load at startup, see the indexer. Only the files it does not hold are indexed by the server
+    std::string IndexPath{};
+
+    // Turns the contents and the queries into terms. A prebuilt index, the segments of a primary and the shards of a
+    // cluster have to use the same one
+    AnalyzerType Analyzer{ ANALYZER_TYPE_STANDARD };
+
+    // Records trace spans from the start rather than from the first GET /trace?enable=1
+    bool IsTracingEnabled{ false };
+
+    // 0: a single routine accepts the clients and hands their requests over to the ThreadPool.
+    // N: N event loops, each pinned to a core of its own, accept clients and parse and answer their requests themselves.
+    // The requests that may take long (batches, compactions, segment fetches and the searches of a coordinator) and the searches
+    // whose results are not bounded by a page, that go deeper than 10 pages of the maximum size or that read files for their
+    // snippets still go to the ThreadPool
+    uint32_t EventLoopsCount{ 0u };
+
+    // Pins the workers to the cores node after node, after the cores of the event loops, and spreads the memory of the
+    // index shards over the NUMA nodes. A non-zero SimulatedNUMANodesCount replaces the topology reported by the OS
+    bool     IsNUMAPlacementEnabled{ false };
+    uint32_t SimulatedNUMANodesCount{ 0u };
+
+    // The documents the server loads and indexes when it is one of the shards of a cluster, all of them by default
+    FileSystem::Partition Partition{};
+
+    // Coordinator mode: the "IPv4:port" of every shard of the cluster. The coordinator indexes nothing itself, it fans every
+    // query out to the shards and merges their results, leaving out the shards that have not answered within ShardTimeoutMS
+    std::vector<std::string> ShardAddresses{};
+    uint32_t                 ShardTimeoutMS{ 500u }; // 0 leaves the shards the whole query time budget
+
+    // Primary mode: every index update is also written to this directory as a segment the replicas fetch, see ReplicationLog
+    std::string ReplicationDirectory{};
+
+    // Replica mode: the "IPv4:port" of the primary. The replica crawls nothing itself, it loads the segments of the primary
+    std::string PrimaryAddress{};
+};
+
 class Server
 {
 public:
-    Server();
+    explicit Server(const ServerConfig& config = {});
     ~Server() { Stop(); }
 
     Server(const Server&) noexcept = delete;
@@ -30,31 +143,206 @@ public:
     void Start(const std::string& filesDirectory, uint16_t port);
     void Stop();
 
+    // Without a listen socket, a crawl or any client: loads ServerConfig::IndexPath, then answers the complete HTTP requests
+    // given to ProcessHTTPRequest() the way an event loop does, appending the responses to outputBuffer. Lets the benchmarks
+    // measure the whole request path in process
+    void StartInProcess();
+    void ProcessHTTPRequest(std::string_view request, std::string& outputBuffer);
+
+private:
+    enum class ConnectionProtocol : uint8_t
+    {
+        Unknown = 0u,
+        HTTP,
+        Binary,
+    };
+
+    // A client connection is owned by the routine thread while it waits for a complete request or for its responses to be
+    // flushed, and is handed over to a ThreadPool worker only for the time that request is being processed
+    struct Connection
+    {
+        Connection(SOCKET socket, std::string peer, Metrics::Counter& closedConnectionsCount, ConnectionProtocol protocol = ConnectionProtocol::Unknown) noexcept
+            : Socket{ socket }
+            , Peer{ std::move(peer) }
+            , ClosedConnectionsCount{ closedConnectionsCount }
+            , Protocol{ protocol }
+        {
+        }
+
+        ~Connection();
+
+        Connection(const Connection&) noexcept = delete;
+        Connection(Connection&&) noexcept = delete;
+
+        Connection& operator=(const Connection&) noexcept = delete;
+        Connection& operator=(Connection&&) noexcept = delete;
+
+        const SOCKET      Socket{ INVALID_SOCKET };
+        const std::string Peer{};
+
+        Metrics::Counter& ClosedConnectionsCount; // Incremented when the socket is closed
+
+        ConnectionProtocol Protocol{ ConnectionProtocol::Unknown };
+        std::string        InputBuffer{};
+        std::string        OutputBuffer{};     // Responses an event loop has answered but the socket has not taken yet
+        bool               IsClosing{ false }; // Dropped once OutputBuffer has been flushed
+
+        std::chrono::steady_clock::time_point LastActivityTimePoint{ std::chrono::steady_clock::now() };
+        std::chrono::steady_clock::time_point RequestStartTimePoint{ LastActivityTimePoint }; // When the first byte of the buffered request arrived
+        std::chrono::steady_clock::time_point LastSendTimePoint{ LastActivityTimePoint };     // When OutputBuffer was last filled or drained
+    };
+
+    using ConnectionRef = std::shared_ptr<Connection>;
+
+    // Polls the listen socket and the idle connections it has accepted, for reading or, while they have buffered responses,
+    // for writing. The connections are handed back to the loop that has accepted them once their requests have been processed,
+    // so a connection stays on the same loop for its lifetime
+    struct EventLoop
+    {
+        uint32_t Index{ 0u };
+        SOCKET   WakeupSocket{ INVALID_SOCKET };
+
+        std::unordered_map<SOCKET, ConnectionRef> IdleConnections{};
+        std::vector<WSAPOLLFD>                    PollDescriptors{};
+
+        std::mutex                 ResumedConnectionsLock{};
+        std::vector<ConnectionRef> ResumedConnections{};
+
+        std::chrono::steady_clock::time_point LastExpirationTimePoint{ std::chrono::steady_clock::now() };
+
+        std::thread Thread{}; // The first loop runs on the thread that has called Start()
+    };
+
+    using HTTPQueryParams = HTTP::FieldMap;
+
+    struct RequestContext
+    {
+        SOCKET                                Socket{ INVALID_SOCKET };
+        std::string*                          OutputBuffer{ nullptr }; // Set on an event loop: the response is buffered instead of being sent
+        std::chrono::steady_clock::time_point QueryDeadline{ std::chrono::steady_clock::time_point::max() };
+        int                                   WriteTimeoutMS{ -1 };
+        std::pmr::memory_resource*            Scratch{ std::pmr::get_default_resource() }; // Arena of the request, released once it has been answered
+        ServerEndpoint                        Endpoint{ SERVER_ENDPOINT_OTHER };            // Set by the handler the request is routed to
+    };
+
+    // Recorded by the routine and the workers, exposed by GET /metrics
+    struct ServerMetrics
+    {
+        Metrics::Counter AcceptedConnectionsCount{};
+        Metrics::Counter ClosedConnectionsCount{};
+        Metrics::Counter ShedRequestsCount{};
+
+        std::array<Metrics::Histogram, SERVER_ENDPOINTS_COUNT> RequestLatencies{}; // From the receipt of the request to the end of its response
+    };
+
 private:
     void CreateListenSocket();
-    void Routine();
-    void RemoveFinishedTasksFutures();
+    void CreateEventLoops();
+    void LoadIndex();
+    void Routine(EventLoop& eventLoop);
     void UpdateInvertedIndex();
-    void ProcessClient(SOCKET clientSocket);
-    void HandleSocketClient(SOCKET clientSocket);
-    void HandleHTTPClient(SOCKET clientSocket);
+    void SynchronizeReplica();
+    void PollConnections(EventLoop& eventLoop);
+    void AcceptClients(EventLoop& eventLoop);
+    void ResumeConnections(EventLoop& eventLoop);
+    void ResumeConnection(EventLoop& eventLoop, const ConnectionRef& connection);
+    void ExpireConnections(EventLoop& eventLoop);
+
+    bool ReceiveFromConnection(Connection& connection);
+    bool FlushConnection(Connection& connection);
+    bool DispatchRequest(EventLoop& eventLoop, const ConnectionRef& connection);
+    bool IsOverloaded() const;
+    bool IsSlowRequest(const Connection& connection, std::string_view request, const HTTP::Request* httpRequest) const;
+
+    // httpRequest is the request already parsed by the caller, in an arena that outlives the call, or nullptr
+    bool ProcessRequest(const Connection& connection, std::string_view request, const HTTP::Request* httpRequest, std::chrono::steady_clock::time_point receiveTimePoint, std::string* outputBuffer);
+    bool HandleSocketRequest(RequestContext& context, std::string_view request);
+    void HandleSocketSearchBatch(const RequestContext& context, std::string_view payload);
+    void HandleSocketSearchScored(const RequestContext& context, std::string_view payload);
+    void HandleSocketFetchSegment(const RequestContext& context, std::string_view payload);
+    void SendSocketSearchResult(const RequestContext& context, std::pmr::string& sendBuffer, const InvertedIndex::SearchResult& searchResult, bool withTotalHitsCount);
+    void HandleHTTPRequest(RequestContext& context, const HTTP::Request& httpRequest);
+    void HandleHTTPSearch(const RequestContext& context, const HTTPQueryParams& queryParams);
+    void HandleHTTPSearchBatch(const RequestContext& context, const HTTPQueryParams& queryParams, std::string_view body);
+    void HandleHTTPTrace(const RequestContext& context, const HTTPQueryParams& queryParams);
+    void HandleHTTPMetrics(const RequestContext& context);
+    void HandleHTTPStats(const RequestContext& context);
+    void HandleHTTPCompact(const RequestContext& context);
+    // The paths of a coordinator's result come with it, the others are looked up in the file system
+    void AppendJSONPaths(const RequestContext& context, std::pmr::string& jsonBody, const InvertedIndex::SearchResult& searchResult, bool sendFullChunks);
+
+    // Highlighted windows of the first files of a page, the files left when the snippet time budget runs out get none
+    void AppendJSONSnippets(const RequestContext& context, std::pmr::string& jsonBody, std::string_view query, std::span<const FileSystem::FileID> fileIDs);
+
+    // Search the local index, or the shards of the cluster in coordinator mode
+    InvertedIndex::SearchResult      Search(std::string_view query, const InvertedIndex::SearchOptions& options, std::pmr::memory_resource* resource);
+    InvertedIndex::BatchSearchResult SearchBatch(std::span<const std::string_view> queries, const InvertedIndex::SearchOptions& options);
+
+    // Send a response, or append it to RequestContext::OutputBuffer when it is set
+    static void SendResponse(const RequestContext& context, std::initializer_list<std::string_view> buffers);
+    static void SendHTTPStatus(const RequestContext& context, std::string_view status);
+    static void SendHTTPChunk(const RequestContext& context, std::string_view chunk);
+    static void SendHTTPBody(const RequestContext& context, std::string_view contentType, std::string_view body);
+
+    static SOCKET           CreateWakeupSocket();
+    static void             WakeUpRoutine(const EventLoop& eventLoop);
+    static size_t           GetCompleteRequestLength(Connection& connection);
+    static bool             ShedRequest(const Connection& connection, BinaryErrorCode errorCode);
+    static std::string_view GetSheddingResponse(ConnectionProtocol protocol, BinaryErrorCode errorCode);
+    static bool             ParseHTTPPagination(const HTTPQueryParams& queryParams, InvertedIndex::SearchOptions& searchOptions, bool& isLimitAll);
+    static std::string_view GetEndpointName(ServerEndpoint endpoint);
+
+    // An empty optional for a binary or a malformed request
+    static std::optional<HTTP::Request> TryParseHTTPRequest(const Connection& connection, std::string_view request, std::pmr::memory_resource* resource);
 
 private:
+    static constexpr size_t   s_DefaultPageSize{ 100u };
+    static constexpr size_t   s_MaxPageSize{ 1000u };
+    static constexpr size_t   s_MaxEventLoopOffset{ 10u * s_MaxPageSize }; // A deeper page is searched by the workers
+    static constexpr size_t   s_SendBufferSize{ 64u * 1024u };
+    static constexpr uint32_t s_BinaryFramePayloadLengthMask{ 0x00FFFFFFu };
+    static constexpr size_t   s_MaxHTTPHeadersSize{ 64u * 1024u };
+    static constexpr size_t   s_MaxHTTPBodySize{ 16u * 1024u * 1024u };
+    static constexpr size_t   s_MaxBatchSize{ 10000u };
+    static constexpr size_t   s_MaxSnippetFilesCount{ 10u };
+    static constexpr uint32_t s_SnippetsTimeBudgetMS{ 50u };
+    static constexpr size_t   s_MaxSnippetReadSize{ 256u * 1024u }; // Read from the start of a file whose content is not in memory
+    static constexpr int      s_PollTimeoutMS{ 100 };
+    static constexpr uint32_t s_LogThrottleIntervalMS{ 1000u }; // Of the messages a client or an overload can flood the log with
+
+private:
+    const ServerConfig m_Config{};
+    const Topology     m_Topology{};
+
+    // Declared before the connections, which count themselves as closed when they are destroyed
+    ServerMetrics m_Metrics{};
+
     ThreadPool    m_ThreadPool{};
     FileSystem    m_FileSystem{};
-    InvertedIndex m_InvertedIndex{};
+    InvertedIndex m_InvertedIndex{ &m_ThreadPool, SERVER_TASK_PRIORITY_HELP_SEARCH, m_Config.Analyzer };
+
+    std::unique_ptr<QueryCoordinator> m_QueryCoordinator{}; // Only in coordinator mode
+
+    std::unique_ptr<ReplicationLog>    m_ReplicationLog{};    // Only in primary mode
+    std::unique_ptr<ReplicationClient> m_ReplicationClient{}; // Only in replica mode
+    std::atomic<bool>                  m_IsSynchronizingReplica{ false };
+
+    // The routine replaces the pipeline while GET /metrics reads it from a worker
+    std::mutex                            m_IndexingPipelineLock{};
+    std::shared_ptr<IndexingPipeline>     m_IndexingPipeline{};
+    std::chrono::steady_clock::time_point m_LastIndexUpdateFinishTimePoint{ std::chrono::steady_clock::time_point::max() }; // Of the last finished update, if any
+
+    std::vector<std::unique_ptr<EventLoop>> m_EventLoops{};
 
-    std::vector<std::future<void>> m_ClientTasksFutures{};
-    std::vector<std::future<void>> m_UpdateIndexFutures{};
+    std::atomic<uint32_t> m_InFlightRequestsCount{ 0u };
 
     std::string m_FilesDirectory{};
 
     SOCKET   m_ListenSocket{ INVALID_SOCKET };
     uint16_t m_Port{ 0u };
 
-    bool m_IsRunning{ false };
+    std::atomic<bool> m_IsRunning{ false };
 
-    std::chrono::time_point<std::chrono::steady_clock> m_LastIndexUpdateTimePoint{ std::chrono::steady_clock::now() };
+    std::chrono::time_point<std::chrono::steady_clock> m_LastIndexUpdateTimePoint{}; // The first update is due right away
     const uint32_t                                     m_IndexUpdateIntervalMS{ 5000u };
-    uint32_t                                           m_ElapsedAfterLastIndexUpdateMS{ m_IndexUpdateIntervalMS };
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Snippets.h"
+
+#include "ScratchArena.h"
+#include "Tracer.h"
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr std::string_view WHITESPACE{ " \t\n\v\f\r" };
+
+        // A window of a text without whitespace, e.g. CJK, is cut at a character boundary rather than at a word
+        bool IsUTF8Continuation(char c) { return (static_cast<unsigned char>(c) & 0xC0u) == 0x80u; }
+    } // namespace
+} // namespace Utils
+
+SnippetFinder::SnippetFinder(std::string_view query, AnalyzerType analyzerType, std::pmr::memory_resource* resource)
+    : m_AnalyzerType{ analyzerType }
+    , m_Terms{ VisitAnalyzer(analyzerType, [&](auto analyzer) { return analyzer.Tokenize(query, resource); }) }
+{
+    std::sort(m_Terms.begin(), m_Terms.end());
+    m_Terms.erase(std::unique(m_Terms.begin(), m_Terms.end()), m_Terms.end());
+}
+
+std::pmr::vector<SnippetFinder::Snippet> SnippetFinder::Find(std::string_view content, const Options& options, std::pmr::memory_resource* resource) const
+{
+    TRACE_SCOPE("SnippetFinder::Find");
+
+    std::pmr::vector<Snippet> snippets{ resource };
+    if (m_Terms.empty() || options.MaxSnippetsCount == 0u)
+        return snippets;
+
+    ScratchArena     scratchArena{};
+    std::pmr::string term{ scratchArena.GetResource() };
+
+    // The open window: where it starts in the content, where its last highlight ends, and its highlights in the content
+    size_t                                      windowBegin{ 0u };
+    size_t                                      windowEnd{ 0u };
+    std::pmr::vector<std::pair<size_t, size_t>> highlights{ resource };
+
+    // The window is cut at the last whitespace of its trailing context, so that it does not end in the middle of a word
+    const auto closeWindow{ [&]() {
+        size_t snippetEnd{ std::min(content.size(), windowEnd + options.ContextLength) };
+        if (snippetEnd < content.size())
+        {
+            if (const size_t whitespaceIndex{ content.substr(windowEnd, snippetEnd - windowEnd).find_last_of(Utils::WHITESPACE) }; whitespaceIndex != std::string_view::npos)
+                snippetEnd = windowEnd + whitespaceIndex;
+
+            while (snippetEnd > windowEnd && Utils::IsUTF8Continuation(content[snippetEnd]))
+                --snippetEnd;
+        }
+
+        for (auto& [offset, length] : highlights)
+            offset -= windowBegin;
+
+        snippets.push_back({ .Text = content.substr(windowBegin, snippetEnd - windowBegin), .Highlights = std::move(highlights) });
+        highlights = std::pmr::vector<std::pair<size_t, size_t>>{ resource };
+    } };
+
+    size_t termsCount{ 0u };
+
+    // The terms of the content in order, each with the token it comes from, until the last window is complete
+    const auto onTerm{ [&](std::string_view token, std::string_view contentTerm) {
+        // Step 1: The token spans [i, j) of the content
+        const size_t i{ static_cast<size_t>(token.data() - content.data()) };
+        const size_t j{ i + token.size() };
+
+        // Step 2: A window no later match can join is complete
+        if (!highlights.empty() && i >= windowEnd + options.ContextLength)
+        {
+            closeWindow();
+            if (snippets.size() == options.MaxSnippetsCount)
+                return false;
+        }
+
+        if (++termsCount % s_DeadlineCheckInterval == 0u && std::chrono::steady_clock::now() >= options.Deadline)
+            return false;
+
+        if (!IsTerm(contentTerm))
+            return true;
+
+        // Step 3: Highlight the token, in a new window if the open one would grow too long
+        if (!highlights.empty() && j - windowBegin > options.MaxSnippetLength)
+        {
+            closeWindow();
+            if (snippets.size() == options.MaxSnippetsCount)
+                return false;
+        }
+
+        if (highlights.empty())
+        {
+            // Started after the first whitespace of the leading context, for the same reason the window is cut
+            windowBegin = i > options.ContextLength ? i - options.ContextLength : 0u;
+
+            if (windowBegin > 0u)
+            {
+                if (const size_t whitespaceIndex{ content.substr(windowBegin, i - windowBegin).find_first_of(Utils::WHITESPACE) }; whitespaceIndex != std::string_view::npos)
+                    windowBegin += whitespaceIndex + 1u;
+
+                while (windowBegin < i && Utils::IsUTF8Continuation(content[windowBegin]))
+                    ++windowBegin;
+            }
+        }
+
+        highlights.emplace_back(i, j - i);
+        windowEnd = j;
+
+        return true;
+    } };
+
+    VisitAnalyzer(m_AnalyzerType, [&](auto analyzer) { analyzer.ForEachTerm(content, term, onTerm); });
+
+    // The scan may have stopped at the deadline with a window still open
+    if (!highlights.empty())
+        closeWindow();
+
+    return snippets;
+}
+
+bool SnippetFinder::IsTerm(std::string_view term) const noexcept
+{
+    return std::find(m_Terms.begin(), m_Terms.end(), term) != m_Terms.end();
+}
\ No newline at end of file
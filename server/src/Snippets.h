@@ -0,0 +1,52 @@
+#pragma once
+#include "Analyzer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Context windows around the terms of a query in the content of a matching file, so that a hit shows why it has matched.
+// The index keeps no term positions, so the content is scanned token by token with the analyzer of the index, and the
+// scan stops as soon as the windows are complete or the deadline has passed
+class SnippetFinder
+{
+public:
+    struct Snippet
+    {
+        std::string_view                            Text{};       // A view into the scanned content
+        std::pmr::vector<std::pair<size_t, size_t>> Highlights{}; // Offset into Text and length of every matching token
+    };
+
+    struct Options
+    {
+        size_t MaxSnippetsCount{ 3u };
+        size_t ContextLength{ 60u };     // Bytes shown before the first and after the last highlight of a window
+        size_t MaxSnippetLength{ 240u }; // A match beyond it opens the next window
+
+        std::chrono::steady_clock::time_point Deadline{ std::chrono::steady_clock::time_point::max() };
+    };
+
+public:
+    // The query is analyzed like a search query, once for all the files
+    SnippetFinder(std::string_view query, AnalyzerType analyzerType, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+public:
+    // The windows in content order, fewer than Options::MaxSnippetsCount if the content or the time runs out
+    std::pmr::vector<Snippet> Find(std::string_view content, const Options& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+    bool HasTerms() const noexcept { return !m_Terms.empty(); }
+
+private:
+    bool IsTerm(std::string_view term) const noexcept;
+
+private:
+    static constexpr size_t s_DeadlineCheckInterval{ 1024u }; // Terms scanned between two deadline checks
+
+private:
+    const AnalyzerType                 m_AnalyzerType{ ANALYZER_TYPE_STANDARD };
+    std::pmr::vector<std::pmr::string> m_Terms{}; // Distinct, a query has too few of them for anything but a linear lookup
+};
\ No newline at end of file
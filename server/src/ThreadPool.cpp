@@ -1,6 +1,9 @@
 #include "ThreadPool.h"
 
-void ThreadPool::Create(uint32_t workersCount)
+#include "Topology.h"
+#include "Tracer.h"
+
+void ThreadPool::Create(uint32_t workersCount, std::span<const uint32_t> workerCores)
 {
     WriteLock _{ m_ObjectLock };
 
@@ -10,7 +13,7 @@ void ThreadPool::Create(uint32_t workersCount)
     try
     {
         for (uint32_t i = 0; i < workersCount; ++i)
-            m_Workers.emplace_back(&ThreadPool::Routine, this);
+            m_Workers.emplace_back(&ThreadPool::Routine, this, workerCores.empty() ? s_AnyCore : workerCores[i % workerCores.size()]);
         m_IsInitialized = (m_Workers.size() == workersCount);
         m_IsTerminated = !m_IsInitialized;
     }
@@ -90,27 +93,60 @@ void ThreadPool::Shutdown()
             return;
 
         std::priority_queue<PriorityTask, std::vector<PriorityTask>, TaskComparator>{}.swap(m_Tasks);
+        m_QueuedTasksCount.store(0u);
+        for (auto& priorityQueuedTasksCount : m_PriorityQueuedTasksCounts)
+            priorityQueuedTasksCount.store(0u);
     }
 
     Stop();
 }
 
-void ThreadPool::Routine()
+void ThreadPool::PushTask(uint8_t priority, std::function<void()>&& function)
 {
+    {
+        WriteLock _{ m_ObjectLock };
+
+        if (!IsWorkingUnsafe())
+            throw std::runtime_error("ThreadPool is not accepting tasks.");
+
+        if (!m_TaskMetrics[priority])
+            m_TaskMetrics[priority] = std::make_unique<TaskMetrics>();
+
+        m_Tasks.push({ .Priority = priority, .Function = std::move(function), .EnqueueTimePoint = std::chrono::steady_clock::now() });
+        m_QueuedTasksCount.fetch_add(1u);
+        m_PriorityQueuedTasksCounts[priority].fetch_add(1u);
+    }
+
+    m_TaskWaiter.notify_one();
+}
+
+void ThreadPool::Routine(uint32_t core)
+{
+    Tracer::SetThreadName("ThreadPool worker");
+
+    if (core != s_AnyCore && !Topology::PinCurrentThread(core))
+        LOG_WARN_TAG("THREADPOOL", "Failed to pin a worker to the core {0}", core);
+
     while (true)
     {
-        std::function<void()> task;
+        std::function<void()>                 task;
+        std::chrono::steady_clock::time_point enqueueTimePoint{};
+        TaskMetrics*                          taskMetrics{ nullptr };
 
         {
             WriteLock _{ m_ObjectLock };
 
             m_PauseWaiter.wait(_, [this] { return !m_IsPaused || m_IsTerminated; });
 
-            m_TaskWaiter.wait(_, [this, &task] {
+            m_TaskWaiter.wait(_, [this, &task, &enqueueTimePoint, &taskMetrics] {
                 if (!m_Tasks.empty())
                 {
-                    task = std::move(m_Tasks.top().second);
+                    task = std::move(m_Tasks.top().Function);
+                    enqueueTimePoint = m_Tasks.top().EnqueueTimePoint;
+                    taskMetrics = m_TaskMetrics[m_Tasks.top().Priority].get();
+                    m_PriorityQueuedTasksCounts[m_Tasks.top().Priority].fetch_sub(1u);
                     m_Tasks.pop();
+                    m_QueuedTasksCount.fetch_sub(1u);
                     return true;
                 }
 
@@ -123,8 +159,14 @@ void ThreadPool::Routine()
 
         m_BusyWorkersCount.fetch_add(1u);
 
+        const std::chrono::steady_clock::time_point startTimePoint{ std::chrono::steady_clock::now() };
+
+        taskMetrics->WaitTimes.Observe(startTimePoint - enqueueTimePoint);
+        Tracer::RecordInterval("ThreadPool::QueueWait", enqueueTimePoint, startTimePoint);
+
         try
         {
+            TRACE_SCOPE("ThreadPool::Task");
             task();
         }
         catch (const std::exception& e)
@@ -136,6 +178,7 @@ void ThreadPool::Routine()
             LOG_ERROR_TAG("THREADPOOL", "An exception was thrown in a task.");
         }
 
+        taskMetrics->RunTimes.Observe(std::chrono::steady_clock::now() - startTimePoint);
         m_BusyWorkersCount.fetch_sub(1u);
     }
-}
+}
\ No newline at end of file
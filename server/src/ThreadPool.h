@@ -1,14 +1,24 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <exception>
 #include <functional>
 #include <future>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <shared_mutex>
+#include <span>
 #include <thread>
 #include <type_traits>
 #include <vector>
 
+#include "Metrics.h"
+
 class ThreadPool
 {
 public:
@@ -16,6 +26,12 @@ public:
     using ReadLock = std::shared_lock<ReadWriteLock>;
     using WriteLock = std::unique_lock<ReadWriteLock>;
 
+    struct TaskMetrics
+    {
+        Metrics::Histogram WaitTimes{}; // From AddTask() to the start of the task
+        Metrics::Histogram RunTimes{};
+    };
+
 public:
     ThreadPool() noexcept = default;
     ~ThreadPool() { Stop(); }
@@ -27,7 +43,8 @@ public:
     ThreadPool& operator=(ThreadPool&&) noexcept = delete;
 
 public:
-    void Create(uint32_t workersCount = std::thread::hardware_concurrency() - 1u);
+    // Worker i is pinned to workerCores[i % size] when cores are given, see Topology::GetCoresByNode()
+    void Create(uint32_t workersCount = std::max(std::thread::hardware_concurrency(), 2u) - 1u, std::span<const uint32_t> workerCores = {});
 
     void Start();
     void Pause();
@@ -38,6 +55,16 @@ public:
     auto AddTask(uint8_t priority, F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+    // Like AddTask() without a future: the callable is queued as it is, so one small enough for the small-object buffer of
+    // std::function (a few pointers) is queued without a heap allocation. What it throws is logged by the worker
+    template <typename F>
+    void AddDetachedTask(uint8_t priority, F&& f);
+
+    // Calls f(i) for every i in [0, count) on the workers and returns once all calls have finished.
+    // The calling thread takes part in the work, so it is safe to call from a worker even when the pool is saturated.
+    template <typename F>
+    void ParallelFor(uint8_t priority, size_t count, F&& f);
+
     bool IsWorking() const
     {
         ReadLock _{ m_ObjectLock };
@@ -53,21 +80,35 @@ public:
     uint32_t GetWorkersCount() const noexcept { return m_Workers.size(); }
     uint32_t GetBusyWorkersCount() const noexcept { return m_BusyWorkersCount.load(); }
     uint32_t GetFreeWorkersCount() const noexcept { return GetWorkersCount() - m_BusyWorkersCount.load(); }
+    uint32_t GetQueuedTasksCount() const noexcept { return m_QueuedTasksCount.load(); }
+    uint32_t GetQueuedTasksCount(uint8_t priority) const noexcept { return m_PriorityQueuedTasksCounts[priority].load(); }
 
-private:
-    using PriorityTask = std::pair<uint8_t, std::function<void()>>;
+    // nullptr until a task of the priority has been added
+    const TaskMetrics* GetTaskMetrics(uint8_t priority) const
+    {
+        ReadLock _{ m_ObjectLock };
+        return m_TaskMetrics[priority].get();
+    }
 
 private:
+    struct PriorityTask
+    {
+        uint8_t                               Priority{ 0u };
+        std::function<void()>                 Function{};
+        std::chrono::steady_clock::time_point EnqueueTimePoint{};
+    };
+
     struct TaskComparator
     {
         bool operator()(const PriorityTask& lhs, const PriorityTask& rhs) const noexcept
         {
-            return lhs.first > rhs.first;
+            return lhs.Priority > rhs.Priority;
         }
     };
 
 private:
-    void Routine();
+    void PushTask(uint8_t priority, std::function<void()>&& function);
+    void Routine(uint32_t core);
 
 private:
     mutable ReadWriteLock               m_ObjectLock{};
@@ -79,6 +120,15 @@ private:
     std::priority_queue<PriorityTask, std::vector<PriorityTask>, TaskComparator> m_Tasks{};
 
     std::atomic<uint32_t> m_BusyWorkersCount{ 0u };
+    std::atomic<uint32_t> m_QueuedTasksCount{ 0u };
+
+    // The same count split by priority, so that the tasks of one priority can be admitted whatever the others queue
+    std::array<std::atomic<uint32_t>, std::numeric_limits<uint8_t>::max() + 1u> m_PriorityQueuedTasksCounts{};
+
+    // Created by the first AddTask() of every priority and kept for the lifetime of the pool
+    std::array<std::unique_ptr<TaskMetrics>, std::numeric_limits<uint8_t>::max() + 1u> m_TaskMetrics{};
+
+    static constexpr uint32_t s_AnyCore{ std::numeric_limits<uint32_t>::max() };
 
     bool m_IsInitialized{ false };
     bool m_IsPaused{ true };
@@ -99,15 +149,76 @@ inline auto ThreadPool::AddTask(uint8_t priority, F&& f, Args&&... args)
 
     std::future<returnType> result{ task->get_future() };
 
+    PushTask(priority, [task]() { (*task)(); });
+    return result;
+}
+
+template <typename F>
+inline void ThreadPool::AddDetachedTask(uint8_t priority, F&& f)
+{
+    PushTask(priority, std::function<void()>{ std::forward<F>(f) });
+}
+
+
+template <typename F>
+inline void ThreadPool::ParallelFor(uint8_t priority, size_t count, F&& f)
+{
+    if (count == 0u)
+        return;
+
+    struct ParallelForState
     {
-        WriteLock lock{ m_ObjectLock };
+        std::atomic<size_t>     NextIndex{ 0u };
+        std::atomic<size_t>     FinishedCount{ 0u };
+        std::mutex              FinishedLock{};
+        std::condition_variable FinishedWaiter{};
+        std::exception_ptr      Exception{ nullptr };
+    };
 
-        if (!IsWorkingUnsafe())
-            throw std::runtime_error("ThreadPool is not accepting tasks.");
+    // Helpers that start after all indices have been claimed return without touching f, so it may be captured by reference
+    const auto state{ std::make_shared<ParallelForState>() };
+    const auto work{ [state, count, &f]() {
+        for (size_t i{ state->NextIndex.fetch_add(1u) }; i < count; i = state->NextIndex.fetch_add(1u))
+        {
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                std::lock_guard _{ state->FinishedLock };
+                if (!state->Exception)
+                    state->Exception = std::current_exception();
+            }
+
+            if (state->FinishedCount.fetch_add(1u) + 1u == count)
+            {
+                std::lock_guard _{ state->FinishedLock };
+                state->FinishedWaiter.notify_all();
+            }
+        }
+    } };
 
-        m_Tasks.emplace(std::make_pair(priority, [task]() { (*task)(); }));
+    const size_t helpersCount{ std::min<size_t>(count - 1u, GetWorkersCount()) };
+    for (size_t i{ 0u }; i < helpersCount && IsWorking(); ++i)
+    {
+        try
+        {
+            AddDetachedTask(priority, work);
+        }
+        catch (const std::runtime_error&)
+        {
+            break;
+        }
     }
 
-    m_TaskWaiter.notify_one();
-    return result;
-}
+    work();
+
+    {
+        std::unique_lock lock{ state->FinishedLock };
+        state->FinishedWaiter.wait(lock, [&state, count]() { return state->FinishedCount.load() == count; });
+    }
+
+    if (state->Exception)
+        std::rethrow_exception(state->Exception);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "Topology.h"
+
+namespace Utils
+{
+    namespace
+    {
+        // Affinity masks cover a single processor group
+        constexpr uint32_t MAX_CORES_COUNT{ 64u };
+
+        uint32_t GetCoresCount() noexcept
+        {
+            return std::clamp(std::thread::hardware_concurrency(), 1u, MAX_CORES_COUNT);
+        }
+
+        // Blocks of 2^sizeClass bytes
+        uint32_t GetBlockSizeClass(size_t bytes, size_t alignment, uint32_t minSizeClass) noexcept
+        {
+            return std::max(static_cast<uint32_t>(std::bit_width(std::max({ bytes, alignment, size_t{ 1u } }) - 1u)), minSizeClass);
+        }
+    } // namespace
+} // namespace Utils
+
+Topology Topology::Detect()
+{
+    Topology topology{};
+
+    ULONG highestNode{ 0u };
+    if (GetNumaHighestNodeNumber(&highestNode))
+    {
+        for (ULONG node{ 0u }; node <= highestNode; ++node)
+        {
+            ULONGLONG processorMask{ 0u };
+            if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &processorMask) || processorMask == 0u)
+                continue;
+
+            std::vector<uint32_t>& nodeCores{ topology.m_NodeCores.emplace_back() };
+            for (uint32_t core{ 0u }; core < Utils::MAX_CORES_COUNT; ++core)
+            {
+                if ((processorMask >> core) & 1u)
+                    nodeCores.push_back(core);
+            }
+        }
+    }
+
+    // A single node holds all the cores if the OS does not report any
+    if (topology.m_NodeCores.empty())
+    {
+        topology = Simulate(1u);
+        topology.m_IsSimulated = false;
+    }
+
+    return topology;
+}
+
+Topology Topology::Simulate(uint32_t nodesCount)
+{
+    const uint32_t coresCount{ Utils::GetCoresCount() };
+    nodesCount = std::clamp(nodesCount, 1u, coresCount);
+
+    Topology topology{};
+    topology.m_IsSimulated = true;
+
+    for (uint32_t node{ 0u }; node < nodesCount; ++node)
+    {
+        std::vector<uint32_t>& nodeCores{ topology.m_NodeCores.emplace_back() };
+        for (uint32_t core{ node * coresCount / nodesCount }; core < (node + 1u) * coresCount / nodesCount; ++core)
+            nodeCores.push_back(core);
+    }
+
+    return topology;
+}
+
+std::vector<uint32_t> Topology::GetCoresByNode() const
+{
+    std::vector<uint32_t> cores{};
+    for (const std::vector<uint32_t>& nodeCores : m_NodeCores)
+        cores.insert(cores.end(), nodeCores.begin(), nodeCores.end());
+
+    return cores;
+}
+
+bool Topology::PinCurrentThread(uint32_t core)
+{
+    if (core >= Utils::MAX_CORES_COUNT)
+        return false;
+
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{ 1u } << core) != 0u;
+}
+
+NodeMemoryResource::~NodeMemoryResource()
+{
+    for (const auto& [region, regionSize] : m_Regions)
+    {
+        if (m_IsSimulated)
+            std::pmr::new_delete_resource()->deallocate(region, regionSize, s_MaxBlockAlignment);
+        else
+            VirtualFree(region, 0u, MEM_RELEASE);
+    }
+}
+
+void* NodeMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (alignment > s_MaxBlockAlignment)
+        throw std::bad_alloc{};
+
+    // Step 1
+    // Reuse a released block of the size class
+    const uint32_t sizeClass{ Utils::GetBlockSizeClass(bytes, alignment, s_MinBlockSizeClass) };
+    const size_t   blockSize{ size_t{ 1u } << sizeClass };
+
+    if (void* const block{ m_FreeBlocks[sizeClass] }; block != nullptr)
+    {
+        m_FreeBlocks[sizeClass] = *static_cast<void**>(block);
+        return block;
+    }
+
+    // Step 2
+    // Carve a new block out of the last region, the bytes skipped to align it are kept as smaller blocks
+    const size_t blockAlignment{ std::min(blockSize, s_MaxBlockAlignment) };
+    const size_t alignmentGap{ (blockAlignment - reinterpret_cast<uintptr_t>(m_RegionCursor) % blockAlignment) % blockAlignment };
+
+    if (static_cast<size_t>(m_RegionEnd - m_RegionCursor) < alignmentGap + blockSize)
+    {
+        // Step 3
+        // Start a new region, the rest of the last one is kept as smaller blocks
+        AddFreeBlocks(m_RegionCursor, m_RegionEnd);
+
+        const size_t regionSize{ std::max(m_NextRegionSize, blockSize) };
+        m_RegionCursor = AllocateRegion(regionSize);
+        m_RegionEnd = m_RegionCursor + regionSize;
+        m_NextRegionSize = std::min(m_NextRegionSize * 2u, s_MaxRegionSize);
+    }
+    else
+    {
+        AddFreeBlocks(m_RegionCursor, m_RegionCursor + alignmentGap);
+        m_RegionCursor += alignmentGap;
+    }
+
+    void* const block{ m_RegionCursor };
+    m_RegionCursor += blockSize;
+
+    return block;
+}
+
+void NodeMemoryResource::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+    const uint32_t sizeClass{ Utils::GetBlockSizeClass(bytes, alignment, s_MinBlockSizeClass) };
+
+    *static_cast<void**>(pointer) = m_FreeBlocks[sizeClass];
+    m_FreeBlocks[sizeClass] = pointer;
+}
+
+std::byte* NodeMemoryResource::AllocateRegion(size_t bytes)
+{
+    m_Regions.reserve(m_Regions.size() + 1u);
+
+    // The regions of a real node are aligned to the allocation granularity, far beyond s_MaxBlockAlignment
+    void* const region{ m_IsSimulated
+            ? std::pmr::new_delete_resource()->allocate(bytes, s_MaxBlockAlignment)
+            : VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, m_Node) };
+    if (region == nullptr)
+        throw std::bad_alloc{};
+
+    m_Regions.emplace_back(static_cast<std::byte*>(region), bytes);
+
+    return static_cast<std::byte*>(region);
+}
+
+void NodeMemoryResource::AddFreeBlocks(std::byte* begin, std::byte* end)
+{
+    // Every block handed out is a multiple of the smallest one, so the cursor is always aligned to it
+    constexpr size_t minBlockSize{ size_t{ 1u } << s_MinBlockSizeClass };
+
+    while (static_cast<size_t>(end - begin) >= minBlockSize)
+    {
+        // The largest block that fits and is aligned to its size
+        uint32_t sizeClass{ static_cast<uint32_t>(std::bit_width(static_cast<size_t>(end - begin))) - 1u };
+        while (reinterpret_cast<uintptr_t>(begin) % std::min(size_t{ 1u } << sizeClass, s_MaxBlockAlignment) != 0u)
+            --sizeClass;
+
+        *reinterpret_cast<void**>(begin) = m_FreeBlocks[sizeClass];
+        m_FreeBlocks[sizeClass] = begin;
+
+        begin += size_t{ 1u } << sizeClass;
+    }
+}
\ No newline at end of file
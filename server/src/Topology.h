@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// The cores of the machine grouped by NUMA node, either as reported by the OS or simulated by splitting the cores evenly
+// between a given number of nodes, so that the placement can be exercised on a single-node machine.
+// Only the first processor group is taken into account, i.e. at most 64 cores.
+class Topology
+{
+public:
+    static Topology Detect();
+    static Topology Simulate(uint32_t nodesCount);
+
+public:
+    uint32_t                  GetNodesCount() const noexcept { return static_cast<uint32_t>(m_NodeCores.size()); }
+    std::span<const uint32_t> GetNodeCores(uint32_t node) const { return m_NodeCores[node]; }
+    bool                      IsSimulated() const noexcept { return m_IsSimulated; }
+
+    // The cores node after node, threads placed on them in order fill one node before spilling over to the next
+    std::vector<uint32_t> GetCoresByNode() const;
+
+    // Restricts the calling thread to the core, returns false if the OS refuses it
+    static bool PinCurrentThread(uint32_t core);
+
+private:
+    std::vector<std::vector<uint32_t>> m_NodeCores{};
+    bool                               m_IsSimulated{ false };
+};
+
+// Hands out memory committed on a NUMA node, meant as the upstream of a pool resource so that a structure allocated from
+// the pool stays in the memory of the node whose threads work on it. The blocks are carved out of regions that are
+// committed once and grow up to s_MaxRegionSize, and a released block is kept for the next request of its power-of-two
+// size class, so the regrowth of a large posting list costs no system call. The regions go back to the OS only with the
+// resource. A simulated node has no memory of its own, its regions come from the global heap. Not thread-safe, like the
+// unsynchronized pool it is meant for
+class NodeMemoryResource : public std::pmr::memory_resource
+{
+public:
+    NodeMemoryResource() noexcept = default;
+    ~NodeMemoryResource() override;
+
+    NodeMemoryResource(const NodeMemoryResource&) noexcept = delete;
+    NodeMemoryResource(NodeMemoryResource&&) noexcept = delete;
+
+    NodeMemoryResource& operator=(const NodeMemoryResource&) noexcept = delete;
+    NodeMemoryResource& operator=(NodeMemoryResource&&) noexcept = delete;
+
+    // The node has to be set before the first allocation, blocks are returned to the node they came from
+    void SetNode(uint32_t node, bool isSimulated) noexcept
+    {
+        m_Node = node;
+        m_IsSimulated = isSimulated;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void  do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::byte* AllocateRegion(size_t bytes);
+    void       AddFreeBlocks(std::byte* begin, std::byte* end);
+
+private:
+    static constexpr uint32_t s_MinBlockSizeClass{ 6u };            // 64 bytes, the block sizes are powers of two
+    static constexpr size_t   s_MaxBlockAlignment{ 4096u };          // A block is aligned to its size, up to a page
+    static constexpr size_t   s_MinRegionSize{ 1024u * 1024u };      // Of the first region, the next ones double
+    static constexpr size_t   s_MaxRegionSize{ 64u * 1024u * 1024u }; // Except for the blocks larger than that
+
+    uint32_t m_Node{ 0u };
+    bool     m_IsSimulated{ true };
+
+    std::vector<std::pair<std::byte*, size_t>> m_Regions{};
+    std::byte*                                 m_RegionCursor{ nullptr }; // The rest of the last region has not been handed out yet
+    std::byte*                                 m_RegionEnd{ nullptr };
+    size_t                                     m_NextRegionSize{ s_MinRegionSize };
+
+    // The released blocks of every size class, linked through their first bytes
+    std::array<void*, 64u> m_FreeBlocks{};
+};
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "Tracer.h"
+
+#include "HTTP.h"
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char*               Name{ nullptr };
+        Tracer::Clock::time_point StartTimePoint{};
+        Tracer::Clock::time_point EndTimePoint{};
+        bool                      IsInterval{ false };
+    };
+
+    // Written by its thread only, the lock is contended only while the events are being exported
+    struct ThreadBuffer
+    {
+        std::mutex              Lock{};
+        std::vector<TraceEvent> Events{}; // A ring once full
+        size_t                  NextEventIndex{ 0u };
+        uint32_t                ThreadID{ 0u };
+        std::string             ThreadName{};
+    };
+
+    // The buffers of the threads that have exited are kept, their events are still exported
+    std::mutex                                 s_ThreadBuffersLock{};
+    std::vector<std::shared_ptr<ThreadBuffer>> s_ThreadBuffers{};
+
+    const Tracer::Clock::time_point s_EpochTimePoint{ Tracer::Clock::now() };
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local const std::shared_ptr<ThreadBuffer> t_ThreadBuffer{ [] {
+            std::lock_guard _{ s_ThreadBuffersLock };
+
+            auto threadBuffer{ std::make_shared<ThreadBuffer>() };
+            threadBuffer->ThreadID = static_cast<uint32_t>(s_ThreadBuffers.size()) + 1u;
+
+            s_ThreadBuffers.push_back(threadBuffer);
+            return threadBuffer;
+        }() };
+
+        return *t_ThreadBuffer;
+    }
+
+    void Record(const TraceEvent& event, size_t capacity)
+    {
+        ThreadBuffer&   threadBuffer{ GetThreadBuffer() };
+        std::lock_guard _{ threadBuffer.Lock };
+
+        if (threadBuffer.Events.size() < capacity)
+            threadBuffer.Events.push_back(event);
+        else
+            threadBuffer.Events[threadBuffer.NextEventIndex % capacity] = event;
+
+        ++threadBuffer.NextEventIndex;
+    }
+
+    double ToTraceTimestamp(Tracer::Clock::time_point timePoint)
+    {
+        return std::chrono::duration<double, std::micro>(timePoint - s_EpochTimePoint).count();
+    }
+} // namespace
+
+void Tracer::Enable(bool isEnabled)
+{
+    if (isEnabled)
+    {
+        std::lock_guard _{ s_ThreadBuffersLock };
+        for (const auto& threadBuffer : s_ThreadBuffers)
+        {
+            std::lock_guard __{ threadBuffer->Lock };
+            threadBuffer->Events.clear();
+            threadBuffer->NextEventIndex = 0u;
+        }
+    }
+
+    s_IsEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+void Tracer::SetThreadName(const std::string& name)
+{
+    ThreadBuffer&   threadBuffer{ GetThreadBuffer() };
+    std::lock_guard _{ threadBuffer.Lock };
+
+    if (threadBuffer.ThreadName.empty())
+        threadBuffer.ThreadName = name;
+}
+
+void Tracer::RecordSpan(const char* name, Clock::time_point startTimePoint, Clock::time_point endTimePoint)
+{
+    if (IsEnabled())
+        Record({ .Name = name, .StartTimePoint = startTimePoint, .EndTimePoint = endTimePoint, .IsInterval = false }, s_ThreadBufferCapacity);
+}
+
+void Tracer::RecordInterval(const char* name, Clock::time_point startTimePoint, Clock::time_point endTimePoint)
+{
+    if (IsEnabled())
+        Record({ .Name = name, .StartTimePoint = startTimePoint, .EndTimePoint = endTimePoint, .IsInterval = true }, s_ThreadBufferCapacity);
+}
+
+std::string Tracer::ExportChromeTrace()
+{
+    std::string json{ "{ \"displayTimeUnit\": \"ns\", \"traceEvents\": [" };
+    size_t      eventsCount{ 0u };
+    uint64_t    intervalID{ 0u };
+
+    const auto appendSeparator{ [&json, &eventsCount]() { json.append(eventsCount++ > 0u ? ",\n" : "\n"); } };
+
+    std::lock_guard _{ s_ThreadBuffersLock };
+
+    for (const auto& threadBuffer : s_ThreadBuffers)
+    {
+        std::lock_guard __{ threadBuffer->Lock };
+
+        appendSeparator();
+        json.append(std::format("{{ \"ph\": \"M\", \"pid\": 1, \"tid\": {0}, \"name\": \"thread_name\", \"args\": {{ \"name\": \"", threadBuffer->ThreadID));
+        HTTP::AppendJSONEscaped(json, threadBuffer->ThreadName.empty() ? std::format("Thread {0}", threadBuffer->ThreadID) : threadBuffer->ThreadName);
+        json.append("\" } }");
+
+        // Oldest first, so that the viewer does not have to sort
+        const size_t eventsCountInBuffer{ threadBuffer->Events.size() };
+        for (size_t i{ 0u }; i < eventsCountInBuffer; ++i)
+        {
+            const TraceEvent& event{ threadBuffer->Events[(threadBuffer->NextEventIndex + i) % eventsCountInBuffer] };
+
+            const double startTimestamp{ ToTraceTimestamp(event.StartTimePoint) };
+            const double endTimestamp{ ToTraceTimestamp(event.EndTimePoint) };
+
+            appendSeparator();
+            if (!event.IsInterval)
+            {
+                std::format_to(std::back_inserter(json), "{{ \"ph\": \"X\", \"pid\": 1, \"tid\": {0}, \"name\": \"{1}\", \"ts\": {2:.3f}, \"dur\": {3:.3f} }}", threadBuffer->ThreadID, event.Name, startTimestamp, endTimestamp - startTimestamp);
+                continue;
+            }
+
+            // An async begin and end pair, which the viewers lay out on a track of its own
+            ++intervalID;
+            std::format_to(std::back_inserter(json), "{{ \"ph\": \"b\", \"pid\": 1, \"tid\": {0}, \"cat\": \"{1}\", \"name\": \"{1}\", \"id\": {2}, \"ts\": {3:.3f} }},\n", threadBuffer->ThreadID, event.Name, intervalID, startTimestamp);
+            std::format_to(std::back_inserter(json), "{{ \"ph\": \"e\", \"pid\": 1, \"tid\": {0}, \"cat\": \"{1}\", \"name\": \"{1}\", \"id\": {2}, \"ts\": {3:.3f} }}", threadBuffer->ThreadID, event.Name, intervalID, endTimestamp);
+        }
+    }
+
+    json.append("\n] }\n");
+    return json;
+}
\ No newline at end of file
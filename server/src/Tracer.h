@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped spans recorded into buffers of the threads and exported in the Chrome trace event format, which both
+// chrome://tracing and Perfetto open. While tracing is disabled, a span costs a relaxed atomic load.
+// Every thread keeps its last s_ThreadBufferCapacity events, the older ones are overwritten.
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) noexcept
+            : m_Name{ name }
+            , m_StartTimePoint{ IsEnabled() ? Clock::now() : Clock::time_point{} }
+        {
+        }
+
+        ~Scope()
+        {
+            if (m_StartTimePoint != Clock::time_point{})
+                RecordSpan(m_Name, m_StartTimePoint, Clock::now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope(Scope&&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+    private:
+        const char*       m_Name;
+        Clock::time_point m_StartTimePoint;
+    };
+
+public:
+    // Enabling discards the events recorded before
+    static void Enable(bool isEnabled);
+    static bool IsEnabled() noexcept { return s_IsEnabled.load(std::memory_order_relaxed); }
+
+    // Shown instead of the thread number, only the first name given to a thread is kept
+    static void SetThreadName(const std::string& name);
+
+    // The names must be string literals. A span goes on the track of the calling thread, so the spans of a thread must
+    // nest, an interval gets a track of its own: it may overlap whatever the thread did meanwhile (e.g. a queue wait)
+    static void RecordSpan(const char* name, Clock::time_point startTimePoint, Clock::time_point endTimePoint);
+    static void RecordInterval(const char* name, Clock::time_point startTimePoint, Clock::time_point endTimePoint);
+
+    // The events currently held by all the threads
+    static std::string ExportChromeTrace();
+
+private:
+    static constexpr size_t s_ThreadBufferCapacity{ 64u * 1024u };
+
+    inline static std::atomic<bool> s_IsEnabled{ false };
+};
+
+#define TRACE_CONCATENATE_IMPL(lhs, rhs) lhs##rhs
+#define TRACE_CONCATENATE(lhs, rhs)      TRACE_CONCATENATE_IMPL(lhs, rhs)
+
+// Records the rest of the enclosing block as a span
+#define TRACE_SCOPE(name) const ::Tracer::Scope TRACE_CONCATENATE(traceScope, __LINE__){ name }
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "Unicode.h"
+
+namespace Utils
+{
+    namespace
+    {
+        // The base letter of every code point of a Latin block, ' ' for the symbols and '*' for the letters without an ASCII
+        // base, which are kept as they are. The uppercase letters stand for the ligatures and the letters folded to two:
+        // A "ae", I "ij", O "oe", S "ss", T "th"
+        constexpr std::string_view LATIN_LETTERS{
+            "aaaaaaAceeeeiiiidnooooo ouuuuyTS" // U+00C0
+            "aaaaaaAceeeeiiiidnooooo ouuuuyTy" // U+00E0
+            "aaaaaaccccccccddddeeeeeeeeeegggg" // U+0100
+            "gggghhhhiiiiiiiiiiIIjjkkklllllll" // U+0120
+            "lllnnnnnnnnnooooooOOrrrrrrssssss" // U+0140
+            "ssttttttuuuuuuuuuuuuwwyyyzzzzzzs" // U+0160
+            "********************************" // U+0180
+            "oo*************uu***************" // U+01A0
+            "*************aaiioouuuuuuuuuu*aa" // U+01C0
+            "aa****ggkkoooo**j***gg**nnaa****" // U+01E0
+            "aaaaeeeeiiiioooorrrruuuusstt**hh" // U+0200
+            "******aaeeooooooooyy************" // U+0220
+            "****************"                 // U+0240
+        };
+        constexpr char32_t LATIN_LETTERS_BEGIN{ 0x00C0u };
+
+        constexpr std::string_view LATIN_ADDITIONAL_LETTERS{
+            "aabbbbbbccddddddddddeeeeeeeeeeff" // U+1E00
+            "gghhhhhhhhhhiiiikkkkkkllllllllmm" // U+1E20
+            "mmmmnnnnnnnnoooooooopppprrrrrrrr" // U+1E40
+            "ssssssssssttttttttuuuuuuuuuuvvvv" // U+1E60
+            "wwwwwwwwwwxxxxyyzzzzzzhtwyasssSd" // U+1E80
+            "aaaaaaaaaaaaaaaaaaaaaaaaeeeeeeee" // U+1EA0
+            "eeeeeeeeiiiioooooooooooooooooooo" // U+1EC0
+            "oooouuuuuuuuuuuuuuyyyyyyyyllvvyy" // U+1EE0
+        };
+        constexpr char32_t LATIN_ADDITIONAL_LETTERS_BEGIN{ 0x1E00u };
+
+        // Lowercase Greek and Cyrillic letters with a diacritic -> the base letter, sorted. The Cyrillic short i keeps its
+        // breve, it is a letter of its own rather than an accented one
+        constexpr std::pair<char32_t, char32_t> ACCENTED_LETTERS[]{
+            { 0x0386u, 0x03B1u }, { 0x0388u, 0x03B5u }, { 0x0389u, 0x03B7u }, { 0x038Au, 0x03B9u }, { 0x038Cu, 0x03BFu },
+            { 0x038Eu, 0x03C5u }, { 0x038Fu, 0x03C9u }, { 0x0390u, 0x03B9u }, { 0x03AAu, 0x03B9u }, { 0x03ABu, 0x03C5u },
+            { 0x03ACu, 0x03B1u }, { 0x03ADu, 0x03B5u }, { 0x03AEu, 0x03B7u }, { 0x03AFu, 0x03B9u }, { 0x03B0u, 0x03C5u },
+            { 0x03C2u, 0x03C3u }, { 0x03CAu, 0x03B9u }, { 0x03CBu, 0x03C5u }, { 0x03CCu, 0x03BFu }, { 0x03CDu, 0x03C5u },
+            { 0x03CEu, 0x03C9u }, { 0x0450u, 0x0435u }, { 0x0451u, 0x0435u }, { 0x0453u, 0x0433u }, { 0x0457u, 0x0456u },
+            { 0x045Cu, 0x043Au }, { 0x045Du, 0x0438u }, { 0x045Eu, 0x0443u }, { 0x0477u, 0x0475u }, { 0x04C2u, 0x0436u },
+            { 0x04D1u, 0x0430u }, { 0x04D3u, 0x0430u }, { 0x04D7u, 0x0435u }, { 0x04DBu, 0x04D9u }, { 0x04DDu, 0x0436u },
+            { 0x04DFu, 0x0437u }, { 0x04E3u, 0x0438u }, { 0x04E5u, 0x0438u }, { 0x04E7u, 0x043Eu }, { 0x04EBu, 0x04E9u },
+            { 0x04EDu, 0x044Du }, { 0x04EFu, 0x0443u }, { 0x04F1u, 0x0443u }, { 0x04F3u, 0x0443u }, { 0x04F5u, 0x0447u },
+            { 0x04F9u, 0x044Bu },
+        };
+
+        // Marks, punctuation, symbols and the other code points that are not part of a word, sorted
+        constexpr std::pair<char32_t, char32_t> DROPPED_RANGES[]{
+            { 0x0080u, 0x00A9u },   // Latin-1 controls, punctuation and symbols, the ordinal indicators aside
+            { 0x00ABu, 0x00B9u },
+            { 0x00BBu, 0x00BFu },
+            { 0x00D7u, 0x00D7u },   // Multiplication sign
+            { 0x00F7u, 0x00F7u },   // Division sign
+            { 0x02B0u, 0x036Fu },   // Modifier letters and combining diacritical marks
+            { 0x0374u, 0x0375u },   // Greek numeral signs
+            { 0x037Eu, 0x037Eu },   // Greek question mark
+            { 0x0384u, 0x0385u },   // Greek tonos
+            { 0x0387u, 0x0387u },   // Greek ano teleia
+            { 0x03F6u, 0x03F6u },   // Greek reversed lunate epsilon symbol
+            { 0x0482u, 0x0489u },   // Cyrillic signs and combining marks
+            { 0x1AB0u, 0x1AFFu },   // Combining diacritical marks extended
+            { 0x1DC0u, 0x1DFFu },   // Combining diacritical marks supplement
+            { 0x2000u, 0x2BFFu },   // General punctuation up to the miscellaneous symbols and arrows
+            { 0x2E00u, 0x2E7Fu },   // Supplemental punctuation
+            { 0x3000u, 0x303Fu },   // CJK symbols and punctuation
+            { 0xFE00u, 0xFE0Fu },   // Variation selectors
+            { 0xFE20u, 0xFE6Fu },   // Combining half marks, CJK compatibility and small forms
+            { 0xFEFFu, 0xFEFFu },   // Byte order mark
+            { 0xFF01u, 0xFF20u },   // Fullwidth punctuation and digits
+            { 0xFF3Bu, 0xFF40u },   // Fullwidth punctuation
+            { 0xFF5Bu, 0xFF65u },   // Fullwidth and halfwidth punctuation
+            { 0xFFF0u, 0xFFFFu },   // Specials, the replacement character included
+            { 0x1F000u, 0x1FAFFu }, // Game symbols, emoji and pictographs
+            { 0xE0000u, 0xE01EFu }, // Tags and variation selectors supplement
+        };
+
+        bool IsDropped(char32_t codePoint) noexcept
+        {
+            const auto it{ std::upper_bound(std::begin(DROPPED_RANGES), std::end(DROPPED_RANGES), codePoint, [](char32_t value, const auto& range) { return value < range.first; }) };
+            return it != std::begin(DROPPED_RANGES) && codePoint <= std::prev(it)->second;
+        }
+
+        void AppendLatinLetter(std::pmr::string& destination, char letter, char32_t codePoint)
+        {
+            switch (letter)
+            {
+                case ' ':
+                    break;
+                case '*':
+                    Unicode::AppendUTF8(destination, codePoint);
+                    break;
+                case 'A':
+                    destination.append("ae");
+                    break;
+                case 'I':
+                    destination.append("ij");
+                    break;
+                case 'O':
+                    destination.append("oe");
+                    break;
+                case 'S':
+                    destination.append("ss");
+                    break;
+                case 'T':
+                    destination.append("th");
+                    break;
+                default:
+                    destination.push_back(letter);
+                    break;
+            }
+        }
+
+        // The case pairs of the Greek and Cyrillic alphabets, the rest of the blocks is already lowercase or has no case
+        char32_t ToLowerGreekOrCyrillic(char32_t codePoint) noexcept
+        {
+            if (codePoint >= 0x0391u && codePoint <= 0x03A9u)
+                return codePoint + 0x20u;
+            if (codePoint >= 0x0400u && codePoint <= 0x040Fu)
+                return codePoint + 0x50u;
+            if (codePoint >= 0x0410u && codePoint <= 0x042Fu)
+                return codePoint + 0x20u;
+            if ((codePoint >= 0x0460u && codePoint <= 0x0481u) || (codePoint >= 0x048Au && codePoint <= 0x04BFu) || (codePoint >= 0x04D0u && codePoint <= 0x04FFu))
+                return codePoint | 1u;
+            if (codePoint >= 0x04C1u && codePoint <= 0x04CEu)
+                return codePoint + (codePoint & 1u);
+            if (codePoint == 0x04C0u)
+                return 0x04CFu;
+
+            return codePoint;
+        }
+    } // namespace
+} // namespace Utils
+
+size_t Unicode::Decode(std::string_view text, char32_t& codePoint) noexcept
+{
+    const auto byte{ [&text](size_t index) { return static_cast<unsigned char>(text[index]); } };
+    const auto isContinuation{ [&](size_t index) { return index < text.size() && (byte(index) & 0xC0u) == 0x80u; } };
+
+    codePoint = REPLACEMENT_CHARACTER;
+    if (text.empty())
+        return 0u;
+
+    const unsigned char leadByte{ byte(0u) };
+    if (leadByte < 0x80u)
+    {
+        codePoint = leadByte;
+        return 1u;
+    }
+
+    // The length of the sequence and the smallest code point it may encode, so that overlong forms are rejected
+    size_t   length{ 0u };
+    char32_t minCodePoint{ 0u };
+
+    if ((leadByte & 0xE0u) == 0xC0u)
+    {
+        length = 2u;
+        minCodePoint = 0x80u;
+    }
+    else if ((leadByte & 0xF0u) == 0xE0u)
+    {
+        length = 3u;
+        minCodePoint = 0x800u;
+    }
+    else if ((leadByte & 0xF8u) == 0xF0u)
+    {
+        length = 4u;
+        minCodePoint = 0x10000u;
+    }
+    else
+    {
+        return 1u;
+    }
+
+    char32_t value{ leadByte & (0x7Fu >> length) };
+    for (size_t i{ 1u }; i < length; ++i)
+    {
+        if (!isContinuation(i))
+            return 1u;
+
+        value = (value << 6u) | (byte(i) & 0x3Fu);
+    }
+
+    if (value < minCodePoint || value > 0x10FFFFu || (value >= 0xD800u && value <= 0xDFFFu))
+        return 1u;
+
+    codePoint = value;
+    return length;
+}
+
+void Unicode::AppendUTF8(std::pmr::string& destination, char32_t codePoint)
+{
+    if (codePoint < 0x80u)
+    {
+        destination.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800u)
+    {
+        destination.push_back(static_cast<char>(0xC0u | (codePoint >> 6u)));
+        destination.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+    }
+    else if (codePoint < 0x10000u)
+    {
+        destination.push_back(static_cast<char>(0xE0u | (codePoint >> 12u)));
+        destination.push_back(static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu)));
+        destination.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+    }
+    else
+    {
+        destination.push_back(static_cast<char>(0xF0u | (codePoint >> 18u)));
+        destination.push_back(static_cast<char>(0x80u | ((codePoint >> 12u) & 0x3Fu)));
+        destination.push_back(static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu)));
+        destination.push_back(static_cast<char>(0x80u | (codePoint & 0x3Fu)));
+    }
+}
+
+bool Unicode::IsWhitespace(char32_t codePoint) noexcept
+{
+    switch (codePoint)
+    {
+        case 0x0085u: // Next line
+        case 0x00A0u: // No-break space
+        case 0x1680u: // Ogham space mark
+        case 0x2028u: // Line separator
+        case 0x2029u: // Paragraph separator
+        case 0x202Fu: // Narrow no-break space
+        case 0x205Fu: // Medium mathematical space
+        case 0x3000u: // Ideographic space
+            return true;
+        default:
+            return codePoint >= 0x2000u && codePoint <= 0x200Au;
+    }
+}
+
+void Unicode::AppendFolded(std::pmr::string& destination, char32_t codePoint)
+{
+    if (Utils::IsDropped(codePoint))
+        return;
+
+    // Step 1: The Latin letters are folded to their ASCII base letters
+    if (codePoint >= Utils::LATIN_LETTERS_BEGIN && codePoint - Utils::LATIN_LETTERS_BEGIN < Utils::LATIN_LETTERS.size())
+    {
+        Utils::AppendLatinLetter(destination, Utils::LATIN_LETTERS[codePoint - Utils::LATIN_LETTERS_BEGIN], codePoint);
+        return;
+    }
+
+    if (codePoint >= Utils::LATIN_ADDITIONAL_LETTERS_BEGIN && codePoint - Utils::LATIN_ADDITIONAL_LETTERS_BEGIN < Utils::LATIN_ADDITIONAL_LETTERS.size())
+    {
+        Utils::AppendLatinLetter(destination, Utils::LATIN_ADDITIONAL_LETTERS[codePoint - Utils::LATIN_ADDITIONAL_LETTERS_BEGIN], codePoint);
+        return;
+    }
+
+    if (codePoint == 0x00AAu || codePoint == 0x00BAu) // Feminine and masculine ordinal indicators
+    {
+        destination.push_back(codePoint == 0x00AAu ? 'a' : 'o');
+        return;
+    }
+
+    // The fullwidth forms of the ASCII letters, which the CJK texts use
+    if ((codePoint >= 0xFF21u && codePoint <= 0xFF3Au) || (codePoint >= 0xFF41u && codePoint <= 0xFF5Au))
+    {
+        destination.push_back(static_cast<char>((codePoint - 0xFF21u) % 0x20u + 'a'));
+        return;
+    }
+
+    // Step 2: The Greek and the Cyrillic letters are lowercased, then lose their diacritics
+    if (codePoint >= 0x0370u && codePoint < 0x0500u)
+    {
+        codePoint = Utils::ToLowerGreekOrCyrillic(codePoint);
+
+        const auto it{ std::lower_bound(std::begin(Utils::ACCENTED_LETTERS), std::end(Utils::ACCENTED_LETTERS), codePoint, [](const auto& pair, char32_t value) { return pair.first < value; }) };
+        if (it != std::end(Utils::ACCENTED_LETTERS) && it->first == codePoint)
+            codePoint = it->second;
+    }
+
+    // Step 3: The letters of the other scripts are kept as they are
+    AppendUTF8(destination, codePoint);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// The UTF-8 handling of the tokenizer, for the bytes outside of ASCII. The folding is a simple one without any locale:
+// the Latin, Greek and Cyrillic letters are lowercased and lose their diacritics, the letters of the other scripts are
+// kept as they are, and the marks, punctuation and symbols are dropped like the ASCII ones
+namespace Unicode
+{
+    inline constexpr char32_t REPLACEMENT_CHARACTER{ 0xFFFDu };
+
+    // Decodes the code point text starts with and returns the length of its sequence. An invalid or truncated sequence
+    // decodes as REPLACEMENT_CHARACTER one byte long, so that the next byte starts a sequence of its own
+    size_t Decode(std::string_view text, char32_t& codePoint) noexcept;
+
+    void AppendUTF8(std::pmr::string& destination, char32_t codePoint);
+
+    // The separators beyond ASCII, e.g. the no-break and the ideographic spaces
+    bool IsWhitespace(char32_t codePoint) noexcept;
+
+    // Appends the folded form of a code point beyond ASCII, nothing if it is not part of a word
+    void AppendFolded(std::pmr::string& destination, char32_t codePoint);
+} // namespace Unicode
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Samples ranks in [0, count) with probability proportional to 1 / (rank + 1)^exponent. Shared by the benchmark corpora
+// and the queries of the load generator
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(size_t count, double exponent)
+    {
+        m_CumulativeProbabilities.reserve(count);
+
+        double sum{ 0.0 };
+        for (size_t rank{ 0u }; rank < count; ++rank)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(rank + 1u), exponent);
+            m_CumulativeProbabilities.push_back(sum);
+        }
+
+        for (double& probability : m_CumulativeProbabilities)
+            probability /= sum;
+    }
+
+public:
+    size_t operator()(std::mt19937_64& generator) const
+    {
+        const double value{ std::uniform_real_distribution<double>{ 0.0, 1.0 }(generator) };
+        const auto   it{ std::lower_bound(m_CumulativeProbabilities.begin(), m_CumulativeProbabilities.end(), value) };
+
+        return std::min(static_cast<size_t>(it - m_CumulativeProbabilities.begin()), m_CumulativeProbabilities.size() - 1u);
+    }
+
+private:
+    std::vector<double> m_CumulativeProbabilities{};
+};
\ No newline at end of file
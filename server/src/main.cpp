@@ -4,25 +4,136 @@
 #include <exception>
 #include <iostream>
 
+namespace
+{
+    // Parses the optional "--option value" pairs that follow the positional arguments
+    ServerConfig ParseServerConfig(int argc, const char* argv[], int firstOptionIndex)
+    {
+        ServerConfig config{};
+
+        const std::unordered_map<std::string_view, uint32_t*> uint32Options{
+            { "--workers", &config.WorkersCount },
+            { "--max-queued-requests", &config.MaxQueuedRequests },
+            { "--max-in-flight-requests", &config.MaxInFlightRequests },
+            { "--read-timeout-ms", &config.ReadTimeoutMS },
+            { "--write-timeout-ms", &config.WriteTimeoutMS },
+            { "--idle-timeout-ms", &config.IdleTimeoutMS },
+            { "--query-budget-ms", &config.QueryTimeBudgetMS },
+            { "--event-loops", &config.EventLoopsCount },
+            { "--numa-nodes", &config.SimulatedNUMANodesCount },
+            { "--partition", &config.Partition.Index },
+            { "--partitions", &config.Partition.Count },
+            { "--shard-timeout-ms", &config.ShardTimeoutMS },
+        };
+
+        std::string shardAddresses{};
+        std::string analyzerName{};
+
+        const std::unordered_map<std::string_view, std::string*> stringOptions{
+            { "--index", &config.IndexPath },
+            { "--shards", &shardAddresses },
+            { "--replication-dir", &config.ReplicationDirectory },
+            { "--replica-of", &config.PrimaryAddress },
+            { "--analyzer", &analyzerName },
+        };
+
+        const std::unordered_map<std::string_view, bool*> switchOptions{
+            { "--trace", &config.IsTracingEnabled },
+            { "--numa", &config.IsNUMAPlacementEnabled },
+        };
+
+        for (int i{ firstOptionIndex }; i < argc; i += 2)
+        {
+            const std::string_view option{ argv[i] };
+
+            if (i + 1 >= argc)
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+
+            if (const auto it{ uint32Options.find(option) }; it != uint32Options.end())
+                *it->second = static_cast<uint32_t>(std::stoul(argv[i + 1]));
+            else if (const auto it{ stringOptions.find(option) }; it != stringOptions.end())
+                *it->second = argv[i + 1];
+            else if (const auto it{ switchOptions.find(option) }; it != switchOptions.end() && (argv[i + 1] == std::string_view{ "on" } || argv[i + 1] == std::string_view{ "off" }))
+                *it->second = argv[i + 1] == std::string_view{ "on" };
+            else
+                throw std::invalid_argument(std::format("Invalid option: {0}", option));
+        }
+
+        if (!analyzerName.empty() && !ParseAnalyzerType(analyzerName, config.Analyzer))
+            throw std::invalid_argument(std::format("Invalid analyzer: {0}", analyzerName));
+
+        if (config.WorkersCount == 0u)
+            throw std::invalid_argument("At least one worker is required");
+
+        if (config.Partition.Count == 0u || config.Partition.Index >= config.Partition.Count)
+            throw std::invalid_argument(std::format("Invalid partition {0} of {1}", config.Partition.Index, config.Partition.Count));
+
+        // A comma-separated list of "IPv4:port"
+        for (const auto shardAddress : shardAddresses | std::views::split(','))
+        {
+            if (!shardAddress.empty())
+                config.ShardAddresses.emplace_back(shardAddress.begin(), shardAddress.end());
+        }
+
+        if (!config.ShardAddresses.empty() && (config.Partition.Count > 1u || !config.IndexPath.empty()))
+            throw std::invalid_argument("A coordinator indexes nothing itself, --partition and --index do not apply to it");
+
+        if (!config.PrimaryAddress.empty() && (!config.ShardAddresses.empty() || !config.ReplicationDirectory.empty() || config.Partition.Count > 1u))
+            throw std::invalid_argument("A replica only loads the index of its primary, --shards, --replication-dir and --partition do not apply to it");
+
+        if (!config.ReplicationDirectory.empty() && !config.ShardAddresses.empty())
+            throw std::invalid_argument("A coordinator has no index to replicate, --replication-dir does not apply to it");
+
+        return config;
+    }
+} // namespace
+
 int main(int argc, const char* argv[])
 {
-    if (argc != 3)
+    constexpr std::string_view usage{ "Usage: [server] <files_directory> <port> [--workers N] [--max-queued-requests N] [--max-in-flight-requests N]\n"
+                                      "                [--read-timeout-ms N] [--write-timeout-ms N] [--idle-timeout-ms N] [--query-budget-ms N]\n"
+                                      "                [--index FILE] [--analyzer standard|english] [--trace on|off] [--event-loops N]\n"
+                                      "                [--numa on|off] [--numa-nodes N] [--partition I --partitions N]\n"
+                                      "                [--shards IP:PORT,... [--shard-timeout-ms N]]\n"
+                                      "                [--replication-dir DIR | --replica-of IP:PORT]" };
+
+    if (argc < 3)
     {
-        std::cerr << "Usage: [server] <files_directory> <port>" << std::endl;
+        std::cerr << usage << std::endl;
         return EXIT_FAILURE;
     }
 
+    std::string  filesDirectory{ argv[1] };
+    uint16_t     port{ 0u };
+    ServerConfig config{};
+
+    // The logger is only initialized by the server, so argument errors go straight to stderr
     try
     {
-        std::string filesDirectory{ argv[1] };
-        uint16_t    port{ static_cast<uint16_t>(std::stoi(argv[2])) };
+        port = static_cast<uint16_t>(std::stoi(argv[2]));
+        config = ParseServerConfig(argc, argv, 3);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n"
+                  << usage << std::endl;
+        return EXIT_FAILURE;
+    }
 
-        Server server{};
+    int exitCode{ EXIT_SUCCESS };
+
+    try
+    {
+        Server server{ config };
         server.Start(filesDirectory, port);
     }
     catch (const std::exception& e)
     {
         LOG_CRITICAL_TAG("SERVER", "Exception: {0}", e.what());
-        return EXIT_FAILURE;
+        exitCode = EXIT_FAILURE;
     }
+
+    // The server and its workers are gone, the messages still queued can be written
+    Log::Shutdown();
+    return exitCode;
 }
\ No newline at end of file